@@ -9,6 +9,8 @@
 #include <PLCore/System/System.h>
 #include <PLCore/System/Console.h>
 #include <PLCore/Core/MemoryManager.h>
+#include <PLCore/Tools/Timing.h>
+#include <PLCore/Container/Array.h>
 #include <PLCore/Application/CoreApplication.h>
 #include <PLCore/Frontend/FrontendApplication.h>
 #include <PLCore/Base/Func/FuncGenMemPtr.h>
@@ -61,6 +63,9 @@ namespace PLAwesomium {
 #define DRAGWINDOW "DragWindow"
 #define HIDEWINDOW "HideWindow"
 #define CLOSEWINDOW "CloseWindow"
+#define TEXTUREGROWTHDIVISOR 4
+#define TEXTURESHRINKDIVISOR 2
+#define TEXTUREALIGNMENT 16
 
 
 //[-------------------------------------------------------]
@@ -139,9 +144,14 @@ class SRPWindows : public PLScene::SceneRendererPass,
 		PLAWESOMIUM_API void ResizeWindow(const int &nWidth, const int &nHeight); /*unused*/
 		PLAWESOMIUM_API bool AddCallBackFunction(const PLCore::DynFuncPtr pDynFunc, PLCore::String sJSFunctionName = "",  bool bHasReturn = false); /*unused*/
 		PLAWESOMIUM_API void ExecuteJavascript(const PLCore::String &sJavascript) const;
+		PLAWESOMIUM_API void EnqueueJavascript(const PLCore::String &sJavascript, const PLCore::String &sKey = ""); /*executed at once on UpdateCall(), a key replaces the javascript queued with that key*/
+		PLAWESOMIUM_API void FlushJavascript();
 		PLAWESOMIUM_API void UpdateCall();
 		PLAWESOMIUM_API void SetAwesomiumWebCore(Awesomium::WebCore *pAwesomiumWebCore);
 		PLAWESOMIUM_API bool IsLoaded() const;
+		PLAWESOMIUM_API bool IsUnresponsive() const;
+		PLAWESOMIUM_API PLCore::uint64 GetUnresponsiveTime() const;
+		PLAWESOMIUM_API void SetUnresponsiveReloadTime(const PLCore::uint32 &nSeconds); /*0 disables the reload*/
 
 	protected:
 
@@ -175,6 +185,7 @@ class SRPWindows : public PLScene::SceneRendererPass,
 		bool UpdateVertexBuffer(PLRenderer::VertexBuffer *pVertexBuffer, const PLMath::Vector2 &vPosition, const PLMath::Vector2 &vImageSize);
 		void DrawWindow();
 		void BufferUploadToGPU();
+		static int GetTextureCapacity(const int &nSize, const int &nCapacity); /*the current capacity while the size fits it*/
 		void RecreateWindow();
 		void SetWindowSettings();
 		void SetDefaultCallBackFunctions();
@@ -190,6 +201,8 @@ class SRPWindows : public PLScene::SceneRendererPass,
 		PLRenderer::ProgramWrapper *m_pProgramWrapper;
 		PLRenderer::TextureBuffer *m_pTextureBuffer;
 		PLGraphics::Image m_cImage;
+		int m_nTextureWidth; /*capacity of the image and texture, the frame uses the upper left part*/
+		int m_nTextureHeight;
 		sWindowsData *m_psWindowsData;
 		bool m_bInitialized;
 		bool m_bReadyToDraw;
@@ -197,6 +210,12 @@ class SRPWindows : public PLScene::SceneRendererPass,
 		PLCore::HashMap<PLCore::String, sCallBack*> *m_pDefaultCallBacks;
 		PLCore::HashMap<PLCore::String, PLCore::DynFuncPtr> *m_pCallBackFunctions;
 		bool m_bIgnoreBufferUpdate;
+		bool m_bUnresponsive;
+		bool m_bUnresponsiveReloaded;
+		PLCore::uint64 m_nUnresponsiveStartTime;
+		PLCore::uint64 m_nUnresponsiveReloadTime;
+		PLCore::Array<PLCore::String> m_lstQueuedJavascript;
+		PLCore::HashMap<PLCore::String, PLCore::uint32> *m_pQueuedJavascriptKeys;
 
 
 };
@@ -16,6 +16,7 @@ varying   lowp  vec2 VertexTexCoordVS;	// Vertex texture coordinate output
 
 // Uniforms
 uniform highp mat4 ObjectSpaceToClipSpaceMatrix;	// Object space to clip space matrix
+uniform highp vec2 TextureCoordinateScale;			// Used part of the texture, the texture can be bigger than the window
 
 // Programs
 void main()
@@ -26,8 +27,8 @@ void main()
 	// In case you want to have a fullscreen quad in here, replace the line above by
 //	gl_Position = vec4(VertexPosition, 1);
 
-	// Pass through the vertex texture coordinate
-	VertexTexCoordVS = VertexTexCoord;
+	// Scale the vertex texture coordinate to the used part of the texture
+	VertexTexCoordVS = VertexTexCoord*TextureCoordinateScale;
 }
 );	// STRINGIFY
 
@@ -369,6 +369,11 @@ bool Gui::IsAwesomiumInitialized() const
 
 void Gui::MouseMove(const SRPWindows *pSRPWindow, const Vector2i &vMousePos) const
 {
+	if (pSRPWindow->IsUnresponsive())
+	{
+		// a hung page would only pile up mouse moves
+		return;
+	}
 	// move the mouse for awesomium
 	pSRPWindow->GetAwesomiumWindow()->InjectMouseMove(pSRPWindow->GetRelativeMousePosition(vMousePos).x, pSRPWindow->GetRelativeMousePosition(vMousePos).y);
 }
@@ -623,6 +628,11 @@ void Gui::MouseEvents(Control &cControl)
 
 void Gui::MouseClicks(SRPWindows *pSRPWindow, Control &cControl)
 {
+	if (pSRPWindow->IsUnresponsive())
+	{
+		// a hung page can not handle clicks
+		return;
+	}
 	if (cControl.GetName() == "MouseLeft")
 	{
 		// mouse clicked on a window so we need to focus it
@@ -685,7 +695,7 @@ void Gui::MouseScrolls(SRPWindows *pSRPWindow, Control &cControl)
 {
 	if (pSRPWindow)
 	{
-		if (pSRPWindow->GetData()->bIsVisable && pSRPWindow->GetData()->bMouseEnabled)
+		if (pSRPWindow->GetData()->bIsVisable && pSRPWindow->GetData()->bMouseEnabled && !pSRPWindow->IsUnresponsive())
 		{
 			if (cControl.GetType() == ControlAxis)
 			{
@@ -934,7 +944,7 @@ void Gui::KeyboardHandler()
 {
 	/*i am not yet satisfied with this method*/
 
-	if (m_pFocusedWindow)
+	if (m_pFocusedWindow && !m_pFocusedWindow->IsUnresponsive())
 	{
 		if (m_pFocusedWindow->GetData()->bKeyboardEnabled)
 		{
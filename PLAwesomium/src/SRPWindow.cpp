@@ -37,12 +37,20 @@ SRPWindows::SRPWindows(const String &sName) :
 	m_pProgramWrapper(nullptr),
 	m_pTextureBuffer(nullptr),
 	m_cImage(),
+	m_nTextureWidth(0),
+	m_nTextureHeight(0),
 	m_psWindowsData(new sWindowsData),
 	m_bInitialized(false),
 	m_bReadyToDraw(false),
 	m_pDefaultCallBacks(new HashMap<String, sCallBack*>),
 	m_pCallBackFunctions(new HashMap<PLCore::String, PLCore::DynFuncPtr>),
-	m_bIgnoreBufferUpdate(false)
+	m_bIgnoreBufferUpdate(false),
+	m_bUnresponsive(false),
+	m_bUnresponsiveReloaded(false),
+	m_nUnresponsiveStartTime(0),
+	m_nUnresponsiveReloadTime(10000),
+	m_lstQueuedJavascript(),
+	m_pQueuedJavascriptKeys(new HashMap<String, uint32>)
 {
 }
 
@@ -70,6 +78,7 @@ SRPWindows::~SRPWindows()
 	{
 		delete m_pTextureBuffer;
 	}
+	delete m_pQueuedJavascriptKeys;
 }
 
 
@@ -233,8 +242,10 @@ bool SRPWindows::Initialize(Renderer *pRenderer, const Vector2 &vPosition, const
 
 	if (m_pVertexBuffer && m_pProgramWrapper)
 	{
-		// create the image
-		m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, 1));
+		// create the image, the first capacity is the exact size
+		m_nTextureWidth = GetTextureCapacity(m_psWindowsData->nFrameWidth, 0);
+		m_nTextureHeight = GetTextureCapacity(m_psWindowsData->nFrameHeight, 0);
+		m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_nTextureWidth, m_nTextureHeight, 1));
 		// create the texture buffer
 		m_pTextureBuffer = reinterpret_cast<TextureBuffer*>(pRenderer->CreateTextureBuffer2D(m_cImage, TextureBuffer::Unknown, 0));
 
@@ -301,6 +312,11 @@ void SRPWindows::DrawWindow()
 			if (pProgramUniform)
 				pProgramUniform->Set(m_mObjectSpaceToClipSpace);
 
+			// the texture can be bigger than the window, only its upper left part is drawn
+			pProgramUniform = m_pProgramWrapper->GetUniform("TextureCoordinateScale");
+			if (pProgramUniform && m_nTextureWidth > 0 && m_nTextureHeight > 0)
+				pProgramUniform->Set(float(m_psWindowsData->nFrameWidth) / float(m_nTextureWidth), float(m_psWindowsData->nFrameHeight) / float(m_nTextureHeight));
+
 			const int nTextureUnit = m_pProgramWrapper->Set("TextureMap", m_pTextureBuffer);
 			if (nTextureUnit >= 0)
 			{
@@ -388,6 +404,25 @@ void SRPWindows::BufferUploadToGPU()
 }
 
 
+int SRPWindows::GetTextureCapacity(const int &nSize, const int &nCapacity)
+{
+	if (nSize <= nCapacity && nSize >= nCapacity / TEXTURESHRINKDIVISOR)
+	{
+		// the size fits and does not waste too much
+		return nCapacity;
+	}
+	if (nCapacity == 0)
+	{
+		// the first allocation is exact, most windows never change their size
+		return nSize;
+	}
+
+	// leave room to grow, aligned so that nearby sizes end up with the same capacity
+	const int nGrownSize = nSize + nSize / TEXTUREGROWTHDIVISOR;
+	return (nGrownSize + TEXTUREALIGNMENT - 1) / TEXTUREALIGNMENT * TEXTUREALIGNMENT;
+}
+
+
 void SRPWindows::MoveToFront()
 {
 	if (m_bInitialized && m_pCurrentSceneRenderer)
@@ -542,12 +577,20 @@ void SRPWindows::ResizeWindow(const int &nWidth, const int &nHeight)
 	m_psWindowsData->nFrameWidth = nWidth;
 	m_psWindowsData->nFrameHeight = nHeight;
 
-	m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, 1));
-	if (nullptr != m_pTextureBuffer)
+	const int nTextureWidth = GetTextureCapacity(nWidth, m_nTextureWidth);
+	const int nTextureHeight = GetTextureCapacity(nHeight, m_nTextureHeight);
+	if (nTextureWidth != m_nTextureWidth || nTextureHeight != m_nTextureHeight)
 	{
-		delete m_pTextureBuffer;
+		// the size does not fit the capacity, within it only the drawn part of the texture changes
+		m_nTextureWidth = nTextureWidth;
+		m_nTextureHeight = nTextureHeight;
+		m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_nTextureWidth, m_nTextureHeight, 1));
+		if (nullptr != m_pTextureBuffer)
+		{
+			delete m_pTextureBuffer;
+		}
+		m_pTextureBuffer = reinterpret_cast<TextureBuffer*>(m_pCurrentRenderer->CreateTextureBuffer2D(m_cImage, TextureBuffer::Unknown, 0));
 	}
-	m_pTextureBuffer = reinterpret_cast<TextureBuffer*>(m_pCurrentRenderer->CreateTextureBuffer2D(m_cImage, TextureBuffer::Unknown, 0));
 
 	UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(m_psWindowsData->nFrameWidth), float(m_psWindowsData->nFrameHeight)));
 
@@ -637,14 +680,61 @@ void SRPWindows::ExecuteJavascript(const String &sJavascript) const
 }
 
 
+void SRPWindows::EnqueueJavascript(const String &sJavascript, const String &sKey)
+{
+	if (sKey.GetLength())
+	{
+		// javascript with the same key is replaced but keeps its place, the index is stored one based
+		uint32 nIndex = m_pQueuedJavascriptKeys->Get(sKey);
+		if (nIndex)
+		{
+			m_lstQueuedJavascript[nIndex - 1] = sJavascript;
+			return;
+		}
+		m_pQueuedJavascriptKeys->Add(sKey, m_lstQueuedJavascript.GetNumOfElements() + 1);
+	}
+	m_lstQueuedJavascript.Add(sJavascript);
+}
+
+
+void SRPWindows::FlushJavascript()
+{
+	if (m_lstQueuedJavascript.IsEmpty() || !m_pWindow)
+	{
+		return;
+	}
+
+	// one piece that throws should not stop the others
+	String sJavascript = "";
+	for (uint32 i = 0; i < m_lstQueuedJavascript.GetNumOfElements(); i++)
+	{
+		sJavascript = sJavascript + "try{" + m_lstQueuedJavascript[i] + "\n}catch(e){}\n";
+	}
+	m_lstQueuedJavascript.Clear();
+	m_pQueuedJavascriptKeys->Clear();
+
+	ExecuteJavascript(sJavascript);
+}
+
+
 void SRPWindows::UpdateCall()
 {
+	FlushJavascript();
+
+	if (m_bUnresponsive && !m_bUnresponsiveReloaded && m_nUnresponsiveReloadTime > 0 && GetUnresponsiveTime() > m_nUnresponsiveReloadTime)
+	{
+		// reload once, the page might just have ended up in an endless loop
+		m_bUnresponsiveReloaded = true;
+		m_pWindow->Reload(true);
+	}
+
 	Awesomium::BitmapSurface* surface = static_cast<Awesomium::BitmapSurface*>(m_pWindow->surface());
 	if (surface)
 	{
 		if (surface->is_dirty())
 		{
-			surface->CopyTo(m_cImage.GetBuffer()->GetData(), m_psWindowsData->nFrameWidth * 4, 4, false, false);
+			// the rows of the image are as wide as its capacity
+			surface->CopyTo(m_cImage.GetBuffer()->GetData(), m_nTextureWidth * 4, 4, false, false);
 			surface->set_is_dirty(false);
 			BufferUploadToGPU();
 		}
@@ -703,12 +793,38 @@ void SRPWindows::OnShowCreatedWebView(Awesomium::WebView *caller, Awesomium::Web
 void SRPWindows::OnUnresponsive(Awesomium::WebView *caller)
 {
 	DebugToConsole("OnUnresponsive()\n");
+	if (!m_bUnresponsive)
+	{
+		// input is no longer send to the window, see Gui
+		m_bUnresponsive = true;
+		m_bUnresponsiveReloaded = false;
+		m_nUnresponsiveStartTime = Timing::GetInstance()->GetPastTime();
+	}
 }
 
 
 void SRPWindows::OnResponsive(Awesomium::WebView *caller)
 {
 	DebugToConsole("OnResponsive()\n");
+	m_bUnresponsive = false;
+}
+
+
+bool SRPWindows::IsUnresponsive() const
+{
+	return m_bUnresponsive;
+}
+
+
+uint64 SRPWindows::GetUnresponsiveTime() const
+{
+	return m_bUnresponsive ? (Timing::GetInstance()->GetPastTime() - m_nUnresponsiveStartTime) : 0;
+}
+
+
+void SRPWindows::SetUnresponsiveReloadTime(const uint32 &nSeconds)
+{
+	m_nUnresponsiveReloadTime = uint64(nSeconds) * 1000;
 }
 
 
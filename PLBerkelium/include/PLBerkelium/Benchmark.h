@@ -0,0 +1,164 @@
+#ifndef __PLBERKELIUM_BENCHMARK_H__
+#define __PLBERKELIUM_BENCHMARK_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/System/System.h>
+#include <PLCore/System/Console.h>
+#include <PLCore/Base/Func/Func.h>
+
+#include "berkelium/ScriptVariant.hpp"
+
+#include "PLBerkelium.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+class Gui;
+
+
+//[-------------------------------------------------------]
+//[ Defines                                               ]
+//[-------------------------------------------------------]
+#define BENCHMARKDEFAULTRUNS 10000
+#define BENCHMARKDEFAULTRECORDS 10000
+#define BENCHMARKDEFAULTTRANSFERS 10
+#define BENCHMARKDEFAULTWINDOWS 8
+#define BENCHMARKDEFAULTURL "data:text/html,<html><body onload=\"NativePost()\"></body></html>"
+#define BENCHMARKWINDOWNAME "PLBerkelium::Benchmark"
+
+
+//[-------------------------------------------------------]
+//[ Structures                                            ]
+//[-------------------------------------------------------]
+struct sBenchmarkResult
+{
+	PLCore::uint32 nRuns;							/**< Number of times each path has been run */
+	PLCore::uint64 nTime;							/**< Time in microseconds of all runs of the measured path, 0 if it could not be run */
+	PLCore::uint64 nBaselineTime;					/**< Time in microseconds of all runs of the path it is compared against */
+	PLCore::uint64 nSize;							/**< Bytes produced by one run of the measured path, 0 if not of interest */
+	PLCore::uint64 nBaselineSize;					/**< Bytes produced by one run of the path it is compared against, 0 if not of interest */
+};
+
+
+struct sWindowBenchmarkResult
+{
+	PLCore::uint32 nWindows;						/**< Number of windows that have been created */
+	PLCore::uint64 nCreateTime;						/**< Average time in microseconds of creating a berkelium window, see SRPWindow::GetCreateTime() */
+	PLCore::uint64 nFirstPaintLatency;				/**< Average time in microseconds until the first paint, see SRPWindow::GetFirstPaintLatency() */
+	PLCore::uint64 nFirstCallBackLatency;			/**< Average time in microseconds until the first interaction, see SRPWindow::GetFirstCallBackLatency() */
+};
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Runs the same workload through two paths of the plugin and reports the timings
+*
+*  @remarks
+*    The counters of SRPWindow only tell how much time a running application spends in each path,
+*    a benchmark runs the same workload through both paths so that they can actually be compared.
+*/
+class Benchmark {
+
+
+	public:
+		/**
+		*  @brief
+		*    Runs all benchmarks that need no window and prints the results to the console
+		*
+		*  @param[in] const PLCore::uint32 & nRuns
+		*    number of runs of each callback, the transfers use their defaults
+		*/
+		PLBERKELIUM_API static void Run(const PLCore::uint32 &nRuns = BENCHMARKDEFAULTRUNS);
+
+		/**
+		*  @brief
+		*    Calls a callback function with the same arguments through the typed and through the string path
+		*
+		*  @param[in] PLCore::DynFunc & cDynFunc
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*  @param[in] const PLCore::uint32 & nRuns
+		*
+		*  @return
+		*    the typed path is the measured path, the string path is the baseline
+		*/
+		PLBERKELIUM_API static sBenchmarkResult CallBack(PLCore::DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, const PLCore::uint32 &nRuns = BENCHMARKDEFAULTRUNS);
+
+		/**
+		*  @brief
+		*    Transfers the same records as blob through SRPWindow::SendBinary() and as JSON literal
+		*
+		*  @remarks
+		*    A record is an id, a position and flags (16 bytes), like a map marker. Measured is building the javascript
+		*    that is executed in the page, the size tells what the page has to parse: a base64 string for atob() against
+		*    a literal of objects.
+		*
+		*  @param[in] const PLCore::uint32 & nRecords
+		*  @param[in] const PLCore::uint32 & nRuns
+		*
+		*  @return
+		*    the blob is the measured path, JSON is the baseline, the sizes are those of the javascript of one transfer
+		*/
+		PLBERKELIUM_API static sBenchmarkResult BinaryTransfer(const PLCore::uint32 &nRecords = BENCHMARKDEFAULTRECORDS, const PLCore::uint32 &nRuns = BENCHMARKDEFAULTTRANSFERS);
+
+		/**
+		*  @brief
+		*    Creates windows and measures the time until they paint and their pages call back
+		*
+		*  @remarks
+		*    Creating a window is asynchronous and its paints only arrive while it is drawn, so call this on every update
+		*    until it returns 'true'. The first call adds the visible windows and creates their berkelium windows,
+		*    the last call removes them again. The windows get the bootstrap script of Gui like any other window.
+		*
+		*  @param[in] Gui & cGui
+		*  @param[out] sWindowBenchmarkResult & sResult
+		*    receives the averages, only valid when 'true' is returned
+		*  @param[in] const PLCore::uint32 & nWindows
+		*  @param[in] const PLCore::String & sUrl
+		*    page that calls back once it has loaded, the default page calls NativePost()
+		*
+		*  @return
+		*    'true' if the benchmark is done, else 'false'
+		*/
+		PLBERKELIUM_API static bool WindowCreation(Gui &cGui, sWindowBenchmarkResult &sResult, const PLCore::uint32 &nWindows = BENCHMARKDEFAULTWINDOWS, const PLCore::String &sUrl = BENCHMARKDEFAULTURL);
+
+		/**
+		*  @brief
+		*    Prints a result to the console
+		*
+		*  @param[in] const PLCore::String & sName
+		*  @param[in] const sBenchmarkResult & sResult
+		*/
+		PLBERKELIUM_API static void Print(const PLCore::String &sName, const sBenchmarkResult &sResult);
+
+		/**
+		*  @brief
+		*    Prints a result of WindowCreation() to the console
+		*
+		*  @param[in] const PLCore::String & sName
+		*  @param[in] const sWindowBenchmarkResult & sResult
+		*/
+		PLBERKELIUM_API static void Print(const PLCore::String &sName, const sWindowBenchmarkResult &sResult);
+
+
+};
+
+
+};
+
+
+#endif // __PLBERKELIUM_BENCHMARK_H__
@@ -0,0 +1,204 @@
+#ifndef __PLBERKELIUM_BERKELIUMTHREAD_H__
+#define __PLBERKELIUM_BERKELIUMTHREAD_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/System/System.h>
+#include <PLCore/System/Console.h>
+#include <PLCore/System/Thread.h>
+#include <PLCore/System/Semaphore.h>
+
+#include "berkelium/Berkelium.hpp"
+
+#include "PLBerkelium.h"
+#include "SPSCQueue.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Forward declarations                                  ]
+//[-------------------------------------------------------]
+class SRPWindow;
+
+
+//[-------------------------------------------------------]
+//[ Defines                                               ]
+//[-------------------------------------------------------]
+#define BERKELIUMTHREADIDLETIME 5
+
+
+//[-------------------------------------------------------]
+//[ Structures                                            ]
+//[-------------------------------------------------------]
+struct sBrowserCommand
+{
+	enum EType
+	{
+		CommandCreate,
+		CommandDestroy,
+		CommandDestroyContext,
+		CommandBind,
+		CommandEvalOnStartLoading,
+		CommandSettings,
+		CommandNavigate,
+		CommandResize,
+		CommandJavascript,
+		CommandMouseMove,
+		CommandMouseButton,
+		CommandMouseWheel,
+		CommandText,
+		CommandKey,
+		CommandFocus,
+		CommandUnfocus,
+		CommandScriptReturn,
+		CommandReload
+	};
+
+	PLCore::uint32 nType;
+	SRPWindow *pSRPWindow;							/**< Shared, the window the command is for, do not free the memory */
+	int nParam[4];
+	PLCore::String sParam[2];
+	void *pParam;									/**< Shared, the reply identifier of berkelium or the bootstrap script of Gui, do not free the memory */
+};
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Thread that owns berkelium
+*
+*  @remarks
+*    Berkelium runs a chromium message loop that is bound to the thread that initialized it,
+*    so every call into berkelium has to come from this thread once it is used.
+*    Other threads push commands which are executed before every berkelium update.
+*    Results travel back through the queues of the windows, see SRPWindow.
+*    When there was nothing to do the thread waits up to BERKELIUMTHREADIDLETIME milliseconds for the next command
+*    before it updates berkelium again, a pushed command wakes it up right away.
+*/
+class BerkeliumThread : public PLCore::Thread {
+
+
+	public:
+		PLBERKELIUM_API BerkeliumThread();
+		PLBERKELIUM_API virtual ~BerkeliumThread();
+
+		/**
+		*  @brief
+		*    Waits until the thread has tried to initialize berkelium
+		*
+		*  @return
+		*    'true' if berkelium is initialized, else 'false'
+		*/
+		PLBERKELIUM_API bool WaitForInitialization() const;
+
+		/**
+		*  @brief
+		*    Returns whether or not the calling thread is this thread
+		*
+		*  @return
+		*    'true' if called from this thread, else 'false'
+		*/
+		PLBERKELIUM_API bool IsCurrentThread() const;
+
+		/**
+		*  @brief
+		*    Pushes a command to be executed by this thread
+		*
+		*  @note
+		*    There may only be one thread pushing commands, which is the thread that created this instance.
+		*
+		*  @param[in] sBrowserCommand * psCommand
+		*    command to execute, this thread destroys the instance when executed
+		*/
+		PLBERKELIUM_API void PushCommand(sBrowserCommand *psCommand);
+
+		/**
+		*  @brief
+		*    Returns the amount of commands that have been pushed
+		*
+		*  @return
+		*    amount of pushed commands, see IsExecuted()
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetNumOfPushedCommands() const;
+
+		/**
+		*  @brief
+		*    Returns whether or not the commands that had been pushed at some point have all been executed
+		*
+		*  @param[in] const PLCore::uint32 & nPushedCommands
+		*    amount of pushed commands at that point, see GetNumOfPushedCommands()
+		*
+		*  @return
+		*    'true' if the commands have been executed or will never be, else 'false'
+		*/
+		PLBERKELIUM_API bool IsExecuted(const PLCore::uint32 &nPushedCommands) const;
+
+		/**
+		*  @brief
+		*    Returns the amount of commands that have been executed
+		*
+		*  @return
+		*    amount of executed commands, compare it to GetNumOfPushedCommands()
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetNumOfExecutedCommands() const;
+
+		/**
+		*  @brief
+		*    Waits until all pushed commands have been executed
+		*/
+		PLBERKELIUM_API void Flush() const;
+
+		/**
+		*  @brief
+		*    Executes the remaining commands, stops berkelium and waits for the thread to finish
+		*/
+		PLBERKELIUM_API void Stop();
+
+	protected:
+
+	private:
+		virtual int Run() override;
+
+		/**
+		*  @brief
+		*    Executes all pending commands
+		*
+		*  @return
+		*    'true' if at least one command was executed, else 'false'
+		*/
+		bool ProcessCommands();
+
+		/**
+		*  @brief
+		*    Executes a command
+		*
+		*  @param[in] const sBrowserCommand * psCommand
+		*/
+		void ExecuteCommand(const sBrowserCommand *psCommand);
+
+		SPSCQueue<sBrowserCommand*> m_cCommandQueue;
+		PLCore::Semaphore m_cCommandSignal;			/**< Unlocked when a command is pushed, the thread waits on it when idle */
+		volatile bool m_bInitializing;
+		volatile bool m_bBerkeliumInitialized;
+		volatile bool m_bStopRequested;
+		PLCore::uint32 m_nPushedCommands;
+		volatile PLCore::uint32 m_nExecutedCommands;
+
+
+};
+
+
+};
+
+
+#endif // __PLBERKELIUM_BERKELIUMTHREAD_H__
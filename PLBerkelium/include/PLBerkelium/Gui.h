@@ -37,6 +37,9 @@
 #include "PLBerkelium.h"
 #include "SRPWindow.h"
 #include "SRPMousePointer.h"
+#include "BerkeliumThread.h"
+#include "TexturePool.h"
+#include "TextureAtlas.h"
 
 
 //[-------------------------------------------------------]
@@ -49,17 +52,42 @@ namespace PLBerkelium {
 //[ Defines                                               ]
 //[-------------------------------------------------------]
 #define BERKELIUMDUMMYWINDOW "berkeliumdummywindow"
+#define BERKELIUMIDLEPUMPINTERVAL 100
+#define MAXKEYSTATES 256
+#define CONTROLACTIONBITS 8
 
 
 //[-------------------------------------------------------]
 //[ Structures                                            ]
 //[-------------------------------------------------------]
-struct sButton
+struct sKeyState
 {
-	PLCore::String sKey;
-	char nKey;
-	bool bValid;
-	bool bMod;
+	bool bDown;
+	bool bText;										/**< The key is send as text, else as virtual key */
+	PLCore::String sText;
+	int nKeyCode;									/**< Virtual key code, the character of the key */
+	PLCore::uint64 nNextRepeatTime;					/**< Past time in milliseconds the key repeats the next time */
+};
+
+
+struct sInputEvent
+{
+	enum EType
+	{
+		InputMouseMove,
+		InputMouseButton,
+		InputMouseWheel,
+		InputText,
+		InputKey,
+		InputFocus,
+		InputUnfocus
+	};
+
+	PLCore::uint32 nType;
+	PLCore::uint64 nTime;							/**< Time in microseconds the input has occurred, a merged event keeps the earliest one */
+	SRPWindow *pSRPWindow;							/**< Shared, the window the input is for, do not free the memory */
+	int nParam[4];
+	PLCore::String sText;
 };
 
 
@@ -74,14 +102,69 @@ class Gui : public PLCore::Object {
 	//[-------------------------------------------------------]
 	pl_class(PLBERKELIUM_RTTI_EXPORT, Gui, "PLBerkelium", PLCore::Object, "")
 		pl_constructor_0(DefaultConstructor, "Default constructor", "")
+		pl_constructor_1(ParameterConstructor, bool, "Parameter constructor, 'true' to run berkelium on its own thread as first parameter", "")
 		pl_slot_0(OnUpdate, "Called on event update by scene context", "")
 		pl_slot_1(OnControl, PLInput::Control&, "Called when a control event has occurred, occurred control as first parameter", "")
 	pl_class_end
 
 
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Pump mode flags, see SetPumpMode()
+		*/
+		enum EPumpMode
+		{
+			PumpOnce		= 0,	/**< Update berkelium exactly once per update (default) */
+			PumpBudget		= 1,	/**< Update berkelium repeatedly until the pump budget is used up, see SetPumpBudget() */
+			PumpLowLatency	= 2,	/**< Update berkelium once more on update when input has been send to a window, so the paint shows up in the same frame */
+			PumpIdle		= 4		/**< Skip updating berkelium when every window is hidden and idle */
+		};
+
+		/**
+		*  @brief
+		*    Actions controls are mapped to, see ConnectController()
+		*/
+		enum EControlAction
+		{
+			ActionUnknown		= 0,	/**< The control has not been mapped yet */
+			ActionNone			= 1,	/**< The control is not processed */
+			ActionMouseMove		= 2,	/**< Mouse control that only moves the mouse (axes and other buttons) */
+			ActionMouseLeft		= 3,	/**< Left mouse button */
+			ActionMouseRight	= 4,	/**< Right mouse button */
+			ActionMouseWheel	= 5,	/**< Mouse wheel axis */
+			ActionKeyText		= 6,	/**< Keyboard key that is send as text */
+			ActionKeyVirtual	= 7		/**< Keyboard key that is send as virtual key */
+		};
+
+
 	public:
-		PLBERKELIUM_API Gui();
+		/**
+		*  @brief
+		*    Constructor
+		*
+		*  @remarks
+		*    When berkelium runs on its own thread, that thread owns berkelium and updates it continuously.
+		*    Input and other calls are send to it as commands, paints come back through the queues of the windows and are applied when drawing.
+		*    This keeps a slow page from stalling the frame, but the berkelium windows may then only be used from that thread.
+		*
+		*  @param[in] const bool & bThreaded
+		*    'true' to run berkelium on its own thread, else 'false' (default)
+		*/
+		PLBERKELIUM_API Gui(const bool &bThreaded = false);
 		PLBERKELIUM_API virtual ~Gui();
+		
+		/**
+		*  @brief
+		*    Returns whether or not berkelium runs on its own thread
+		*
+		*  @return
+		*    'true' if berkelium runs on its own thread, else 'false'
+		*/
+		PLBERKELIUM_API bool IsBerkeliumThreaded() const;
 
 		/**
 		*  @brief
@@ -128,6 +211,7 @@ class Gui : public PLCore::Object {
 		*
 		*  @remarks
 		*    If the window cannot be found this returns a pointer to the dummy window.
+		*    The dummy window has no berkelium window behind it, it only exists so that called methods do not crash.
 		*    You could for example verify that the returned window is the one you requested by verifying its name or properties.
 		*
 		*  @param[in] const PLCore::String & sName
@@ -142,12 +226,14 @@ class Gui : public PLCore::Object {
 		*    Returns the berkelium window instance of a window by name
 		*
 		*  @remarks
-		*    If the window holding the berkelium window instance cannot be found this returns a pointer to the one of the dummy window.
+		*    The berkelium window instance is created on demand, the first time a window is shown or navigated,
+		*    or when it is asked for with this method.
+		*    If the window cannot be found or its berkelium window could not be created this returns a null pointer.
 		*
 		*  @param[in] const PLCore::String & sName
 		*
 		*  @return
-		*    pointer to berkelium window instance (do not destroy the returned instance!)
+		*    pointer to berkelium window instance (can be a null pointer, do not destroy the returned instance!)
 		*/
 		PLBERKELIUM_API Berkelium::Window *GetBerkeliumWindow(const PLCore::String &sName);
 		
@@ -169,9 +255,165 @@ class Gui : public PLCore::Object {
 		*
 		*  @note
 		*    You dont really need to call this, because it would be called by the SceneContext OnUpdate event if ConnectEventUpdate() is set.
+		*    This always updates berkelium exactly once, the pump mode is only used on update.
+		*    This does nothing when berkelium runs on its own thread.
 		*/
 		PLBERKELIUM_API void UpdateBerkelium();
 		
+		/**
+		*  @brief
+		*    Sets how berkelium is updated on update
+		*
+		*  @param[in] const PLCore::uint32 & nPumpMode
+		*    combination of EPumpMode flags
+		*/
+		PLBERKELIUM_API void SetPumpMode(const PLCore::uint32 &nPumpMode);
+		
+		/**
+		*  @brief
+		*    Returns how berkelium is updated on update
+		*
+		*  @return
+		*    combination of EPumpMode flags
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetPumpMode() const;
+		
+		/**
+		*  @brief
+		*    Sets the time slice berkelium may use per update when PumpBudget is set
+		*
+		*  @remarks
+		*    Berkelium does not tell whether an update processed any messages,
+		*    so the amount of updates per frame is also limited by the given maximum.
+		*
+		*  @param[in] const PLCore::uint32 & nMicroseconds
+		*  @param[in] const PLCore::uint32 & nMaxPumps
+		*/
+		PLBERKELIUM_API void SetPumpBudget(const PLCore::uint32 &nMicroseconds, const PLCore::uint32 &nMaxPumps = 8);
+		
+		/**
+		*  @brief
+		*    Returns the time spent updating berkelium during the last frame
+		*
+		*  @remarks
+		*    This includes the update done for input when PumpLowLatency is set.
+		*    When berkelium runs on its own thread nothing is updated on update, so this is always 0.
+		*
+		*  @return
+		*    time in microseconds
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetPumpTime() const;
+		
+		/**
+		*  @brief
+		*    Returns the amount of berkelium updates during the last frame
+		*
+		*  @return
+		*    amount of updates, 0 if the update was skipped because all windows where idle
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetPumpCount() const;
+		
+		/**
+		*  @brief
+		*    Returns the amount of input events that where merged into a queued one
+		*
+		*  @remarks
+		*    Input is queued and send right before berkelium updates. Mouse moves of a window are merged
+		*    into the latest position and wheel deltas are summed, buttons and keys keep their order.
+		*
+		*  @return
+		*    amount of merged input events
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetCoalescedInputCount() const;
+		
+		/**
+		*  @brief
+		*    Sets how a held key repeats
+		*
+		*  @remarks
+		*    The key that was pressed last repeats while it is held. The repeats are derived from the time the key
+		*    was pressed, so the rate does not depend on the frame rate. At most one repeat is send per update,
+		*    when updates are further apart than the rate (e.g. after a stall) the missed repeats are dropped instead
+		*    of being send in a burst.
+		*
+		*  @param[in] const PLCore::uint32 & nDelay
+		*    milliseconds until the first repeat (default 400)
+		*  @param[in] const PLCore::uint32 & nRate
+		*    milliseconds between the following repeats (default 50), at least 1
+		*/
+		PLBERKELIUM_API void SetKeyRepeat(const PLCore::uint32 &nDelay, const PLCore::uint32 &nRate);
+		
+		/**
+		*  @brief
+		*    Returns the milliseconds until a held key repeats
+		*
+		*  @return
+		*    delay in milliseconds
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetKeyRepeatDelay() const;
+		
+		/**
+		*  @brief
+		*    Returns the milliseconds between the repeats of a held key
+		*
+		*  @return
+		*    rate in milliseconds
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetKeyRepeatRate() const;
+		
+		/**
+		*  @brief
+		*    Adds a helper library to the bootstrap script of all windows
+		*
+		*  @remarks
+		*    The bootstrap script contains native.post() and the like plus all helper libraries, it is built once and
+		*    shared by all windows, each page gets it in one step when it starts loading instead of loading the libraries itself.
+		*    Windows that already have a berkelium window get the library applied to their open page and to the pages they load later,
+		*    a replaced library runs after the previous version on those pages until their berkelium window is created again.
+		*
+		*  @param[in] const PLCore::String & sName
+		*    name of the library, a library with the same name is replaced
+		*  @param[in] const PLCore::String & sJavascript
+		*    source code of the library, errors do not affect the other libraries
+		*/
+		PLBERKELIUM_API void AddBootstrapScript(const PLCore::String &sName, const PLCore::String &sJavascript);
+		
+		/**
+		*  @brief
+		*    Removes a helper library from the bootstrap script of all windows
+		*
+		*  @note
+		*    The library is not removed from pages that are open already, nor from windows that already have a berkelium window
+		*    until their berkelium window is created again, berkelium has no way to take back a script.
+		*
+		*  @param[in] const PLCore::String & sName
+		*
+		*  @return
+		*    'true' if the library was removed, else 'false'
+		*/
+		PLBERKELIUM_API bool RemoveBootstrapScript(const PLCore::String &sName);
+		
+		/**
+		*  @brief
+		*    Returns the bootstrap script all windows are created with
+		*
+		*  @return
+		*    the pre-built script
+		*/
+		PLBERKELIUM_API const PLCore::String &GetBootstrapScript() const;
+		
+		/**
+		*  @brief
+		*    Returns how often the bootstrap script was built
+		*
+		*  @remarks
+		*    The script is only built when the helper libraries change, never per window.
+		*
+		*  @return
+		*    number of builds
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetBootstrapBuildCount() const;
+		
 		/**
 		*  @brief
 		*    Destroys this Gui instance
@@ -199,6 +441,53 @@ class Gui : public PLCore::Object {
 		*/
 		PLBERKELIUM_API void SetRenderers(PLRenderer::Renderer *pRenderer, PLScene::SceneRenderer *pSceneRenderer);
 		
+		/**
+		*  @brief
+		*    Returns the pool the windows take their textures and vertex buffers from
+		*
+		*  @remarks
+		*    The pool is created by SetRenderers(), use it to change the memory limit and trim time or to read its counters.
+		*
+		*  @return
+		*    texture pool, a null pointer when the renderers are not set yet
+		*/
+		PLBERKELIUM_API TexturePool *GetTexturePool() const;
+		
+		/**
+		*  @brief
+		*    Sets if small windows and widgets are drawn from a shared texture atlas
+		*
+		*  @remarks
+		*    A change of a rect uploads its whole atlas page, windows that paint in most frames are therefore moved to pages
+		*    of their own so that they do not upload the pages of the windows that seldom paint, like labels and tooltips.
+		*    Only windows that are added afterwards are affected, windows that are already in the atlas stay there.
+		*
+		*  @param[in] const bool & bEnabled
+		*    'true' to draw small windows from the atlas (default), 'false' to give every window its own texture
+		*/
+		PLBERKELIUM_API void SetTextureAtlasEnabled(const bool &bEnabled);
+		
+		/**
+		*  @brief
+		*    Returns if small windows and widgets are drawn from a shared texture atlas
+		*
+		*  @return
+		*    'true' if the atlas is enabled, else 'false'
+		*/
+		PLBERKELIUM_API bool IsTextureAtlasEnabled() const;
+		
+		/**
+		*  @brief
+		*    Returns the atlas small windows and widgets are drawn from
+		*
+		*  @remarks
+		*    The atlas is created once it is enabled and the renderers are set, use it to enable batching or to read its utilisation and fragmentation.
+		*
+		*  @return
+		*    texture atlas, a null pointer when the atlas has not been enabled or the renderers are not set yet
+		*/
+		PLBERKELIUM_API TextureAtlas *GetTextureAtlas() const;
+		
 		/**
 		*  @brief
 		*    Returns the data of a window by name
@@ -276,11 +565,18 @@ class Gui : public PLCore::Object {
 		*
 		*  @remarks
 		*    This is needed to process the update structure which includes;
+		*    -> JavascriptHandler()
 		*    -> UpdateBerkelium()
 		*    -> KeyboardHandler()
+		*    -> CoalescedCallBackHandler()
 		*    -> DefaultCallBackHandler()
 		*    -> DragWindowHandler()
 		*    -> ResizeWindowHandler()
+		*    -> AutoFreezeHandler()
+		*    -> WatchdogHandler()
+		*    -> TexturePoolHandler()
+		*    -> TextureAtlasHandler()
+		*    -> BootstrapScriptHandler()
 		*
 		*  @note
 		*    Not setting this will disable the above from being called by the EventUpdate.
@@ -321,6 +617,7 @@ class Gui : public PLCore::Object {
 		*
 		*  @note
 		*    Window will be unfocused if you want to hide it.
+		*    Showing a window for the first time creates its berkelium window instance.
 		*
 		*  @param[in] const PLCore::String & sName
 		*  @param[in] const bool & bVisible
@@ -358,7 +655,7 @@ class Gui : public PLCore::Object {
 		*    Initializes needed components
 		*
 		*  @remarks
-		*    This creates and initializes berkelium and creates a dummy window.
+		*    This initializes berkelium and creates a dummy window.
 		*/
 		void Initialize();
 		
@@ -366,40 +663,71 @@ class Gui : public PLCore::Object {
 		*  @brief
 		*    Stops running berkelium
 		*/
-		void StopBerkelium() const;
+		void StopBerkelium();
 		
 		/**
 		*  @brief
-		*    Adds a dummy window and set its data
+		*    Creates the dummy window and set its data
+		*
+		*  @remarks
+		*    The dummy window is never initialized and never creates a berkelium window, therefor it costs no renderer process.
 		*/
 		void AddDummyWindow();
+		
+		/**
+		*  @brief
+		*    Destroys the dummy window
+		*/
+		void DestroyDummyWindow();
 		
 		/**
 		*  @brief
-		*    Returns mouse enabled window(s)
+		*    Returns the top most window the mouse is over
 		*
 		*  @remarks
-		*    This iterates trough all windows and returns a list of those that allow mouse events.
+		*    The windows are kept sorted front to back, so this stops at the first visible and mouse enabled window
+		*    (or one of its widgets) that is hit, nothing is allocated. The position, size and visibility are read from the
+		*    window data, the order is only sorted again when windows are added, removed or moved to front.
+		*
+		*  @param[in] const PLMath::Vector2i & vMousePos
 		*
 		*  @return
-		*    Pointer to the list created (can be a null pointer, destroy the returned instance when you no longer need it)
+		*    pointer to window (can be a null pointer, do not destroy the returned instance!)
 		*/
-		PLCore::List<SRPWindow*> *GetMouseEnabledWindows();
+		SRPWindow *GetWindowAt(const PLMath::Vector2i &vMousePos);
 		
 		/**
 		*  @brief
-		*    Returns window(s) if the mouse is currently over them
+		*    Sorts the windows front to back for GetWindowAt()
 		*
-		*  @note
-		*    This iterates trough windows given as parameter and returns a list of those where the mouse is currently over.
+		*  @remarks
+		*    Windows without a scene render pass index are put behind all others, they are only a fallback.
+		*/
+		void UpdateHitTestWindows();
+		
+		/**
+		*  @brief
+		*    Updates berkelium according to the pump mode
 		*
-		*  @param[in] const PLCore::List<SRPWindow * > * plstEnabledWindows
-		*  @param[in] const PLMath::Vector2i & vMousePos
+		*  @remarks
+		*    When berkelium runs on its own thread this processes the events it has send to the windows instead.
+		*
+		*  @see
+		*    - SetPumpMode()
+		*/
+		void PumpBerkelium();
+		
+		/**
+		*  @brief
+		*    Returns whether or not every window is hidden and idle
+		*
+		*  @remarks
+		*    A window is idle when it is not visible and is not loading a page.
 		*
 		*  @return
-		*    Pointer to the list created (can be a null pointer, destroy the returned instance when you no longer need it)
+		*    'true' if all windows are idle, else 'false'
 		*/
-		PLCore::List<SRPWindow*> *GetMouseOverWindows(const PLCore::List<SRPWindow*> *plstEnabledWindows, const PLMath::Vector2i &vMousePos);
+		bool AreAllWindowsIdle() const;
 		
 		/**
 		*  @brief
@@ -419,11 +747,18 @@ class Gui : public PLCore::Object {
 		*
 		*  @remarks
 		*    Processes the update structure which includes;
+		*    -> JavascriptHandler()
 		*    -> UpdateBerkelium()
 		*    -> KeyboardHandler()
+		*    -> CoalescedCallBackHandler()
 		*    -> DefaultCallBackHandler()
 		*    -> DragWindowHandler()
 		*    -> ResizeWindowHandler()
+		*    -> AutoFreezeHandler()
+		*    -> WatchdogHandler()
+		*    -> TexturePoolHandler()
+		*    -> TextureAtlasHandler()
+		*    -> BootstrapScriptHandler()
 		*/
 		void OnUpdate();
 		
@@ -432,31 +767,19 @@ class Gui : public PLCore::Object {
 		*    Processes all mouse events
 		*
 		*  @param[in] PLInput::Control & cControl
+		*  @param[in] const PLCore::uint32 & nAction
+		*    action of the control, see EControlAction
 		*/
-		void MouseEvents(PLInput::Control &cControl);
-		
-		/**
-		*  @brief
-		*    Returns top most window
-		*
-		*  @remarks
-		*    This iterates trough windows given as parameter and returns the top most one.
-		*
-		*  @param[in] PLCore::List<SRPWindow * > * plstWindows
-		*
-		*  @return
-		*    pointer to window (can be a null pointer, do not destroy the returned instance!)
-		*/
-		SRPWindow *GetTopMostWindow(PLCore::List<SRPWindow*> *plstWindows);
+		void MouseEvents(PLInput::Control &cControl, const PLCore::uint32 &nAction);
 		
 		/**
 		*  @brief
 		*    Process mouse moving on a window
 		*
-		*  @param[in] const SRPWindow * pSRPWindow
+		*  @param[in] SRPWindow * pSRPWindow
 		*  @param[in] const PLMath::Vector2i & vMousePos
 		*/
-		void MouseMove(const SRPWindow *pSRPWindow, const PLMath::Vector2i &vMousePos) const;
+		void MouseMove(SRPWindow *pSRPWindow, const PLMath::Vector2i &vMousePos);
 		
 		/**
 		*  @brief
@@ -464,8 +787,9 @@ class Gui : public PLCore::Object {
 		*
 		*  @param[in] SRPWindow * pSRPWindow
 		*  @param[in] PLInput::Control & cControl
+		*  @param[in] const PLCore::uint32 & nAction
 		*/
-		void MouseClicks(SRPWindow *pSRPWindow, PLInput::Control &cControl);
+		void MouseClicks(SRPWindow *pSRPWindow, PLInput::Control &cControl, const PLCore::uint32 &nAction);
 		
 		/**
 		*  @brief
@@ -473,13 +797,51 @@ class Gui : public PLCore::Object {
 		*
 		*  @param[in] SRPWindow * pSRPWindow
 		*  @param[in] PLInput::Control & cControl
+		*  @param[in] const PLCore::uint32 & nAction
 		*/
-		void MouseScrolls(SRPWindow *pSRPWindow, PLInput::Control &cControl);
+		void MouseScrolls(SRPWindow *pSRPWindow, PLInput::Control &cControl, const PLCore::uint32 &nAction);
+		
+		/**
+		*  @brief
+		*    Queues input for a window until berkelium updates
+		*
+		*  @remarks
+		*    A mouse move replaces a queued mouse move of the window and a wheel delta is added to a queued one,
+		*    as long as no button or key has been queued since. Buttons, keys and focus changes are always queued in order.
+		*
+		*  @param[in] const PLCore::uint32 & nType
+		*    see sInputEvent::EType
+		*  @param[in] SRPWindow * pSRPWindow
+		*  @param[in] const int & nParam0
+		*  @param[in] const int & nParam1
+		*  @param[in] const int & nParam2
+		*  @param[in] const int & nParam3
+		*  @param[in] const PLCore::String & sText
+		*/
+		void QueueInputEvent(const PLCore::uint32 &nType, SRPWindow *pSRPWindow, const int &nParam0 = 0, const int &nParam1 = 0, const int &nParam2 = 0, const int &nParam3 = 0, const PLCore::String &sText = "");
+		
+		/**
+		*  @brief
+		*    Sends the queued input to berkelium
+		*/
+		void FlushInputEvents();
+		
+		/**
+		*  @brief
+		*    Removes the queued input of a window
+		*
+		*  @param[in] const SRPWindow * pSRPWindow
+		*    window that is about to be destroyed, a null pointer to remove all input
+		*/
+		void RemoveInputEvents(const SRPWindow *pSRPWindow);
 		
 		/**
 		*  @brief
 		*    On control method that should be called when a control event is fired
 		*
+		*  @remarks
+		*    The control is only passed to the handler of its action.
+		*
 		*  @note
 		*    This only happens if you have connected the controller, see ConnectController().
 		*
@@ -492,18 +854,100 @@ class Gui : public PLCore::Object {
 		*    Handles all default callbacks
 		*
 		*  @remarks
-		*    This iterates trough the windows and checks if any of them have callbacks.
-		*    If the callbacks are predefined as default then a correspondent action is taken.
+		*    The windows report the default callbacks javascript has called to a queue, this drains the queue
+		*    and takes the correspondent action. Windows without callbacks cost nothing.
 		*/
 		void DefaultCallBackHandler();
+		
+		/**
+		*  @brief
+		*    Removes the queued default callback events of a window
+		*
+		*  @param[in] const SRPWindow * pSRPWindow
+		*    window that is about to be destroyed, a null pointer to remove all events
+		*/
+		void RemoveDefaultCallBackEvents(const SRPWindow *pSRPWindow);
+		
+		/**
+		*  @brief
+		*    Builds the bootstrap script from the built-in script and the helper libraries and hands it to the windows
+		*
+		*  @remarks
+		*    A build is kept until the berkelium thread has executed the commands that may read it, see BootstrapScriptHandler().
+		*/
+		void BuildBootstrapScript();
+		
+		/**
+		*  @brief
+		*    Dispatches the coalesced calls of callback functions of all windows
+		*
+		*  @see
+		*    - SRPWindow::AddCallBackFunction()
+		*/
+		void CoalescedCallBackHandler();
+		
+		/**
+		*  @brief
+		*    Executes the queued javascript of all windows
+		*
+		*  @see
+		*    - SRPWindow::EnqueueJavascript()
+		*/
+		void JavascriptHandler();
 		
 		/**
 		*  @brief
 		*    Processes all keyboard events
 		*
 		*  @param[in] PLInput::Control & cControl
+		*  @param[in] const PLCore::uint32 & nAction
+		*    ActionKeyText or ActionKeyVirtual
+		*  @param[in] const PLCore::uint32 & nKeySlot
+		*    index of the state of the key, see GetControlAction()
 		*/
-		void KeyboardEvents(PLInput::Control &cControl);
+		void KeyboardEvents(PLInput::Control &cControl, const PLCore::uint32 &nAction, const PLCore::uint32 &nKeySlot);
+		
+		/**
+		*  @brief
+		*    Returns the action of a control
+		*
+		*  @remarks
+		*    The controls of the connected controller are mapped when it is connected, other controls the first time they occur.
+		*
+		*  @param[in] PLInput::Control & cControl
+		*  @param[out] PLCore::uint32 & nKeySlot
+		*    receives the index of the state of a key, unchanged for any other control
+		*
+		*  @return
+		*    the action, see EControlAction
+		*/
+		PLCore::uint32 GetControlAction(PLInput::Control &cControl, PLCore::uint32 &nKeySlot);
+		
+		/**
+		*  @brief
+		*    Maps a control to its action and adds it to the map of the actions
+		*
+		*  @remarks
+		*    A key gets the next free slot of the key states, the slot is kept in the bits above CONTROLACTIONBITS of the
+		*    mapped value so that one lookup gives both. A key that finds no free slot is not processed.
+		*
+		*  @param[in] PLInput::Control & cControl
+		*
+		*  @return
+		*    the mapped value, the action and the slot
+		*/
+		PLCore::uint32 AddControlAction(PLInput::Control &cControl);
+		
+		/**
+		*  @brief
+		*    Maps a control to its action by its name
+		*
+		*  @param[in] PLInput::Control & cControl
+		*
+		*  @return
+		*    the action, see EControlAction
+		*/
+		PLCore::uint32 MapControlAction(PLInput::Control &cControl) const;
 		
 		/**
 		*  @brief
@@ -518,28 +962,31 @@ class Gui : public PLCore::Object {
 		/**
 		*  @brief
 		*    Handles all keyboard related processes on update
+		*
+		*  @remarks
+		*    Sends the repeats of the held key that are due, see SetKeyRepeat().
 		*/
 		void KeyboardHandler();
 		
 		/**
 		*  @brief
-		*    Adds a text key to the keyboard handler
+		*    Sends a held key to the focused window
 		*
-		*  @param[in] const PLCore::String & sName
-		*  @param[in] const PLCore::String & sKey
-		*  @param[in] sButton * psButton
-		*/
-		void AddTextKey(const PLCore::String &sName, const PLCore::String &sKey, sButton *psButton);
-		
-		/**
-		*  @brief
-		*    Adds a key to the keyboard handler
+		*  @param[in] const sKeyState & sState
 		*
-		*  @param[in] const PLCore::String & sName
-		*  @param[in] const char & nKey
-		*  @param[in] sButton * psButton
+		*  @return
+		*    'true' if the key was send, else 'false' (no focused window that takes keys)
 		*/
-		void AddKey(const PLCore::String &sName, const char &nKey, sButton *psButton);
+		bool SendKeyState(const sKeyState &sState);
+		
+		/**
+		*  @brief
+		*    Releases all held keys, they do not repeat anymore
+		*
+		*  @note
+		*    This is called when the focus changes, the keys were held for the window that had the focus.
+		*/
+		void ResetKeyStates();
 		
 		/**
 		*  @brief
@@ -553,10 +1000,60 @@ class Gui : public PLCore::Object {
 		*    This method is somewhat experimental and is subject to change
 		*/
 		void ResizeWindowHandler();
+		
+		/**
+		*  @brief
+		*    Handles the automatic freezing of idle windows
+		*
+		*  @remarks
+		*    The focused, dragging and resizing windows are never frozen automatically.
+		*
+		*  @see
+		*    - SRPWindow::SetAutoFreeze()
+		*/
+		void AutoFreezeHandler();
+		
+		/**
+		*  @brief
+		*    Handles the unresponsive policy of the windows
+		*
+		*  @see
+		*    - SRPWindow::SetUnresponsivePolicy()
+		*/
+		void WatchdogHandler();
+		
+		/**
+		*  @brief
+		*    Destroys the pooled textures that have not been used for a while
+		*
+		*  @see
+		*    - TexturePool::SetTrimTime()
+		*/
+		void TexturePoolHandler();
+		
+		/**
+		*  @brief
+		*    Updates the quads of the windows in the texture atlas and starts a new frame for its batches
+		*
+		*  @see
+		*    - TextureAtlas::SetBatching()
+		*/
+		void TextureAtlasHandler();
+		
+		/**
+		*  @brief
+		*    Destroys the previous builds of the bootstrap script once the berkelium thread can no longer read them
+		*
+		*  @remarks
+		*    Only the current build is used by the windows, a previous one is only read by the commands that create
+		*    berkelium windows and that were pushed before the build was replaced.
+		*/
+		void BootstrapScriptHandler();
 
 		bool m_bBerkeliumInitialized;
 		bool m_bRenderersInitialized;
 		PLCore::HashMap<PLCore::String, SRPWindow*> *m_pmapWindows;
+		SRPWindow *m_pDummyWindow;
 		PLScene::SceneRenderer *m_pCurrentSceneRenderer;
 		PLRenderer::Renderer *m_pCurrentRenderer;
 		SRPMousePointer *m_pSRPMousePointer;
@@ -564,6 +1061,7 @@ class Gui : public PLCore::Object {
 		bool m_bControlsEnabled;
 		bool m_bIsUpdateConnected;
 		bool m_bIsControllerConnected;
+		PLCore::HashMap<PLInput::Control*, PLCore::uint32> *m_pmapControlActions;		/**< Action of a control and for keys the slot of its state, see AddControlAction() */
 		PLCore::String m_sLastControl;
 		PLCore::uint64 m_nLastMouseLeftReleaseTime;
 		SRPWindow *m_pLastMouseWindow;
@@ -571,14 +1069,38 @@ class Gui : public PLCore::Object {
 		PLMath::Vector2i m_vLastKnownMousePos;
 		SRPWindow *m_pDragWindow;
 		SRPWindow *m_pResizeWindow;
+		PLCore::List<sDefaultCallBackEvent*> *m_plstDefaultCallBackEvents;
+		PLCore::List<SRPWindow*> *m_plstResizePreviewWindows;
 		bool m_bMouseMoved;
 		PLMath::Vector2i m_vLockMousePos;
-		PLCore::HashMap<PLCore::String, sButton*> *m_pmapTextButtonHandler;
-		PLCore::HashMap<PLCore::String, sButton*> *m_pmapKeyButtonHandler;
-		PLCore::uint64 m_nLastTextKeySendTime;
-		PLCore::uint64 m_nLastKeySendTime;
-		int m_nTextKeyHitCount;
-		int m_nKeyHitCount;
+		sKeyState m_sKeyStates[MAXKEYSTATES];
+		PLCore::uint32 m_nNumOfKeyStates;
+		sKeyState *m_psRepeatKeyState;
+		PLCore::uint32 m_nKeyRepeatDelay;
+		PLCore::uint32 m_nKeyRepeatRate;
+		PLCore::uint32 m_nPumpMode;
+		PLCore::uint32 m_nPumpBudget;
+		PLCore::uint32 m_nPumpMaxCount;
+		PLCore::uint64 m_nPumpTime;
+		PLCore::uint32 m_nPumpCount;
+		PLCore::uint64 m_nLastPumpTime;
+		PLCore::uint32 m_nLastPumpCount;
+		PLCore::uint64 m_nLastIdlePumpTime;
+		bool m_bInputPending;
+		PLCore::Array<PLCore::String> m_lstBootstrapScriptNames;
+		PLCore::Array<PLCore::String> m_lstBootstrapScriptSources;
+		PLCore::Array<sBootstrapScript*> m_lstBootstrapScripts;
+		PLCore::uint32 m_nBootstrapBuildCount;
+		PLCore::Array<SRPWindow*> m_lstHitTestWindows;
+		PLCore::uint32 m_nHitTestZOrderRevision;
+		bool m_bHitTestDirty;
+		PLCore::Array<sInputEvent*> m_lstInputEvents;
+		PLCore::Array<sInputEvent*> m_lstFreeInputEvents;
+		PLCore::uint32 m_nCoalescedInputCount;
+		BerkeliumThread *m_pBerkeliumThread;
+		TexturePool *m_pTexturePool;
+		TextureAtlas *m_pTextureAtlas;
+		bool m_bTextureAtlasEnabled;
 
 
 };
@@ -0,0 +1,143 @@
+#ifndef __PLBERKELIUM_SPSCQUEUE_H__
+#define __PLBERKELIUM_SPSCQUEUE_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/PLCore.h>
+#include <PLCore/PLCoreWindowsIncludes.h>
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Unbounded single producer, single consumer queue
+*
+*  @remarks
+*    Exactly one thread may call Push() and exactly one (other) thread may call Pop() and IsEmpty().
+*    The queue always holds a dummy node, the producer only touches the tail and the consumer only touches the head,
+*    so the two threads never write to the same node.
+*    The only link both threads access is the one to the next node. It is published and read with interlocked operations,
+*    which are full memory barriers, so the value of a node is visible to the consumer once it sees the node.
+*    Neither thread ever waits for the other one.
+*/
+template <class ValueType>
+class SPSCQueue {
+
+
+	public:
+		SPSCQueue() :
+			m_pHead(new sNode),
+			m_pTail(m_pHead)
+		{
+			m_pHead->pNext = nullptr;
+		}
+
+		~SPSCQueue()
+		{
+			// cleanup all nodes, including the dummy node
+			while (m_pHead)
+			{
+				sNode *pNext = m_pHead->pNext;
+				delete m_pHead;
+				m_pHead = pNext;
+			}
+		}
+
+		/**
+		*  @brief
+		*    Adds a value to the end of the queue (producer thread only)
+		*
+		*  @param[in] const ValueType & cValue
+		*/
+		void Push(const ValueType &cValue)
+		{
+			sNode *pNode = new sNode;
+			pNode->cValue = cValue;
+			pNode->pNext = nullptr;
+			// the value is written before the node is published, the exchange keeps it that way
+			InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pTail->pNext), pNode);
+			m_pTail = pNode;
+		}
+
+		/**
+		*  @brief
+		*    Removes the value at the front of the queue (consumer thread only)
+		*
+		*  @param[out] ValueType & cValue
+		*
+		*  @return
+		*    'true' if a value was removed, else 'false' (queue is empty)
+		*/
+		bool Pop(ValueType &cValue)
+		{
+			sNode *pNext = GetNext(m_pHead);
+			if (pNext)
+			{
+				// the next node becomes the new dummy node
+				cValue = pNext->cValue;
+				delete m_pHead;
+				m_pHead = pNext;
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		*  @brief
+		*    Returns whether or not the queue is empty (consumer thread only)
+		*
+		*  @return
+		*    'true' if the queue is empty, else 'false'
+		*/
+		bool IsEmpty() const
+		{
+			return (GetNext(m_pHead) == nullptr);
+		}
+
+	private:
+		struct sNode
+		{
+			ValueType cValue;
+			sNode * volatile pNext;
+		};
+
+		SPSCQueue(const SPSCQueue &cSource);
+		SPSCQueue &operator =(const SPSCQueue &cSource);
+
+		/**
+		*  @brief
+		*    Reads the link to the next node the producer may be publishing right now
+		*
+		*  @param[in] sNode * pNode
+		*
+		*  @return
+		*    the next node, a null pointer if there is none yet
+		*/
+		static sNode *GetNext(sNode *pNode)
+		{
+			// comparing with a null pointer never changes the link, the operation is only used for its barrier
+			return static_cast<sNode*>(InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&pNode->pNext), nullptr, nullptr));
+		}
+
+		sNode *m_pHead;		/**< Consumer side, always points to the dummy node */
+		sNode *m_pTail;		/**< Producer side, points to the last node */
+
+
+};
+
+
+};
+
+
+#endif // __PLBERKELIUM_SPSCQUEUE_H__
@@ -11,9 +11,15 @@
 #include <PLCore/System/System.h>
 #include <PLCore/System/Console.h>
 #include <PLCore/Core/MemoryManager.h>
+#include <PLCore/Container/List.h>
+#include <PLCore/Container/Array.h>
+#include <PLCore/System/Mutex.h>
+#include <PLCore/Base/Object.h>
+#include <PLCore/Base/Event/EventHandler.h>
 #include <PLCore/Application/CoreApplication.h>
 #include <PLCore/Frontend/FrontendApplication.h>
 #include <PLCore/Base/Func/FuncGenMemPtr.h>
+#include <PLCore/Tools/Timing.h>
 #include <PLScene/Compositing/SceneRendererPass.h>
 #include <PLScene/Compositing/SceneRenderer.h>
 #include <PLRenderer/Renderer/Renderer.h>
@@ -26,6 +32,7 @@
 #include <PLRenderer/Renderer/FragmentShader.h>
 #include <PLGraphics/Image/Image.h>
 #include <PLGraphics/Image/ImageBuffer.h>
+#include <PLMath/Math.h>
 #include <PLMath/Vector2.h>
 #include <PLMath/Vector2i.h>
 #include <PLMath/Rectangle.h>
@@ -39,6 +46,11 @@
 #include "berkelium/ScriptUtil.hpp"
 
 #include "PLBerkelium.h"
+#include "SPSCQueue.h"
+#include "BerkeliumThread.h"
+#include "ScriptParams.h"
+#include "TexturePool.h"
+#include "TextureAtlas.h"
 
 
 //[-------------------------------------------------------]
@@ -64,6 +76,14 @@ namespace PLBerkelium {
 #define HIDEWINDOW "HideWindow"
 #define CLOSEWINDOW "CloseWindow"
 #define RESIZEWINDOW "ResizeWindow"
+#define NATIVEPOST "NativePost"
+#define NATIVECALL "NativeCall"
+#define NUMOFDEFAULTCALLBACKS 4
+#define UNRESPONSIVEHISTOGRAMSIZE 6
+#define LATENCYHISTOGRAMSIZE 128
+#define COVERAGECELLSIZE 4
+#define TEXTUREGROWTHDIVISOR 4
+#define TEXTURESHRINKDIVISOR 2
 
 
 //[-------------------------------------------------------]
@@ -85,14 +105,140 @@ struct sWindowsData
 };
 
 
+struct sCoalescedCallBack;
+class SRPWindow;
+
+
 struct sCallBack
 {
 	Berkelium::Window *pWindow;						/**< Shared, points to SRPWindow::m_pProgramWrapper, do not free the memory */
-	void *pReplyMsg;								/**< Free the resource if you no longer need it */
+	void *pReplyMsg;								/**< Always a null pointer, the default callbacks have no return and javascript has been answered already */
 	Berkelium::URLString OriginUrl;
 	PLCore::String sFunctionName;
+	PLCore::uint32 nId;								/**< See SRPWindow::ECallBackId */
 	size_t nNumberOfParameters;
-	Berkelium::Script::Variant *pParameters;		/**< Free the resource if you no longer need it */
+	Berkelium::Script::Variant *pParameters;		/**< Shared, owned by berkelium and only valid while the callback is processed, do not free the memory */
+};
+
+
+struct sDefaultCallBackEvent
+{
+	SRPWindow *pSRPWindow;							/**< Shared, the window javascript called the default callback of, do not free the memory */
+	PLCore::uint32 nId;								/**< See SRPWindow::ECallBackId */
+};
+
+
+struct sCallBackFunction
+{
+	PLCore::DynFuncPtr pDynFunc;
+	PLCore::String sJSFunctionName;
+	bool bHasReturn;
+	bool bTyped;									/**< The function is called with typed parameters, see ScriptParams */
+	PLCore::uint32 nCoalescePolicy;					/**< See SRPWindow::ECoalescePolicy */
+	PLCore::uint32 nId;								/**< Interned id the function is bound by, index into the dispatch table of SRPWindow */
+	sCoalescedCallBack *psCoalescedCallBack;		/**< Shared, the pending call when coalescing by CoalesceLastValue, do not free the memory */
+};
+
+
+struct sSettledCallBack
+{
+	PLCore::uint32 nCallId;
+	bool bResolved;
+	PLCore::String sValue;
+};
+
+
+struct sStateValue
+{
+	PLCore::String sLiteral;						/**< Javascript literal of the value */
+	bool bDirty;									/**< The value has changed since it was last send */
+};
+
+
+struct sStateObject
+{
+	PLCore::Object *pObject;						/**< Bound object, null pointer once it has been destroyed, shared, do not free the memory */
+	PLCore::EventHandler<> cEventHandlerDestroyed;	/**< Connected to the SignalDestroyed of the object */
+
+	sStateObject(PLCore::Object &cObject) :
+		pObject(&cObject),
+		cEventHandlerDestroyed(&sStateObject::OnDestroyed, this)
+	{
+		cObject.SignalDestroyed.Connect(cEventHandlerDestroyed);
+	}
+
+	void OnDestroyed()
+	{
+		// the object unbinds itself, the binding is removed by SRPWindow::SyncState()
+		pObject = nullptr;
+	}
+};
+
+
+struct sBootstrapScript
+{
+	PLCore::String sScript;
+	wchar_t *pszScript;								/**< Unicode copy of the script for the berkelium thread that never changes, free the resource if you no longer need it */
+	PLCore::uint32 nLength;
+	PLCore::uint32 nCommandMark;					/**< Amount of pushed commands when the build was replaced, see BerkeliumThread::IsExecuted() */
+};
+
+
+struct sCoalescedCallBack
+{
+	sCallBackFunction *psCallBackFunction;			/**< Shared, points to a value of SRPWindow::m_pmapCallBackFunctions, do not free the memory */
+	PLCore::String sKey;
+	size_t nNumArgs;
+	Berkelium::Script::Variant *pArgs;				/**< Owned, copy of the arguments of the last call */
+};
+
+
+struct sBrowserEvent
+{
+	enum EType
+	{
+		EventPaint,
+		EventWidgetCreated,
+		EventWidgetDestroyed,
+		EventWidgetMove,
+		EventWidgetResize,
+		EventWidgetPaint,
+		EventJavascriptCallback,
+		EventLoad,
+		EventLoadingStateChanged,
+		EventAddressBarChanged,
+		EventCrashed,
+		EventUnresponsive,
+		EventResponsive,
+		EventTooltipChanged,
+		EventCreated,
+		EventConsole
+	};
+
+	PLCore::uint32 nType;
+	PLCore::uint64 nTime;							/**< Time in microseconds berkelium has fired the event */
+	PLCore::uint32 nExecutedCommands;				/**< Amount of commands the berkelium thread had executed when it fired the event */
+	Berkelium::Window *pWindow;						/**< Shared, owned by berkelium, do not free the memory */
+	Berkelium::Widget *pWidget;						/**< Shared, only used as key, do not free the memory */
+	int nParam[2];									/**< dx and dy for paints, position, size or z-index for widgets, loading state, create time */
+	PLCore::uint8 *pBuffer;							/**< Free the resource if you no longer need it */
+	Berkelium::Rect sourceBufferRect;
+	Berkelium::Rect scrollRect;
+	size_t nNumCopyRects;
+	Berkelium::Rect *pCopyRects;					/**< Free the resource if you no longer need it */
+	PLCore::String sText;
+	PLCore::String sUrl;
+	size_t nNumArgs;
+	Berkelium::Script::Variant *pArgs;				/**< Free the resource if you no longer need it */
+	void *pReplyMsg;								/**< Shared, the reply identifier javascript waits for, see SRPWindow::SendScriptReturn(), do not free the memory */
+};
+
+
+struct sLatencyHistogram
+{
+	PLCore::uint32 nBuckets[LATENCYHISTOGRAMSIZE];	/**< Amount of latencies per millisecond, the last bucket holds the longer ones */
+	PLCore::uint32 nCount;
+	PLCore::uint64 nMaxTime;						/**< Longest latency in microseconds */
 };
 
 
@@ -104,6 +250,9 @@ struct sWidget
 	PLGraphics::Image cImage;
 	int nWidth;
 	int nHeight;
+	int nTextureWidth;								/**< Capacity of the image and texture buffer, at least the size of the widget */
+	int nTextureHeight;
+	sAtlasRect *psAtlasRect;						/**< Rect in the texture atlas, a null pointer when the widget has its own texture buffer */
 	int nXPos;
 	int nYPos;
 	bool bNeedsFullUpdate;
@@ -116,6 +265,11 @@ struct sWidget
 class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDelegate {
 
 
+	//[-------------------------------------------------------]
+	//[ Friends                                               ]
+	//[-------------------------------------------------------]
+	friend class BerkeliumThread;
+
 	//[-------------------------------------------------------]
 	//[ RTTI interface                                        ]
 	//[-------------------------------------------------------]
@@ -124,291 +278,1489 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 	pl_class_end
 
 
+	//[-------------------------------------------------------]
+	//[ Public definitions                                    ]
+	//[-------------------------------------------------------]
+	public:
+		/**
+		*  @brief
+		*    Unresponsive policy flags, see SetUnresponsivePolicy()
+		*/
+		enum EUnresponsivePolicy
+		{
+			UnresponsiveNone		= 0,	/**< Only keep track of the unresponsive time (default) */
+			UnresponsiveBlockInput	= 1,	/**< Stop sending input to the window while it is unresponsive */
+			UnresponsiveOverlay		= 2,	/**< Draw the last frame grayed out while the window is unresponsive */
+			UnresponsiveReload		= 4,	/**< Reload the page once the unresponsive timeout has passed */
+			UnresponsiveRecreate	= 8		/**< Recreate the berkelium window and its process once the unresponsive timeout has passed, after a reload when that is set as well */
+		};
+
+		/**
+		*  @brief
+		*    Coalescing policy of a callback function, see AddCallBackFunction()
+		*/
+		enum ECoalescePolicy
+		{
+			CoalesceNone			= 0,	/**< Every call is dispatched right away (default) */
+			CoalesceLastValue		= 1,	/**< Only the last call until the next update is dispatched */
+			CoalesceFirstArgument	= 2		/**< Only the last call per value of the first argument until the next update is dispatched */
+		};
+
+		/**
+		*  @brief
+		*    Interned ids of the javascript functions, berkelium reports calls by the id the function is bound with
+		*/
+		enum ECallBackId
+		{
+			CallBackDragWindow		= 0,	/**< DRAGWINDOW, processed by Gui */
+			CallBackHideWindow		= 1,	/**< HIDEWINDOW, processed by Gui */
+			CallBackCloseWindow		= 2,	/**< CLOSEWINDOW, processed by Gui */
+			CallBackResizeWindow	= 3,	/**< RESIZEWINDOW, processed by Gui */
+			CallBackNativePost		= 4,	/**< NATIVEPOST */
+			CallBackNativeCall		= 5,	/**< NATIVECALL */
+			CallBackFunctions		= 6		/**< Id of the first function added with AddCallBackFunction(), the others follow */
+		};
+
+		/**
+		*  @brief
+		*    Input latencies that are measured, see GetInputLatency()
+		*/
+		enum EInputLatency
+		{
+			LatencyPaint	= 0,	/**< From the input until berkelium has painted the window */
+			LatencyDraw		= 1		/**< From the input until the painted window has been drawn */
+		};
+
+
 	public:
 		PLBERKELIUM_API SRPWindow(const PLCore::String &sName);
 		PLBERKELIUM_API virtual ~SRPWindow();
 		
 		/**
 		*  @brief
-		*    Initializes window and creates needed components
+		*    Initializes window and creates needed components
+		*
+		*  @param[in] PLRenderer::Renderer * pRenderer
+		*  @param[in] const PLMath::Vector2 & vPosition
+		*  @param[in] const PLMath::Vector2 & vImageSize
+		*
+		*  @return
+		*    'true' if window initialization is successful, else 'false'
+		*/
+		PLBERKELIUM_API bool Initialize(PLRenderer::Renderer *pRenderer, const PLMath::Vector2 &vPosition, const PLMath::Vector2 &vImageSize);
+		
+		/**
+		*  @brief
+		*    Destroys this window instance
+		*
+		*  @remarks
+		*    This will also destroy all data and components created by this window.
+		*/
+		PLBERKELIUM_API void DestroyInstance() const;
+		
+		/**
+		*  @brief
+		*    Returns the berkelium window instance
+		*
+		*  @remarks
+		*    You can use this to call berkelium specific methods.
+		*    Hidden windows create their berkelium window the first time they are shown or navigated,
+		*    a window that has not created it yet creates it now.
+		*
+		*  @return
+		*    pointer to berkelium window (do not destroy the returned instance!), a null pointer for the dummy window
+		*    or when the berkelium window could not be created
+		*
+		*  @note
+		*    When berkelium runs on its own thread the berkelium window may only be used from that thread.
+		*    The thread publishes the window once it has created it, until this window has processed that on update
+		*    this returns a null pointer.
+		*/
+		PLBERKELIUM_API Berkelium::Window *GetBerkeliumWindow();
+		
+		/**
+		*  @brief
+		*    Returns whether or not the berkelium window has been created
+		*
+		*  @remarks
+		*    When berkelium runs on its own thread the creation is requested here and done on that thread shortly after.
+		*
+		*  @return
+		*    'true' if the berkelium window is created, else 'false'
+		*/
+		PLBERKELIUM_API bool IsBerkeliumWindowCreated() const;
+		
+		/**
+		*  @brief
+		*    Sets the thread berkelium runs on
+		*
+		*  @remarks
+		*    All calls into berkelium are then send to this thread and all paints and events come back through the queues of this window.
+		*    This needs to be set before the window is initialized, Gui does this when it runs berkelium on its own thread.
+		*
+		*  @param[in] BerkeliumThread * pBerkeliumThread
+		*    berkelium thread, a null pointer to call berkelium directly (default)
+		*/
+		PLBERKELIUM_API void SetBerkeliumThread(BerkeliumThread *pBerkeliumThread);
+		
+		/**
+		*  @brief
+		*    Sets the pool the textures and vertex buffers of this window, its widgets and its tool tip come from
+		*
+		*  @remarks
+		*    This needs to be set before the window is initialized and the pool has to outlive the window, Gui does this for all its windows.
+		*
+		*  @param[in] TexturePool * pTexturePool
+		*    texture pool, a null pointer to create and destroy them directly (default)
+		*/
+		PLBERKELIUM_API void SetTexturePool(TexturePool *pTexturePool);
+		
+		/**
+		*  @brief
+		*    Sets the atlas small windows and widgets are drawn from
+		*
+		*  @remarks
+		*    A window or widget that is at most TEXTUREATLASMAXSIZE in both directions gets a rect in the atlas instead of its own texture,
+		*    it moves in and out of the atlas when it is resized. This needs to be set before the window is initialized and the atlas
+		*    has to outlive the window, Gui does this for all its windows.
+		*
+		*  @param[in] TextureAtlas * pTextureAtlas
+		*    texture atlas, a null pointer to give every window and widget its own texture (default)
+		*/
+		PLBERKELIUM_API void SetTextureAtlas(TextureAtlas *pTextureAtlas);
+		
+		/**
+		*  @brief
+		*    Returns if the window is drawn from the texture atlas
+		*
+		*  @return
+		*    'true' if the window has a rect in the atlas, else 'false'
+		*/
+		PLBERKELIUM_API bool IsInTextureAtlas() const;
+		
+		/**
+		*  @brief
+		*    Updates the quad the window is drawn on when the atlas batches it
+		*
+		*  @note
+		*    This is called by Gui on update, a window that is not updated is drawn on its own.
+		*
+		*  @see
+		*    - TextureAtlas::SetBatching()
+		*/
+		PLBERKELIUM_API void UpdateAtlasQuad();
+		
+		/**
+		*  @brief
+		*    Sets the queue the default callbacks are reported to
+		*
+		*  @remarks
+		*    Every call of a default callback adds an event to this queue, so that Gui only needs to look at the windows
+		*    javascript has called a default callback of. The callback itself can still be retrieved with GetDefaultCallBack().
+		*
+		*  @param[in] PLCore::List<sDefaultCallBackEvent * > * plstDefaultCallBackEvents
+		*    queue owned by the caller, a null pointer to not report the default callbacks (default)
+		*/
+		PLBERKELIUM_API void SetDefaultCallBackQueue(PLCore::List<sDefaultCallBackEvent*> *plstDefaultCallBackEvents);
+		
+		/**
+		*  @brief
+		*    Sets the list a window is added to when its resize preview starts
+		*
+		*  @remarks
+		*    Gui only updates the resize previews of the windows in this list instead of looking at all windows on every update.
+		*
+		*  @param[in] PLCore::List<SRPWindow * > * plstResizePreviewWindows
+		*    list owned by the caller, a null pointer to not report the resize previews (default)
+		*/
+		PLBERKELIUM_API void SetResizePreviewQueue(PLCore::List<SRPWindow*> *plstResizePreviewWindows);
+		
+		/**
+		*  @brief
+		*    Sets the script every page of this window is bootstrapped with
+		*
+		*  @remarks
+		*    The script is evaluated in one step when a page starts loading, it has to set up native.post() and the like.
+		*    Gui shares one pre-built script with all its windows, the script is applied when the berkelium window is created.
+		*    The berkelium thread only reads the unicode copy of the script, which is handed over with the command that creates the berkelium window.
+		*
+		*  @param[in] const sBootstrapScript * psBootstrapScript
+		*    script owned by the caller that must not change anymore, a null pointer for the built-in script (default)
+		*/
+		PLBERKELIUM_API void SetBootstrapScript(const sBootstrapScript *psBootstrapScript);
+		
+		/**
+		*  @brief
+		*    Returns the number of scripts that are evaluated when a page of this window starts loading
+		*
+		*  @return
+		*    number of scripts, the bootstrap script and the binding manifest of the callback functions
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetNumOfStartLoadingScripts() const;
+		
+		/**
+		*  @brief
+		*    Applies a helper library that was added to the bootstrap script after the berkelium window has been created
+		*
+		*  @remarks
+		*    The library is executed in the open page and evaluated when a page of this window starts loading.
+		*    A window that has not created its berkelium window yet gets the library with the bootstrap script instead.
+		*
+		*  @param[in] const PLCore::String & sJavascript
+		*/
+		PLBERKELIUM_API void ApplyBootstrapLibrary(const PLCore::String &sJavascript);
+		
+		/**
+		*  @brief
+		*    Returns the time it took to create the berkelium window and apply the bootstrap script
+		*
+		*  @remarks
+		*    This is the time spent in Berkelium::Window::create() and the bindings only, see GetFirstPaintLatency()
+		*    and GetFirstCallBackLatency() for what the user notices.
+		*
+		*  @return
+		*    time in microseconds, 0 if no berkelium window was created yet
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetCreateTime() const;
+		
+		/**
+		*  @brief
+		*    Returns the time from the request to create the berkelium window until its first paint reached this window
+		*
+		*  @return
+		*    time in microseconds, 0 if there was no paint since the berkelium window was requested
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetFirstPaintLatency() const;
+		
+		/**
+		*  @brief
+		*    Returns the time from the request to create the berkelium window until the page first called back
+		*
+		*  @remarks
+		*    This is the first interaction of the page, it includes navigating, loading and running the bootstrap script.
+		*
+		*  @return
+		*    time in microseconds, 0 if there was no callback since the berkelium window was requested
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetFirstCallBackLatency() const;
+		
+		/**
+		*  @brief
+		*    Processes the events the berkelium thread has send to this window
+		*
+		*  @remarks
+		*    These are javascript callbacks and page state changes, paints are processed when drawing.
+		*
+		*  @note
+		*    This is called by Gui on update and does nothing when berkelium is not running on its own thread.
+		*/
+		PLBERKELIUM_API void ProcessBrowserEvents();
+		
+		/**
+		*  @brief
+		*    Sends a mouse move to the berkelium window
+		*
+		*  @param[in] const int & nX
+		*  @param[in] const int & nY
+		*/
+		PLBERKELIUM_API void SendMouseMove(const int &nX, const int &nY) const;
+		
+		/**
+		*  @brief
+		*    Sends a mouse button to the berkelium window
+		*
+		*  @param[in] const PLCore::uint32 & nButton
+		*  @param[in] const bool & bDown
+		*  @param[in] const int & nClickCount
+		*/
+		PLBERKELIUM_API void SendMouseButton(const PLCore::uint32 &nButton, const bool &bDown, const int &nClickCount = 1) const;
+		
+		/**
+		*  @brief
+		*    Sends a mouse wheel scroll to the berkelium window
+		*
+		*  @param[in] const int & nX
+		*  @param[in] const int & nY
+		*/
+		PLBERKELIUM_API void SendMouseWheel(const int &nX, const int &nY) const;
+		
+		/**
+		*  @brief
+		*    Sends text input to the berkelium window
+		*
+		*  @param[in] const PLCore::String & sText
+		*/
+		PLBERKELIUM_API void SendText(const PLCore::String &sText) const;
+		
+		/**
+		*  @brief
+		*    Sends a key to the berkelium window
+		*
+		*  @param[in] const bool & bPressed
+		*  @param[in] const int & nModifiers
+		*  @param[in] const int & nVirtualKey
+		*  @param[in] const int & nScanCode
+		*/
+		PLBERKELIUM_API void SendKey(const bool &bPressed, const int &nModifiers, const int &nVirtualKey, const int &nScanCode) const;
+		
+		/**
+		*  @brief
+		*    Sends focus to the berkelium window
+		*/
+		PLBERKELIUM_API void SendFocus() const;
+		
+		/**
+		*  @brief
+		*    Removes the focus from the berkelium window
+		*/
+		PLBERKELIUM_API void SendUnfocus() const;
+		
+		/**
+		*  @brief
+		*    Creates and sets the berkelium window instance
+		*
+		*  @remarks
+		*    The berkelium window is created on demand, the first time the window is shown or navigated.
+		*    This also creates the berkelium context, applies the window settings and binds the javascript callback functions.
+		*    If the berkelium window is already set or the window is not initialized this will not do anything.
+		*
+		*  @return
+		*    void
+		*/
+		PLBERKELIUM_API void CreateBerkeliumWindow();
+		
+		/**
+		*  @brief
+		*    Navigates this window to the given url
+		*
+		*  @remarks
+		*    If the berkelium window has not been created yet it will be created now.
+		*
+		*  @param[in] const PLCore::String & sUrl
+		*/
+		PLBERKELIUM_API void NavigateTo(const PLCore::String &sUrl);
+		
+		/**
+		*  @brief
+		*    Returns the data of the window
+		*
+		*  @remarks
+		*    You can use this to get and set window data.
+		*
+		*  @return
+		*    pointer to window data (do not destroy the returned instance!)
+		*/
+		PLBERKELIUM_API sWindowsData *GetData() const;
+		
+		/**
+		*  @brief
+		*    Adds the SceneRenderPass for this window to the SceneRenderer
+		*
+		*  @param[in] PLScene::SceneRenderer * pSceneRenderer
+		*
+		*  @return
+		*    'true' if the SceneRenderPass was added, else 'false'
+		*/
+		PLBERKELIUM_API bool AddSceneRenderPass(PLScene::SceneRenderer *pSceneRenderer);
+		
+		/**
+		*  @brief
+		*    Removes the SceneRenderPass for this window from the SceneRenderer
+		*
+		*  @return
+		*    'true' if the SceneRenderPass was removed, else 'false'
+		*/
+		PLBERKELIUM_API bool RemoveSceneRenderPass();
+		
+		/**
+		*  @brief
+		*    Moves this window to front
+		*/
+		PLBERKELIUM_API void MoveToFront();
+		
+		/**
+		*  @brief
+		*    Returns the name of this window
+		*
+		*  @return
+		*    window name
+		*/
+		PLBERKELIUM_API PLCore::String GetName() const;
+		
+		/**
+		*  @brief
+		*    Destroys the berkelium window instance
+		*
+		*  @remarks
+		*    If the berkelium window has not been set this will not do anything.
+		*/
+		PLBERKELIUM_API void DestroyBerkeliumWindow();
+		
+		/**
+		*  @brief
+		*    Returns the position of this window
+		*
+		*  @return
+		*    window position
+		*/
+		PLBERKELIUM_API PLMath::Vector2i GetPosition() const;
+		
+		/**
+		*  @brief
+		*    Returns the size of this window
+		*
+		*  @return
+		*    window size
+		*/
+		PLBERKELIUM_API PLMath::Vector2i GetSize() const;
+		
+		/**
+		*  @brief
+		*    Returns the mouse positions relative to this window
+		*
+		*  @param[in] const PLMath::Vector2i & vMousePos
+		*
+		*  @return
+		*    mouse position relative to window
+		*/
+		PLBERKELIUM_API PLMath::Vector2i GetRelativeMousePosition(const PLMath::Vector2i &vMousePos) const;
+		
+		/**
+		*  @brief
+		*    Enables or disables alpha aware hit testing
+		*
+		*  @remarks
+		*    A transparent window normally takes every click within its rectangle. With alpha hit testing, clicks
+		*    fall through where the page is (nearly) transparent, so one large HUD window does not block the view.
+		*    A coverage mask with one bit per COVERAGECELLSIZE x COVERAGECELLSIZE pixels is kept up to date from the painted
+		*    rectangles, a cell is covered if any of its pixels has an alpha of at least the threshold. The mask survives freezing.
+		*
+		*  @note
+		*    Only windows with bTransparent set are affected.
+		*
+		*  @param[in] const bool & bEnabled
+		*  @param[in] const PLCore::uint8 & nThreshold
+		*    lowest alpha that takes a click
+		*/
+		PLBERKELIUM_API void SetAlphaHitTest(const bool &bEnabled, const PLCore::uint8 &nThreshold = 16);
+		
+		/**
+		*  @brief
+		*    Returns whether or not alpha aware hit testing is enabled
+		*
+		*  @return
+		*    'true' if enabled, else 'false'
+		*/
+		PLBERKELIUM_API bool IsAlphaHitTestEnabled() const;
+		
+		/**
+		*  @brief
+		*    Returns whether or not a position within this window takes a click
+		*
+		*  @param[in] const PLMath::Vector2i & vRelativePos
+		*    position relative to this window, see GetRelativeMousePosition()
+		*
+		*  @return
+		*    'true' if the position is covered or alpha hit testing does not apply, else 'false'
+		*/
+		PLBERKELIUM_API bool IsHitAt(const PLMath::Vector2i &vRelativePos) const;
+		
+		/**
+		*  @brief
+		*    Returns the SceneRenderPass index for this window
+		*
+		*  @return
+		*    SceneRenderPass index
+		*/
+		PLBERKELIUM_API int GetSceneRenderPassIndex();
+		
+		/**
+		*  @brief
+		*    Returns the revision of the z-order of the windows
+		*
+		*  @remarks
+		*    The revision changes whenever a window is added to or removed from a scene renderer or moved to front,
+		*    so that the order of windows only needs to be looked up again when it might have changed.
+		*
+		*  @return
+		*    the revision
+		*/
+		PLBERKELIUM_API static PLCore::uint32 GetZOrderRevision();
+		
+		/**
+		*  @brief
+		*    Moves window to given position
+		*
+		*  @param[in] const int & nX
+		*  @param[in] const int & nY
+		*/
+		PLBERKELIUM_API void MoveWindow(const int &nX, const int &nY);
+		PLBERKELIUM_API void SetToolTip(const PLCore::String &sText);
+		PLBERKELIUM_API void SetToolTipEnabled(const bool &bEnabled);
+		
+		/**
+		*  @brief
+		*    Removes all javascript callbacks for this window
+		*
+		*  @remarks
+		*    This can be used to make sure default callbacks are not called parallel to one and other.
+		*/
+		PLBERKELIUM_API void RemoveCallBacks() const;
+		
+		/**
+		*  @brief
+		*    Returns the amount of javascript callbacks created by this window
+		*
+		*  @return
+		*    amount of callbacks
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetNumberOfCallBacks() const;
+		
+		/**
+		*  @brief
+		*    Returns a javascript callback by key identifier
+		*
+		*  @param[in] const PLCore::String & sKey
+		*
+		*  @return
+		*    pointer to callback (do not destroy the returned instance!)
+		*/
+		PLBERKELIUM_API sCallBack *GetCallBack(const PLCore::String &sKey) const;
+		
+		/**
+		*  @brief
+		*    Returns a default javascript callback by id
+		*
+		*  @param[in] const PLCore::uint32 & nId
+		*    CallBackDragWindow, CallBackHideWindow, CallBackCloseWindow or CallBackResizeWindow
+		*
+		*  @return
+		*    pointer to callback, a null pointer if javascript did not call it (do not destroy the returned instance!)
+		*/
+		PLBERKELIUM_API sCallBack *GetDefaultCallBack(const PLCore::uint32 &nId) const;
+		
+		/**
+		*  @brief
+		*    Removes a javascript callback by key identifier
+		*
+		*  @param[in] const PLCore::String & sKey
+		*
+		*  @return
+		*    'true' if the javascript callback was removed, else 'false'
+		*/
+		PLBERKELIUM_API bool RemoveCallBack(const PLCore::String &sKey) const;
+		
+		/**
+		*  @brief
+		*    Removes a default javascript callback by id
+		*
+		*  @param[in] const PLCore::uint32 & nId
+		*    CallBackDragWindow, CallBackHideWindow, CallBackCloseWindow or CallBackResizeWindow
+		*
+		*  @return
+		*    'true' if the javascript callback was removed, else 'false'
+		*/
+		PLBERKELIUM_API bool RemoveDefaultCallBack(const PLCore::uint32 &nId) const;
+		
+		/**
+		*  @brief
+		*    Resizes window to given size
+		*
+		*  @note
+		*    Its not advisable to resize a window smaller than 4x4 pixels.
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*/
+		PLBERKELIUM_API void ResizeWindow(const int &nWidth, const int &nHeight);
+		
+		/**
+		*  @brief
+		*    Draws the current frame stretched to the given size and resizes the window later
+		*
+		*  @remarks
+		*    Every call of ResizeWindow() recreates the image and texture and has berkelium repaint the whole page. While the
+		*    size keeps changing, like when the user drags the border, the current frame is stretched to the new size instead.
+		*    The window is resized once the size has been stable for long enough or the preview has lasted for too long, see SetResizeDebounce().
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*/
+		PLBERKELIUM_API void PreviewResize(const int &nWidth, const int &nHeight);
+		
+		/**
+		*  @brief
+		*    Returns the size this window is drawn with
+		*
+		*  @return
+		*    size of the resize preview, the window size when there is no preview
+		*/
+		PLBERKELIUM_API PLMath::Vector2i GetPreviewSize() const;
+		
+		/**
+		*  @brief
+		*    Returns if the window is drawn with a resize preview
+		*
+		*  @return
+		*    'true' if a resize is pending, else 'false'
+		*/
+		PLBERKELIUM_API bool IsResizePreviewed() const;
+		
+		/**
+		*  @brief
+		*    Sets when a resize preview is applied
+		*
+		*  @param[in] const PLCore::uint64 & nStableTime
+		*    time in milliseconds the size has to stay the same (default 100), 0 resizes right away
+		*  @param[in] const PLCore::uint64 & nMaxPreviewTime
+		*    time in milliseconds after which a preview is applied even though the size keeps changing (default 250), 0 for no limit
+		*/
+		PLBERKELIUM_API void SetResizeDebounce(const PLCore::uint64 &nStableTime, const PLCore::uint64 &nMaxPreviewTime);
+		
+		/**
+		*  @brief
+		*    Resizes the window to the size of the resize preview right away
+		*/
+		PLBERKELIUM_API void ApplyResizePreview();
+		
+		/**
+		*  @brief
+		*    Applies the resize preview once it is due
+		*
+		*  @note
+		*    This is called by Gui on update for the windows that reported their preview, see SetResizeDebounce() and SetResizePreviewQueue().
+		*/
+		PLBERKELIUM_API void UpdateResizePreview();
+		
+		/**
+		*  @brief
+		*    Returns how often the window has been resized
+		*
+		*  @return
+		*    amount of resizes, each one recreated the image and texture
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetResizeCount() const;
+		
+		/**
+		*  @brief
+		*    Returns how often the size of the resize preview has changed
+		*
+		*  @return
+		*    amount of changes, compare with GetResizeCount() to see how many resizes have been saved
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetPreviewResizeCount() const;
+		
+		/**
+		*  @brief
+		*    Returns how often an image and texture of this window or its widgets has been allocated
+		*
+		*  @remarks
+		*    Images and textures are allocated with room to grow, a size change within that capacity only changes the part of the texture that is drawn.
+		*    They are reallocated when the size exceeds the capacity or drops below 1/TEXTURESHRINKDIVISOR of it.
+		*    A texture that is taken from the texture pool is not counted, see TexturePool::GetReusedTextureCount().
+		*
+		*  @return
+		*    amount of allocations, compare with GetResizeCount() to see how many have been saved
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetTextureAllocationCount() const;
+		
+		/**
+		*  @brief
+		*    Adds and sets a Javascript callback method for this window
+		*
+		*  @remarks
+		*    You can add c++ methods that javascript can callback to.
+		*    Javascript that calls a method very often should use native.post("MethodName", [arguments]) instead,
+		*    which sends all messages of one animation frame to c++ at once.
+		*    Javascript that needs the return without blocking the page should use native.call("MethodName", [arguments]),
+		*    which returns a promise, see DeferCallBack().
+		*    When only the last value matters (sliders, mouse tracking), set a coalescing policy so that the calls
+		*    are collected and only the last one is dispatched by DispatchCoalescedCallBacks().
+		*
+		*  @note
+		*    The method you want to callback to needs to be defined as a RTTI method.
+		*    If you do not define the second parameter (sJSFunctionName), the method name will be used instead.
+		*    Set the third parameter to true (bHasReturn) if you want to return anything but make sure the method returns a string, anything else is simply not supported.
+		*    Calls that javascript waits for a return of are never coalesced.
+		*    The order of the calls is kept, pending coalesced calls are dispatched before any call that is not coalesced.
+		*    When Gui runs berkelium on a thread of its own, the method is called on update and the return is send back to
+		*    javascript afterwards, the page waits for it until then.
+		*
+		*  @param[in] const PLCore::DynFuncPtr pDynFunc
+		*  @param[in] PLCore::String sJSFunctionName
+		*  @param[in] bool bHasReturn
+		*  @param[in] PLCore::uint32 nCoalescePolicy
+		*    see ECoalescePolicy
+		*
+		*  @return
+		*    'true' if the method was added, else 'false'
+		*/
+		PLBERKELIUM_API bool AddCallBackFunction(const PLCore::DynFuncPtr pDynFunc, PLCore::String sJSFunctionName = "",  bool bHasReturn = false, PLCore::uint32 nCoalescePolicy = CoalesceNone);
+		
+		/**
+		*  @brief
+		*    Dispatches the coalesced calls of callback functions
+		*
+		*  @note
+		*    This is called by Gui on update, see AddCallBackFunction().
+		*/
+		PLBERKELIUM_API void DispatchCoalescedCallBacks();
+		
+		/**
+		*  @brief
+		*    Returns how many calls of callback functions have been dropped in favor of a later call
+		*
+		*  @return
+		*    amount of dropped calls
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetCoalescedDroppedCount() const;
+		
+		/**
+		*  @brief
+		*    Returns how many coalesced calls of callback functions have been dispatched
+		*
+		*  @return
+		*    amount of dispatched calls
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetCoalescedDispatchedCount() const;
+		
+		/**
+		*  @brief
+		*    Defers the settling of the promise of the native.call() that is being dispatched
+		*
+		*  @remarks
+		*    Javascript can call a callback function with native.call("MethodName", [arguments]) which returns a promise
+		*    instead of blocking the page until the method returns. The promise is resolved with the return of the method,
+		*    unless the method calls this to settle the promise later on with ResolveCallBack() or RejectCallBack(),
+		*    for example when the work is done by a worker thread.
+		*
+		*  @note
+		*    Only valid from within a method that is called by native.call().
+		*
+		*  @return
+		*    correlation id of the call, 0 if no native.call() is being dispatched
+		*/
+		PLBERKELIUM_API PLCore::uint32 DeferCallBack();
+		
+		/**
+		*  @brief
+		*    Resolves the promise of a deferred native.call()
+		*
+		*  @note
+		*    This may be called from any thread, the promise is settled on the next update.
+		*
+		*  @param[in] const PLCore::uint32 & nCallId
+		*    correlation id returned by DeferCallBack()
+		*  @param[in] const PLCore::String & sResult
+		*/
+		PLBERKELIUM_API void ResolveCallBack(const PLCore::uint32 &nCallId, const PLCore::String &sResult);
+		
+		/**
+		*  @brief
+		*    Rejects the promise of a deferred native.call()
+		*
+		*  @note
+		*    This may be called from any thread, the promise is settled on the next update.
+		*
+		*  @param[in] const PLCore::uint32 & nCallId
+		*    correlation id returned by DeferCallBack()
+		*  @param[in] const PLCore::String & sError
+		*/
+		PLBERKELIUM_API void RejectCallBack(const PLCore::uint32 &nCallId, const PLCore::String &sError);
+		
+		/**
+		*  @brief
+		*    Sets a string in the state that is kept in sync with native.model of the page
+		*
+		*  @remarks
+		*    The state is a flat key/value store of dotted paths like "party.3.health", on the page native.model.party[3].health.
+		*    Only values that have changed are send to the page by SyncState(), a page can listen to them with native.onpatch(function(changes, model) {}).
+		*    A page that (re)loads gets the whole state.
+		*
+		*  @param[in] const PLCore::String & sPath
+		*  @param[in] const PLCore::String & sValue
+		*/
+		PLBERKELIUM_API void SetStateString(const PLCore::String &sPath, const PLCore::String &sValue);
+		
+		/**
+		*  @brief
+		*    Sets a number in the state that is kept in sync with native.model of the page
+		*
+		*  @remarks
+		*    NaN and the infinities are set as NaN, Infinity and -Infinity, unlike in JSON they are not null, which would remove the value.
+		*
+		*  @param[in] const PLCore::String & sPath
+		*  @param[in] const double & dValue
+		*
+		*  @see
+		*    - SetStateString()
+		*/
+		PLBERKELIUM_API void SetStateNumber(const PLCore::String &sPath, const double &dValue);
+		
+		/**
+		*  @brief
+		*    Sets a boolean in the state that is kept in sync with native.model of the page
+		*
+		*  @param[in] const PLCore::String & sPath
+		*  @param[in] const bool & bValue
+		*
+		*  @see
+		*    - SetStateString()
+		*/
+		PLBERKELIUM_API void SetStateBoolean(const PLCore::String &sPath, const bool &bValue);
+		
+		/**
+		*  @brief
+		*    Removes a value from the state that is kept in sync with native.model of the page
+		*
+		*  @param[in] const PLCore::String & sPath
+		*/
+		PLBERKELIUM_API void RemoveState(const PLCore::String &sPath);
+		
+		/**
+		*  @brief
+		*    Binds the attributes of a RTTI object to the state that is kept in sync with native.model of the page
+		*
+		*  @remarks
+		*    The attributes are compared on every SyncState() and set under sPath, like "player.Health".
+		*    Booleans and numeric attributes are set as booleans and numbers, any other attribute as string.
+		*    The object is unbound when it is destroyed.
+		*
+		*  @param[in] const PLCore::String & sPath
+		*  @param[in] PLCore::Object * pObject
+		*    object to bind
+		*/
+		PLBERKELIUM_API void BindStateObject(const PLCore::String &sPath, PLCore::Object *pObject);
+		
+		/**
+		*  @brief
+		*    Unbinds a RTTI object from the state, its values remain until they are removed
+		*
+		*  @param[in] const PLCore::String & sPath
+		*/
+		PLBERKELIUM_API void UnbindStateObject(const PLCore::String &sPath);
+		
+		/**
+		*  @brief
+		*    Sends the changed values of the state to the page as one patch
+		*
+		*  @note
+		*    This is called by FlushJavascript(), the changes are kept while there is no berkelium window.
+		*/
+		PLBERKELIUM_API void SyncState();
+		
+		/**
+		*  @brief
+		*    Returns how many state values have been send to the page
+		*
+		*  @return
+		*    amount of values, a value that did not change is not send again
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetStateValueCount() const;
+		
+		/**
+		*  @brief
+		*    Sends a blob of bytes to the page as ArrayBuffer
+		*
+		*  @remarks
+		*    Use this for large lists like packed struct arrays instead of javascript literals or JSON. The page receives the
+		*    blob with native.onbinary("Name", function(buffer) {}) and can read it with typed arrays or a DataView.
+		*    Berkelium only takes javascript strings, so the blob is send base64 encoded and decoded by the native atob().
+		*    A blob that is still queued is replaced by a newer blob with the same name.
+		*
+		*  @param[in] const PLCore::String & sName
+		*    name of the blob, the page listens to it
+		*  @param[in] const PLCore::uint8 * pData
+		*  @param[in] const PLCore::uint32 & nSize
+		*    size of the blob in bytes
+		*/
+		PLBERKELIUM_API void SendBinary(const PLCore::String &sName, const PLCore::uint8 *pData, const PLCore::uint32 &nSize);
+		
+		/**
+		*  @brief
+		*    Returns how many bytes have been send with SendBinary()
+		*
+		*  @return
+		*    amount of bytes, before encoding
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetBinaryByteCount() const;
+		
+		/**
+		*  @brief
+		*    Returns the time spent on encoding blobs for SendBinary()
+		*
+		*  @return
+		*    time in microseconds
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetBinaryEncodeTime() const;
+		
+		/**
+		*  @brief
+		*    Returns the javascript that SendBinary() executes for a blob
+		*
+		*  @remarks
+		*    Benchmark::BinaryTransfer() compares it with the JSON of the same records.
+		*
+		*  @param[in] const PLCore::String & sName
+		*  @param[in] const PLCore::uint8 * pData
+		*  @param[in] const PLCore::uint32 & nSize
+		*
+		*  @return
+		*    the javascript
+		*/
+		PLBERKELIUM_API static PLCore::String GetBinaryJavascript(const PLCore::String &sName, const PLCore::uint8 *pData, const PLCore::uint32 &nSize);
+		
+		/**
+		*  @brief
+		*    Returns the widgets
+		*
+		*  @return
+		*    pointer to hashmap containing widgets (do not destroy the returned instance!)
+		*/
+		PLBERKELIUM_API PLCore::HashMap<Berkelium::Widget*, sWidget*> *GetWidgets() const;
+		
+		/**
+		*  @brief
+		*    Returns the mouse position relative to a widget
+		*
+		*  @param[in] const sWidget * psWidget
+		*  @param[in] const PLMath::Vector2i & vMousePos
+		*
+		*  @return
+		*    mouse position relative to widget
+		*/
+		PLBERKELIUM_API PLMath::Vector2i GetRelativeMousePositionWidget(const sWidget *psWidget, const PLMath::Vector2i &vMousePos) const;
+		
+		/**
+		*  @brief
+		*    Executes javascript on this window
+		*
+		*  @remarks
+		*    Its not needed to prefix the string with 'javascript:'.
+		*    Javascript for a window that has not created its berkelium window yet is kept and executed once the page has loaded.
+		*
+		*  @param[in] const PLCore::String & sJavascript
+		*/
+		PLBERKELIUM_API void ExecuteJavascript(const PLCore::String &sJavascript);
+		
+		/**
+		*  @brief
+		*    Queues javascript to be executed with the other queued javascript on the next update
 		*
-		*  @param[in] PLRenderer::Renderer * pRenderer
-		*  @param[in] const PLMath::Vector2 & vPosition
-		*  @param[in] const PLMath::Vector2 & vImageSize
+		*  @remarks
+		*    All queued javascript is send to berkelium at once instead of one message per call, use this for frequent
+		*    small updates like health or timers. Javascript that is queued with a key replaces earlier queued javascript
+		*    with the same key, so only the newest value of a "set health" is send. Each piece runs within its own try block,
+		*    one that throws does not stop the others.
 		*
-		*  @return
-		*    'true' if window initialization is successful, else 'false'
+		*  @param[in] const PLCore::String & sJavascript
+		*  @param[in] const PLCore::String & sKey
+		*    key of the javascript, empty to never replace
 		*/
-		PLBERKELIUM_API bool Initialize(PLRenderer::Renderer *pRenderer, const PLMath::Vector2 &vPosition, const PLMath::Vector2 &vImageSize);
+		PLBERKELIUM_API void EnqueueJavascript(const PLCore::String &sJavascript, const PLCore::String &sKey = "");
 		
 		/**
 		*  @brief
-		*    Destroys this window instance
+		*    Executes the queued javascript at once
 		*
-		*  @remarks
-		*    This will also destroy all data and components created by this window.
+		*  @note
+		*    This is called by Gui on update, the javascript is kept while there is no berkelium window.
 		*/
-		PLBERKELIUM_API void DestroyInstance() const;
+		PLBERKELIUM_API void FlushJavascript();
 		
 		/**
 		*  @brief
-		*    Returns the berkelium window instance
+		*    Returns how much javascript has been replaced by newer javascript with the same key
 		*
-		*  @remarks
-		*    You can use this to call berkelium specific methods.
+		*  @return
+		*    amount of replaced javascript, see EnqueueJavascript()
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetReplacedJavascriptCount() const;
+		
+		/**
+		*  @brief
+		*    Returns how often queued javascript has been executed
 		*
 		*  @return
-		*    pointer to berkelium window (do not destroy the returned instance!)
+		*    amount of executeJavascript calls made by FlushJavascript()
 		*/
-		PLBERKELIUM_API Berkelium::Window *GetBerkeliumWindow() const;
+		PLBERKELIUM_API PLCore::uint32 GetFlushedJavascriptCount() const;
 		
 		/**
 		*  @brief
-		*    Creates and sets the berkelium window instance
+		*    Returns whether or not the page of this window finished loading
+		*
+		*  @return
+		*    'true' if the page has loaded, else 'false'
+		*/
+		PLBERKELIUM_API bool IsLoaded() const;
+		
+		/**
+		*  @brief
+		*    Returns the image of this window
 		*
 		*  @remarks
-		*    If the berkelium window is already set this will not do anything.
+		*    You can for example use this to save or use the image of this window somewhere else.
 		*
 		*  @return
-		*    void
+		*    image of this window
+		*
+		*  @note
+		*    A frozen window has released its image, see Freeze().
 		*/
-		PLBERKELIUM_API void CreateBerkeliumWindow();
+		PLBERKELIUM_API PLGraphics::Image GetImage() const;
 		
 		/**
 		*  @brief
-		*    Returns the data of the window
+		*    Freezes this window
 		*
 		*  @remarks
-		*    You can use this to get and set window data.
+		*    The last uploaded texture is kept and drawn as a static snapshot while the berkelium window,
+		*    its context (renderer process) and the image holding the CPU copy of the buffer are released.
+		*    This is meant for pages that are rendered once and never change, like credits or help pages.
 		*
 		*  @return
-		*    pointer to window data (do not destroy the returned instance!)
+		*    'true' if the window was frozen, else 'false' (already frozen or nothing painted yet)
 		*/
-		PLBERKELIUM_API sWindowsData *GetData() const;
+		PLBERKELIUM_API bool Freeze();
 		
 		/**
 		*  @brief
-		*    Adds the SceneRenderPass for this window to the SceneRenderer
+		*    Thaws a frozen window
 		*
-		*  @param[in] PLScene::SceneRenderer * pSceneRenderer
+		*  @remarks
+		*    The berkelium window is recreated and navigated to the last known url.
+		*    The frozen texture is drawn until the first paint of the recreated window arrives.
 		*
 		*  @return
-		*    'true' if the SceneRenderPass was added, else 'false'
+		*    'true' if the window was thawed, else 'false'
 		*/
-		PLBERKELIUM_API bool AddSceneRenderPass(PLScene::SceneRenderer *pSceneRenderer);
+		PLBERKELIUM_API bool Thaw();
 		
 		/**
 		*  @brief
-		*    Removes the SceneRenderPass for this window from the SceneRenderer
+		*    Returns whether or not this window is frozen
 		*
 		*  @return
-		*    'true' if the SceneRenderPass was removed, else 'false'
+		*    'true' if the window is frozen, else 'false'
 		*/
-		PLBERKELIUM_API bool RemoveSceneRenderPass();
+		PLBERKELIUM_API bool IsFrozen() const;
 		
 		/**
 		*  @brief
-		*    Moves this window to front
+		*    Sets the time after which this window freezes itself when idle
+		*
+		*  @remarks
+		*    A window is idle when it received no paints and no input, see ResetIdleTime().
+		*
+		*  @param[in] const PLCore::uint32 & nSeconds
+		*    idle time in seconds, 0 disables automatic freezing (default)
 		*/
-		PLBERKELIUM_API void MoveToFront();
+		PLBERKELIUM_API void SetAutoFreeze(const PLCore::uint32 &nSeconds);
 		
 		/**
 		*  @brief
-		*    Returns the name of this window
+		*    Resets the idle time of this window
 		*
-		*  @return
-		*    window name
+		*  @note
+		*    Gui calls this whenever input is send to this window.
 		*/
-		PLBERKELIUM_API PLCore::String GetName() const;
+		PLBERKELIUM_API void ResetIdleTime();
 		
 		/**
 		*  @brief
-		*    Destroys the berkelium window instance
+		*    Freezes this window if automatic freezing is enabled and the window has been idle long enough
 		*
-		*  @remarks
-		*    If the berkelium window has not been set this will not do anything.
+		*  @note
+		*    This is called by Gui on update, see SetAutoFreeze().
 		*/
-		PLBERKELIUM_API void DestroyBerkeliumWindow();
+		PLBERKELIUM_API void UpdateAutoFreeze();
 		
 		/**
 		*  @brief
-		*    Returns the position of this window
+		*    Sets what happens when the page of this window stops responding
 		*
-		*  @return
-		*    window position
+		*  @remarks
+		*    By default nothing happens (UnresponsiveNone), the window only keeps track of how long the page has not responded.
+		*    When UnresponsiveReload and UnresponsiveRecreate are both set, the page is reloaded after the timeout
+		*    and the berkelium window is recreated when the page is still unresponsive after twice the timeout.
+		*
+		*  @param[in] const PLCore::uint32 & nPolicy
+		*    combination of EUnresponsivePolicy flags
+		*  @param[in] const PLCore::uint32 & nTimeout
+		*    time in seconds after which the page is reloaded or recreated
 		*/
-		PLBERKELIUM_API PLMath::Vector2i GetPosition() const;
+		PLBERKELIUM_API void SetUnresponsivePolicy(const PLCore::uint32 &nPolicy, const PLCore::uint32 &nTimeout = 10);
 		
 		/**
 		*  @brief
-		*    Returns the size of this window
+		*    Returns what happens when the page of this window stops responding
 		*
 		*  @return
-		*    window size
+		*    combination of EUnresponsivePolicy flags
 		*/
-		PLBERKELIUM_API PLMath::Vector2i GetSize() const;
+		PLBERKELIUM_API PLCore::uint32 GetUnresponsivePolicy() const;
 		
 		/**
 		*  @brief
-		*    Returns the mouse positions relative to this window
-		*
-		*  @param[in] const PLMath::Vector2i & vMousePos
+		*    Returns whether or not the page of this window is unresponsive
 		*
 		*  @return
-		*    mouse position relative to window
+		*    'true' if the page is unresponsive, else 'false'
 		*/
-		PLBERKELIUM_API PLMath::Vector2i GetRelativeMousePosition(const PLMath::Vector2i &vMousePos) const;
+		PLBERKELIUM_API bool IsUnresponsive() const;
 		
 		/**
 		*  @brief
-		*    Returns the SceneRenderPass index for this window
+		*    Returns whether or not input should be send to this window
+		*
+		*  @note
+		*    Gui checks this before sending input, see UnresponsiveBlockInput.
 		*
 		*  @return
-		*    SceneRenderPass index
+		*    'true' if input is blocked, else 'false'
 		*/
-		PLBERKELIUM_API int GetSceneRenderPassIndex();
+		PLBERKELIUM_API bool IsInputBlocked() const;
 		
 		/**
 		*  @brief
-		*    Moves window to given position
+		*    Returns how long the page of this window has been unresponsive
 		*
-		*  @param[in] const int & nX
-		*  @param[in] const int & nY
+		*  @return
+		*    time in milliseconds, 0 if the page is responsive
 		*/
-		PLBERKELIUM_API void MoveWindow(const int &nX, const int &nY);
-		PLBERKELIUM_API void SetToolTip(const PLCore::String &sText);
-		PLBERKELIUM_API void SetToolTipEnabled(const bool &bEnabled);
+		PLBERKELIUM_API PLCore::uint64 GetUnresponsiveTime() const;
 		
 		/**
 		*  @brief
-		*    Removes all javascript callbacks for this window
+		*    Returns the longest time the page of this window has been unresponsive
 		*
-		*  @remarks
-		*    This can be used to make sure default callbacks are not called parallel to one and other.
+		*  @return
+		*    time in milliseconds
 		*/
-		PLBERKELIUM_API void RemoveCallBacks() const;
+		PLBERKELIUM_API PLCore::uint64 GetMaxUnresponsiveTime() const;
 		
 		/**
 		*  @brief
-		*    Returns the amount of javascript callbacks created by this window
+		*    Returns how often the page of this window has been unresponsive
 		*
 		*  @return
-		*    amount of callbacks
+		*    amount of times the page stopped responding
 		*/
-		PLBERKELIUM_API PLCore::uint32 GetNumberOfCallBacks() const;
+		PLBERKELIUM_API PLCore::uint32 GetUnresponsiveCount() const;
 		
 		/**
 		*  @brief
-		*    Returns a javascript callback by key identifier
+		*    Returns the histogram of the times the page of this window has been unresponsive
 		*
-		*  @param[in] const PLCore::String & sKey
+		*  @remarks
+		*    The buckets hold the amount of unresponsive periods that lasted less than 0.5, 1, 2, 5 and 10 seconds, the last bucket holds the longer ones.
+		*    A period is counted when the page responds again or when the berkelium window is recreated.
 		*
 		*  @return
-		*    pointer to callback (do not destroy the returned instance!)
+		*    pointer to UNRESPONSIVEHISTOGRAMSIZE counters (do not destroy the returned instance!)
 		*/
-		PLBERKELIUM_API sCallBack *GetCallBack(const PLCore::String &sKey) const;
+		PLBERKELIUM_API const PLCore::uint32 *GetUnresponsiveHistogram() const;
 		
 		/**
 		*  @brief
-		*    Removes a javascript callback by key identifier
-		*
-		*  @param[in] const PLCore::String & sKey
+		*    Returns how many callback functions have been called with typed parameters
 		*
 		*  @return
-		*    'true' if the javascript callback was removed, else 'false'
+		*    amount of calls, see ScriptParams
 		*/
-		PLBERKELIUM_API bool RemoveCallBack(const PLCore::String &sKey) const;
+		PLBERKELIUM_API PLCore::uint32 GetTypedCallBackCount() const;
 		
 		/**
 		*  @brief
-		*    Resizes window to given size
-		*
-		*  @note
-		*    Its not advisable to resize a window smaller than 4x4 pixels.
+		*    Returns the time spent on calling callback functions with typed parameters
 		*
-		*  @param[in] const int & nWidth
-		*  @param[in] const int & nHeight
+		*  @return
+		*    time in microseconds, this includes the time spent within the functions
 		*/
-		PLBERKELIUM_API void ResizeWindow(const int &nWidth, const int &nHeight);
+		PLBERKELIUM_API PLCore::uint64 GetTypedCallBackTime() const;
 		
 		/**
 		*  @brief
-		*    Adds and sets a Javascript callback method for this window
+		*    Returns how many callback functions have been called with a parameter string
 		*
 		*  @remarks
-		*    You can add c++ methods that javascript can callback to.
-		*
-		*  @note
-		*    The method you want to callback to needs to be defined as a RTTI method.
-		*    If you do not define the second parameter (sJSFunctionName), the method name will be used instead.
-		*    Set the third parameter to true (bHasReturn) if you want to return anything but make sure the method returns a string, anything else is simply not supported.
-		*
-		*  @param[in] const PLCore::DynFuncPtr pDynFunc
-		*  @param[in] PLCore::String sJSFunctionName
-		*  @param[in] bool bHasReturn
+		*    Functions with a signature that is not supported by ScriptParams are called with a parameter string.
 		*
 		*  @return
-		*    'true' if the method was added, else 'false'
+		*    amount of calls
 		*/
-		PLBERKELIUM_API bool AddCallBackFunction(const PLCore::DynFuncPtr pDynFunc, PLCore::String sJSFunctionName = "",  bool bHasReturn = false);
+		PLBERKELIUM_API PLCore::uint32 GetStringCallBackCount() const;
 		
 		/**
 		*  @brief
-		*    Returns the widgets
+		*    Returns the time spent on calling callback functions with a parameter string
 		*
 		*  @return
-		*    pointer to hashmap containing widgets (do not destroy the returned instance!)
+		*    time in microseconds, this includes building and parsing the string and the time spent within the functions
 		*/
-		PLBERKELIUM_API PLCore::HashMap<Berkelium::Widget*, sWidget*> *GetWidgets() const;
+		PLBERKELIUM_API PLCore::uint64 GetStringCallBackTime() const;
 		
 		/**
 		*  @brief
-		*    Returns the mouse position relative to a widget
+		*    Returns how many batches the page has posted through native.post()
 		*
-		*  @param[in] const sWidget * psWidget
-		*  @param[in] const PLMath::Vector2i & vMousePos
+		*  @return
+		*    amount of batches, each batch is one call from javascript
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetNativePostBatchCount() const;
+		
+		/**
+		*  @brief
+		*    Returns how many messages the page has posted through native.post()
 		*
 		*  @return
-		*    mouse position relative to widget
+		*    amount of messages, compare with GetNativePostBatchCount() to see how well the messages are batched
 		*/
-		PLBERKELIUM_API PLMath::Vector2i GetRelativeMousePositionWidget(const sWidget *psWidget, const PLMath::Vector2i &vMousePos) const;
+		PLBERKELIUM_API PLCore::uint32 GetNativePostMessageCount() const;
 		
 		/**
 		*  @brief
-		*    Executes javascript on this window
+		*    Marks that input has been send to the window
 		*
 		*  @remarks
-		*    Its not needed to prefix the string with 'javascript:'.
+		*    The earliest input that is not yet painted is matched with the next paint of berkelium and
+		*    after that with the next draw of the window, the latencies are added to the histograms.
+		*    When berkelium runs on a thread of its own, only a paint that was fired after the thread has executed the input
+		*    is matched, the latency is still measured from when the input has occurred.
 		*
-		*  @param[in] const PLCore::String & sJavascript
+		*  @param[in] const PLCore::uint64 & nInputTime
+		*    time in microseconds the input has occurred
+		*
+		*  @note
+		*    This is called by Gui when it sends the queued input.
 		*/
-		PLBERKELIUM_API void ExecuteJavascript(const PLCore::String &sJavascript) const;
+		PLBERKELIUM_API void MarkInput(const PLCore::uint64 &nInputTime);
 		
 		/**
 		*  @brief
-		*    Returns whether or not the page of this window finished loading
+		*    Returns the histogram of an input latency
+		*
+		*  @param[in] const PLCore::uint32 & nLatency
+		*    latency, see EInputLatency
 		*
 		*  @return
-		*    'true' if the page has loaded, else 'false'
+		*    histogram with LATENCYHISTOGRAMSIZE buckets of one millisecond (do not destroy the returned instance!), a null pointer for an unknown latency
 		*/
-		PLBERKELIUM_API bool IsLoaded() const;
+		PLBERKELIUM_API const sLatencyHistogram *GetInputLatencyHistogram(const PLCore::uint32 &nLatency) const;
 		
 		/**
 		*  @brief
-		*    Returns the image of this window
+		*    Returns a percentile of an input latency
 		*
-		*  @remarks
-		*    You can for example use this to save or use the image of this window somewhere else.
+		*  @param[in] const PLCore::uint32 & nLatency
+		*    latency, see EInputLatency
+		*  @param[in] const PLCore::uint32 & nPercentile
+		*    percentile between 1 and 100, for example 50, 95 or 99
 		*
 		*  @return
-		*    image of this window
+		*    latency in milliseconds that this percent of the measured input stayed within, 0 when nothing has been measured yet
 		*/
-		PLBERKELIUM_API PLGraphics::Image GetImage() const;
+		PLBERKELIUM_API PLCore::uint32 GetInputLatency(const PLCore::uint32 &nLatency, const PLCore::uint32 &nPercentile) const;
+		
+		/**
+		*  @brief
+		*    Clears the input latency histograms
+		*/
+		PLBERKELIUM_API void ResetInputLatency();
+		
+		/**
+		*  @brief
+		*    Applies the unresponsive policy when the page has been unresponsive long enough
+		*
+		*  @note
+		*    This is called by Gui on update, see SetUnresponsivePolicy().
+		*/
+		PLBERKELIUM_API void UpdateWatchdog();
 
 	protected:
 
 	private:
 		void DebugToConsole(const PLCore::String &sString);
+		
+		/**
+		*  @brief
+		*    Calls a callback function with javascript arguments
+		*
+		*  @param[in] const sCallBackFunction * psCallBackFunction
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*  @param[out] PLCore::String * psResult
+		*    receives the return of the function as string, can be a null pointer
+		*/
+		void CallCallBackFunction(const sCallBackFunction *psCallBackFunction, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, PLCore::String *psResult);
+		
+		/**
+		*  @brief
+		*    Dispatches a batch of messages the page has posted through native.post()
+		*
+		*  @remarks
+		*    The batch is flattened into name, number of arguments and the arguments of every message.
+		*    Each message calls the callback function that was added with AddCallBackFunction() under that name, results are not send back.
+		*
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*/
+		void DispatchNativePost(const Berkelium::Script::Variant *pArgs, size_t nNumArgs);
+		
+		/**
+		*  @brief
+		*    Dispatches a native.call() of the page
+		*
+		*  @remarks
+		*    The arguments are the correlation id, the name of the function and its arguments.
+		*
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*/
+		void DispatchNativeCall(const Berkelium::Script::Variant *pArgs, size_t nNumArgs);
+		
+		/**
+		*  @brief
+		*    Adds a settled native.call() to be send to javascript
+		*
+		*  @param[in] const PLCore::uint32 & nCallId
+		*  @param[in] const bool & bResolved
+		*  @param[in] const PLCore::String & sValue
+		*/
+		void SettleCallBack(const PLCore::uint32 &nCallId, const bool &bResolved, const PLCore::String &sValue);
+		
+		/**
+		*  @brief
+		*    Queues the javascript that settles the promises of the settled native.call()s
+		*/
+		void ProcessSettledCallBacks();
+		
+		/**
+		*  @brief
+		*    Returns a string as javascript string literal
+		*
+		*  @param[in] const PLCore::String & sString
+		*
+		*  @return
+		*    the quoted and escaped string
+		*/
+		static PLCore::String ToJavascriptString(const PLCore::String &sString);
+		
+		/**
+		*  @brief
+		*    Returns a number as javascript literal
+		*
+		*  @param[in] const double & dValue
+		*
+		*  @return
+		*    the number, NaN, Infinity or -Infinity
+		*/
+		PLCore::String ToJavascriptNumber(const double &dValue) const;
+		
+		/**
+		*  @brief
+		*    Returns the value of a RTTI attribute as javascript literal
+		*
+		*  @param[in] const PLCore::DynVar & cDynVar
+		*
+		*  @return
+		*    true or false for booleans, a number for numeric types and a string for anything else
+		*/
+		PLCore::String ToJavascriptLiteral(const PLCore::DynVar &cDynVar) const;
+		
+		/**
+		*  @brief
+		*    Sets a javascript literal in the state, marks it as changed when it differs
+		*
+		*  @param[in] const PLCore::String & sPath
+		*  @param[in] const PLCore::String & sLiteral
+		*/
+		void SetStateLiteral(const PLCore::String &sPath, const PLCore::String &sLiteral);
+		
+		/**
+		*  @brief
+		*    Marks the whole state as changed, so that a page that (re)loads gets all of it
+		*/
+		void MarkStateDirty();
+		
+		/**
+		*  @brief
+		*    Encodes bytes as base64
+		*
+		*  @param[in] const PLCore::uint8 * pData
+		*  @param[in] const PLCore::uint32 & nSize
+		*
+		*  @return
+		*    the base64 string
+		*/
+		static PLCore::String ToBase64(const PLCore::uint8 *pData, const PLCore::uint32 &nSize);
+		
+		/**
+		*  @brief
+		*    Calls a callback function or coalesces the call, depending on its coalescing policy
+		*
+		*  @param[in] sCallBackFunction * psCallBackFunction
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*  @param[in] void * pReplyMsg
+		*/
+		void PostCallBackFunction(sCallBackFunction *psCallBackFunction, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, void *pReplyMsg);
+		
+		/**
+		*  @brief
+		*    Returns the callback function a page refers to
+		*
+		*  @remarks
+		*    native.post() and native.call() send the interned id of functions the page knows, else the name.
+		*
+		*  @param[in] const Berkelium::Script::Variant & cFunction
+		*    id or name of the function
+		*
+		*  @return
+		*    the callback function, a null pointer if there is none
+		*/
+		sCallBackFunction *GetCallBackFunction(const Berkelium::Script::Variant &cFunction) const;
+		
+		/**
+		*  @brief
+		*    Returns the interned id of a function berkelium reports a call of
+		*
+		*  @param[in] const Berkelium::WideString & sFunctionName
+		*    the decimal id the function is bound with
+		*
+		*  @return
+		*    the id, 0xFFFFFFFF if the name is not an id
+		*/
+		PLCore::uint32 GetCallBackId(const Berkelium::WideString &sFunctionName) const;
+		
+		/**
+		*  @brief
+		*    Returns the id of a default callback
+		*
+		*  @param[in] const PLCore::String & sKey
+		*    DRAGWINDOW, HIDEWINDOW, CLOSEWINDOW or RESIZEWINDOW
+		*
+		*  @return
+		*    the id, NUMOFDEFAULTCALLBACKS if the key is not a default callback
+		*/
+		PLCore::uint32 GetDefaultCallBackId(const PLCore::String &sKey) const;
+		
+		/**
+		*  @brief
+		*    Binds a javascript function to an interned id
+		*
+		*  @param[in] const PLCore::String & sJSFunctionName
+		*  @param[in] const PLCore::uint32 & nId
+		*  @param[in] const bool & bHasReturn
+		*/
+		void BindFunctionId(const PLCore::String &sJSFunctionName, const PLCore::uint32 &nId, const bool &bHasReturn);
+		
+		/**
+		*  @brief
+		*    Destroys the coalesced calls that have not been dispatched
+		*/
+		void ClearCoalescedCallBacks();
 
 		virtual void Draw(PLRenderer::Renderer &cRenderer, const PLScene::SQCull &cCullQuery) override;
 
@@ -693,7 +2045,7 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		*  @param[in] const PLMath::Vector2 & vImageSize
 		*
 		*  @return
-		*    pointer to created vertex buffer (can be a null pointer, destroy the returned instance when you no longer need it)
+		*    pointer to created vertex buffer (can be a null pointer, give it back with DestroyVertexBuffer())
 		*/
 		PLRenderer::VertexBuffer *CreateVertexBuffer(const PLMath::Vector2 &vPosition, const PLMath::Vector2 &vImageSize);
 		
@@ -730,18 +2082,22 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		*    Copies the buffer data from berkelium to the holding image buffer for a full update
 		*
 		*  @param[in] PLCore::uint8 * pImageBuffer
+		*  @param[in] const int & nPitch
+		*    width of the image buffer in pixels, the capacity that can be bigger than nWidth
 		*  @param[in] int & nWidth
 		*  @param[in] int & nHeight
 		*  @param[in] const unsigned char * sourceBuffer
 		*  @param[in] const Berkelium::Rect & sourceBufferRect
 		*/
-		void BufferCopyFull(PLCore::uint8 *pImageBuffer, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect);
+		void BufferCopyFull(PLCore::uint8 *pImageBuffer, const int &nPitch, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect);
 		
 		/**
 		*  @brief
 		*    Copies the buffer data from berkelium to the holding image buffer for a partial update
 		*
 		*  @param[in] PLCore::uint8 * pImageBuffer
+		*  @param[in] const int & nPitch
+		*    width of the image buffer in pixels
 		*  @param[in] int & nWidth
 		*  @param[in] int & nHeight
 		*  @param[in] const unsigned char * sourceBuffer
@@ -749,13 +2105,29 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		*  @param[in] size_t numCopyRects
 		*  @param[in] const Berkelium::Rect * copyRects
 		*/
-		void BufferCopyRects(PLCore::uint8 *pImageBuffer, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects);
+		void BufferCopyRects(PLCore::uint8 *pImageBuffer, const int &nPitch, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects);
+		
+		/**
+		*  @brief
+		*    Updates the coverage mask of the alpha hit testing for a painted rectangle
+		*
+		*  @remarks
+		*    The mask is recreated (fully covered) when the frame size has changed.
+		*
+		*  @param[in] int nLeft
+		*  @param[in] int nTop
+		*  @param[in] int nWidth
+		*  @param[in] int nHeight
+		*/
+		void UpdateCoverageMask(int nLeft, int nTop, int nWidth, int nHeight);
 		
 		/**
 		*  @brief
 		*    Copies the buffer data from berkelium to the holding image buffer for a scrolled update
 		*
 		*  @param[in] PLCore::uint8 * pImageBuffer
+		*  @param[in] const int & nPitch
+		*    width of the image buffer in pixels
 		*  @param[in] int & nWidth
 		*  @param[in] int & nHeight
 		*  @param[in] const unsigned char * sourceBuffer
@@ -766,13 +2138,79 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		*  @param[in] int dy
 		*  @param[in] const Berkelium::Rect & scrollRect
 		*/
-		void BufferCopyScroll(PLCore::uint8 *pImageBuffer, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect);
+		void BufferCopyScroll(PLCore::uint8 *pImageBuffer, const int &nPitch, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect);
+		
+		/**
+		*  @brief
+		*    Returns the capacity an image and texture needs for a size
+		*
+		*  @param[in] const int & nSize
+		*    width or height that has to fit
+		*  @param[in] const int & nCapacity
+		*    current capacity, 0 when nothing has been allocated yet
+		*
+		*  @return
+		*    the current capacity when the size fits and does not waste too much, else the new capacity
+		*/
+		static int GetTextureCapacity(const int &nSize, const int &nCapacity);
+		
+		/**
+		*  @brief
+		*    Creates a texture buffer from an image, taken from the texture pool when there is one
+		*
+		*  @param[in] const PLGraphics::Image & cImage
+		*
+		*  @return
+		*    pointer to created texture buffer (can be a null pointer, give it back with DestroyTextureBuffer())
+		*/
+		PLRenderer::TextureBuffer *CreateTextureBuffer(const PLGraphics::Image &cImage);
+		
+		/**
+		*  @brief
+		*    Destroys a texture buffer or gives it back to the texture pool
+		*
+		*  @param[in] PLRenderer::TextureBuffer * pTextureBuffer
+		*    texture buffer, can be a null pointer
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*/
+		void DestroyTextureBuffer(PLRenderer::TextureBuffer *pTextureBuffer, const int &nWidth, const int &nHeight);
+		
+		/**
+		*  @brief
+		*    Destroys a vertex buffer or gives it back to the texture pool
+		*
+		*  @param[in] PLRenderer::VertexBuffer * pVertexBuffer
+		*    vertex buffer, can be a null pointer
+		*/
+		void DestroyVertexBuffer(PLRenderer::VertexBuffer *pVertexBuffer);
+		
+		/**
+		*  @brief
+		*    Uploads the image of a widget to its texture buffer or copies it into its atlas rect
+		*
+		*  @param[in] sWidget * psWidget
+		*/
+		void UploadWidget(sWidget *psWidget);
+		
+		/**
+		*  @brief
+		*    Gives the resources of a widget back and destroys it
+		*
+		*  @param[in] sWidget * psWidget
+		*    widget, it has to be removed from the widgets already
+		*/
+		void DestroyWidget(sWidget *psWidget);
 		
 		/**
 		*  @brief
 		*    Uploads the image buffer data to the GPU
+		*
+		*  @param[in] size_t numCopyRects
+		*  @param[in] const Berkelium::Rect * copyRects
+		*    parts of the image that have been painted, the whole image when there are none, only the atlas makes use of them
 		*/
-		void BufferUploadToGPU();
+		void BufferUploadToGPU(size_t numCopyRects = 0, const Berkelium::Rect *copyRects = nullptr);
 		
 		/**
 		*  @brief
@@ -801,19 +2239,64 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		*/
 		void DestroyContext();
 		
+		/**
+		*  @brief
+		*    Creates the berkelium context and window and binds the default callback functions
+		*
+		*  @param[in] const sBootstrapScript * psBootstrapScript
+		*    script to bootstrap the pages with, a null pointer for the built-in script
+		*/
+		void CreateBerkeliumWindowInstance(const sBootstrapScript *psBootstrapScript);
+		
 		/**
 		*  @brief
 		*    Sets the default windows settings
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*  @param[in] const bool & bTransparent
+		*  @param[in] const PLCore::String & sUrl
 		*/
-		void SetWindowSettings();
+		void SetWindowSettings(const int &nWidth, const int &nHeight, const bool &bTransparent, const PLCore::String &sUrl);
 		void SetupToolTipWindow();
 		void DestroyToolTipWindow();
 		
 		/**
 		*  @brief
 		*    Sets the default callback functions for this window
+		*
+		*  @param[in] const sBootstrapScript * psBootstrapScript
+		*    script to bootstrap the pages with, a null pointer for the built-in script
+		*/
+		void SetDefaultCallBackFunctions(const sBootstrapScript *psBootstrapScript);
+		
+		/**
+		*  @brief
+		*    Binds a javascript callback function to the berkelium window
+		*
+		*  @remarks
+		*    The function is bound by its interned id, native.post() and native.call() learn the id of the function name.
+		*
+		*  @param[in] const PLCore::uint32 & nId
+		*  @param[in] const PLCore::String & sFunctionName
+		*  @param[in] const PLCore::String & sJSFunctionName
+		*  @param[in] const bool & bHasReturn
+		*/
+		void BindCallBackFunction(const PLCore::uint32 &nId, const PLCore::String &sFunctionName, const PLCore::String &sJSFunctionName, const bool &bHasReturn);
+		
+		/**
+		*  @brief
+		*    Binds all javascript callback functions that where added before the berkelium window was created
+		*/
+		void BindCallBackFunctions();
+		
+		/**
+		*  @brief
+		*    Adds a script that is evaluated when a page starts loading
+		*
+		*  @param[in] const PLCore::String & sJavascript
 		*/
-		void SetDefaultCallBackFunctions();
+		void AddStartLoadingScript(const PLCore::String &sJavascript);
 		
 		/**
 		*  @brief
@@ -828,6 +2311,141 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		*    Draws widgets on screen
 		*/
 		void DrawWidgets();
+		
+		/**
+		*  @brief
+		*    Navigates the berkelium window to the given url
+		*
+		*  @param[in] const PLCore::String & sUrl
+		*/
+		void SendNavigateTo(const PLCore::String &sUrl) const;
+		
+		/**
+		*  @brief
+		*    Resizes the berkelium window to the given size
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*/
+		void SendResize(const int &nWidth, const int &nHeight) const;
+		
+		/**
+		*  @brief
+		*    Sends the result of a synchronous javascript callback back to javascript
+		*
+		*  @param[in] void * pReplyMsg
+		*  @param[in] const PLCore::String & sResult
+		*/
+		void SendScriptReturn(void *pReplyMsg, const PLCore::String &sResult) const;
+		
+		/**
+		*  @brief
+		*    Reloads the page of the berkelium window
+		*/
+		void SendReload() const;
+		
+		/**
+		*  @brief
+		*    Ends the unresponsive period and adds it to the histogram
+		*/
+		void EndUnresponsive();
+		
+		/**
+		*  @brief
+		*    Adds a latency to a histogram
+		*
+		*  @param[in] const PLCore::uint32 & nLatency
+		*    latency, see EInputLatency
+		*  @param[in] const PLCore::uint64 & nTime
+		*    latency in microseconds
+		*/
+		void AddInputLatency(const PLCore::uint32 &nLatency, const PLCore::uint64 &nTime);
+		
+		/**
+		*  @brief
+		*    Matches the input that has not been painted yet with a paint
+		*
+		*  @param[in] const PLCore::uint64 & nPaintTime
+		*    time in microseconds berkelium has painted
+		*  @param[in] const PLCore::uint32 & nExecutedCommands
+		*    amount of commands the berkelium thread had executed when it painted, 0 without a thread
+		*/
+		void MarkPaint(const PLCore::uint64 &nPaintTime, const PLCore::uint32 &nExecutedCommands);
+		
+		/**
+		*  @brief
+		*    Returns whether or not the calling thread is the berkelium thread
+		*
+		*  @return
+		*    'true' if berkelium runs on its own thread and we are called from it, else 'false'
+		*/
+		bool IsOnBerkeliumThread() const;
+		
+		/**
+		*  @brief
+		*    Sends a command to the berkelium thread if berkelium runs on its own thread and we are not called from it
+		*
+		*  @param[in] const PLCore::uint32 & nType
+		*  @param[in] const int & nParam0
+		*  @param[in] const int & nParam1
+		*  @param[in] const int & nParam2
+		*  @param[in] const int & nParam3
+		*  @param[in] const PLCore::String & sParam0
+		*  @param[in] const PLCore::String & sParam1
+		*  @param[in] void * pParam
+		*
+		*  @return
+		*    'true' if the command was send, else 'false' (the caller should call berkelium directly)
+		*/
+		bool QueueCommand(const PLCore::uint32 &nType, const int &nParam0 = 0, const int &nParam1 = 0, const int &nParam2 = 0, const int &nParam3 = 0, const PLCore::String &sParam0 = "", const PLCore::String &sParam1 = "", void *pParam = nullptr) const;
+		
+		/**
+		*  @brief
+		*    Creates a browser event
+		*
+		*  @param[in] const PLCore::uint32 & nType
+		*  @param[in] Berkelium::Window * pWindow
+		*  @param[in] Berkelium::Widget * pWidget
+		*
+		*  @return
+		*    pointer to created browser event (destroy the returned instance with DestroyBrowserEvent() when you no longer need it)
+		*/
+		sBrowserEvent *CreateBrowserEvent(const PLCore::uint32 &nType, Berkelium::Window *pWindow, Berkelium::Widget *pWidget = nullptr) const;
+		
+		/**
+		*  @brief
+		*    Copies the paint data from berkelium into a browser event
+		*
+		*  @param[in] sBrowserEvent * psEvent
+		*  @param[in] const unsigned char * sourceBuffer
+		*  @param[in] const Berkelium::Rect & sourceBufferRect
+		*  @param[in] size_t numCopyRects
+		*  @param[in] const Berkelium::Rect * copyRects
+		*  @param[in] int dx
+		*  @param[in] int dy
+		*  @param[in] const Berkelium::Rect & scrollRect
+		*/
+		void CopyPaint(sBrowserEvent *psEvent, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect) const;
+		
+		/**
+		*  @brief
+		*    Destroys a browser event and its data
+		*
+		*  @param[in] sBrowserEvent * psEvent
+		*/
+		void DestroyBrowserEvent(sBrowserEvent *psEvent) const;
+		
+		/**
+		*  @brief
+		*    Applies the paints and widget changes the berkelium thread has send to this window
+		*/
+		void ProcessPaintEvents();
+		
+		/**
+		*  @brief
+		*    Destroys all browser events that have not been processed
+		*/
+		void ClearBrowserEvents();
 
 		Berkelium::Window *m_pBerkeliumWindow;
 		const PLCore::String m_sWindowName;
@@ -840,6 +2458,17 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		PLRenderer::TextureBuffer *m_pTextureBuffer;
 		PLRenderer::TextureBuffer *m_pTextureBufferNew;
 		PLGraphics::Image m_cImage;
+		int m_nTextureWidth;
+		int m_nTextureHeight;
+		int m_nImageWidth;
+		int m_nImageHeight;
+		int m_nTexturePaintedWidth;					/**< Size of the window when the drawn texture or atlas rect was last uploaded */
+		int m_nTexturePaintedHeight;
+		PLCore::uint32 m_nTextureAllocationCount;
+		TexturePool *m_pTexturePool;
+		TextureAtlas *m_pTextureAtlas;
+		sAtlasRect *m_psAtlasRect;
+		sAtlasRect *m_psAtlasRectOld;				/**< Rect a window that has moved out of the atlas draws until its texture has been painted */
 		sWindowsData *m_psWindowsData;
 		bool m_bInitialized;
 		bool m_bReadyToDraw;
@@ -847,10 +2476,79 @@ class SRPWindow : public PLScene::SceneRendererPass, public Berkelium::WindowDel
 		Berkelium::Context *m_pBerkeliumContext;
 		SRPWindow *m_pToolTip;
 		bool m_bToolTipEnabled;
-		PLCore::HashMap<PLCore::String, sCallBack*> *m_pmapDefaultCallBacks;
-		PLCore::HashMap<PLCore::String, PLCore::DynFuncPtr> *m_pmapCallBackFunctions;
+		sCallBack **m_ppDefaultCallBacks;
+		PLCore::HashMap<PLCore::String, sCallBackFunction*> *m_pmapCallBackFunctions;
+		PLCore::Array<sCallBackFunction*> m_lstCallBackFunctionTable;
 		bool m_bIgnoreBufferUpdate;
 		PLCore::HashMap<Berkelium::Widget*, sWidget*> *m_pmapWidgets;
+		bool m_bFrozen;
+		PLCore::uint64 m_nAutoFreezeTime;
+		PLCore::uint64 m_nLastActivityTime;
+		BerkeliumThread *m_pBerkeliumThread;
+		PLCore::List<sDefaultCallBackEvent*> *m_plstDefaultCallBackEvents;
+		PLCore::List<SRPWindow*> *m_plstResizePreviewWindows;
+		const sBootstrapScript *m_psBootstrapScript;
+		PLCore::uint32 m_nNumOfStartLoadingScripts;
+		PLCore::uint64 m_nCreateTime;
+		PLCore::uint64 m_nCreateRequestTime;						/**< Time in microseconds the berkelium window was requested, 0 if never */
+		PLCore::uint64 m_nFirstPaintLatency;
+		PLCore::uint64 m_nFirstCallBackLatency;
+		Berkelium::Window *m_pPublishedBerkeliumWindow;				/**< Shared, the berkelium window as the berkelium thread has published it, see EventCreated */
+		PLCore::uint32 m_nCreateCommandMark;						/**< Amount of pushed commands before the last create or destroy, older published windows are ignored */
+		bool m_bBerkeliumWindowCreated;
+		SPSCQueue<sBrowserEvent*> *m_pPaintQueue;
+		SPSCQueue<sBrowserEvent*> *m_pEventQueue;
+		PLCore::uint32 m_nUnresponsivePolicy;
+		PLCore::uint64 m_nUnresponsiveTimeout;
+		bool m_bUnresponsive;
+		bool m_bUnresponsiveReloaded;
+		PLCore::uint64 m_nUnresponsiveStartTime;
+		PLCore::uint64 m_nMaxUnresponsiveTime;
+		PLCore::uint32 m_nUnresponsiveCount;
+		PLCore::uint32 m_nUnresponsiveHistogram[UNRESPONSIVEHISTOGRAMSIZE];
+		PLCore::uint32 m_nTypedCallBackCount;
+		PLCore::uint64 m_nTypedCallBackTime;
+		PLCore::uint32 m_nStringCallBackCount;
+		PLCore::uint64 m_nStringCallBackTime;
+		PLCore::uint32 m_nNativePostBatchCount;
+		PLCore::uint32 m_nNativePostMessageCount;
+		PLCore::List<sCoalescedCallBack*> *m_plstCoalescedCallBacks;
+		PLCore::HashMap<PLCore::String, sCoalescedCallBack*> *m_pmapCoalescedCallBacks;
+		PLCore::uint32 m_nCoalescedDroppedCount;
+		PLCore::uint32 m_nCoalescedDispatchedCount;
+		PLCore::Array<PLCore::String> m_lstQueuedJavascript;
+		PLCore::Array<PLCore::String> m_lstPendingJavascript;		/**< Javascript executed before the berkelium window was created, see onLoad() */
+		PLCore::HashMap<PLCore::String, PLCore::uint32> *m_pmapQueuedJavascriptKeys;
+		PLCore::uint32 m_nReplacedJavascriptCount;
+		PLCore::uint32 m_nFlushedJavascriptCount;
+		PLCore::uint32 m_nCurrentCallId;
+		bool m_bCurrentCallDeferred;
+		PLCore::Mutex m_cSettledCallBacksMutex;
+		PLCore::List<sSettledCallBack*> m_lstSettledCallBacks;
+		PLCore::HashMap<PLCore::String, sStateValue*> *m_pmapState;
+		PLCore::Array<PLCore::String> m_lstDirtyState;
+		PLCore::HashMap<PLCore::String, sStateObject*> *m_pmapStateObjects;
+		PLCore::uint32 m_nStateValueCount;
+		PLCore::uint64 m_nBinaryByteCount;
+		PLCore::uint64 m_nBinaryEncodeTime;
+		bool m_bAlphaHitTest;
+		PLCore::uint8 m_nAlphaHitTestThreshold;
+		PLCore::uint8 *m_pCoverageMask;
+		int m_nCoverageMaskWidth;
+		int m_nCoverageMaskHeight;
+		PLCore::uint64 m_nPendingInputTime;
+		PLCore::uint32 m_nPendingInputCommand;
+		PLCore::uint64 m_nPaintedInputTime;
+		sLatencyHistogram m_sInputLatency[2];
+		bool m_bResizePreview;
+		int m_nPreviewWidth;
+		int m_nPreviewHeight;
+		PLCore::uint64 m_nPreviewStartTime;
+		PLCore::uint64 m_nPreviewChangeTime;
+		PLCore::uint64 m_nResizeStableTime;
+		PLCore::uint64 m_nMaxPreviewTime;
+		PLCore::uint32 m_nResizeCount;
+		PLCore::uint32 m_nPreviewResizeCount;
 
 
 };
@@ -0,0 +1,111 @@
+#ifndef __PLBERKELIUM_SCRIPTPARAMS_H__
+#define __PLBERKELIUM_SCRIPTPARAMS_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Func/Func.h>
+
+#include "berkelium/ScriptVariant.hpp"
+#include "berkelium/ScriptUtil.hpp"
+
+#include "PLBerkelium.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Calls dynamic functions with javascript arguments without going through strings
+*
+*  @remarks
+*    The arguments are converted straight into the typed parameters of the function, a javascript string
+*    may contain whitespaces and quotes. Missing arguments are passed as null (false, 0 or an empty string).
+*    Supported are functions with up to two parameters of the types bool, int, float, double and PLCore::String
+*    and a return of the same types or void, other functions have to be called with a parameter string,
+*    see CallWithParameterString().
+*/
+class ScriptParams {
+
+
+	public:
+		/**
+		*  @brief
+		*    Returns whether or not a function can be called with typed parameters
+		*
+		*  @param[in] PLCore::DynFunc & cDynFunc
+		*
+		*  @return
+		*    'true' if the signature of the function is supported, else 'false'
+		*/
+		PLBERKELIUM_API static bool IsSupported(PLCore::DynFunc &cDynFunc);
+
+		/**
+		*  @brief
+		*    Calls a function with javascript arguments
+		*
+		*  @param[in] PLCore::DynFunc & cDynFunc
+		*    function to call, see IsSupported()
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*  @param[out] PLCore::String * psResult
+		*    receives the return of the function as string, can be a null pointer
+		*
+		*  @return
+		*    'true' if the function was called, else 'false' (signature not supported)
+		*/
+		PLBERKELIUM_API static bool Call(PLCore::DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, PLCore::String *psResult);
+
+		/**
+		*  @brief
+		*    Converts a javascript argument into a string without going through JSON
+		*
+		*  @param[in] const Berkelium::Script::Variant & cVariant
+		*
+		*  @return
+		*    the string, "true" or "false" for booleans, the number for doubles and an empty string for anything else
+		*/
+		PLBERKELIUM_API static PLCore::String ToString(const Berkelium::Script::Variant &cVariant);
+
+		/**
+		*  @brief
+		*    Creates the parameter string for a function that can not be called with typed parameters
+		*
+		*  @param[in] const Berkelium::Script::Variant * pArgs
+		*  @param[in] size_t nNumArgs
+		*
+		*  @return
+		*    parameter string like "Param0=\"text\" Param1=1"
+		*/
+		PLBERKELIUM_API static PLCore::String ToParameterString(const Berkelium::Script::Variant *pArgs, size_t nNumArgs);
+
+		/**
+		*  @brief
+		*    Calls a function with a parameter string
+		*
+		*  @param[in] PLCore::DynFunc & cDynFunc
+		*    function to call, any signature
+		*  @param[in] const PLCore::String & sParams
+		*    parameter string, see ToParameterString()
+		*  @param[out] PLCore::String * psResult
+		*    receives the return of the function as string, can be a null pointer
+		*/
+		PLBERKELIUM_API static void CallWithParameterString(PLCore::DynFunc &cDynFunc, const PLCore::String &sParams, PLCore::String *psResult);
+
+
+};
+
+
+};
+
+
+#endif // __PLBERKELIUM_SCRIPTPARAMS_H__
@@ -0,0 +1,491 @@
+#ifndef __PLBERKELIUM_TEXTUREATLAS_H__
+#define __PLBERKELIUM_TEXTUREATLAS_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
+#include <PLCore/Core/MemoryManager.h>
+#include <PLGraphics/Image/Image.h>
+#include <PLGraphics/Image/ImageBuffer.h>
+#include <PLMath/Vector2i.h>
+#include <PLRenderer/Renderer/Renderer.h>
+#include <PLRenderer/Renderer/TextureBuffer.h>
+#include <PLRenderer/Renderer/VertexBuffer.h>
+
+#include "PLBerkelium.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Defines                                               ]
+//[-------------------------------------------------------]
+#define TEXTUREATLASPAGESIZE 512
+#define TEXTUREATLASMAXSIZE 256
+#define TEXTUREATLASGRANULARITY 8
+#define TEXTUREATLASHOTSCORE 16
+
+
+//[-------------------------------------------------------]
+//[ Structures                                            ]
+//[-------------------------------------------------------]
+struct sAtlasPage;
+
+struct sAtlasRect
+{
+	sAtlasPage *psPage;
+	PLCore::uint32 nShelf;
+	int nX;									/**< Position in the page */
+	int nY;
+	int nWidth;								/**< Allocated size, at least the size asked for */
+	int nHeight;
+	PLMath::Vector2i vQuadPosition;			/**< Screen position of the quad when it is batched */
+	PLMath::Vector2i vQuadSize;				/**< Screen size of the quad when it is batched */
+	PLMath::Vector2i vUsedSize;				/**< Part of the rect that is drawn on the quad */
+	bool bBatched;
+	bool bHot;								/**< The rect is on a page of the frequently painted rects */
+	PLCore::uint32 nPaintedFrame;			/**< Frame the rect has been painted in last */
+	PLCore::uint32 nPaintScore;				/**< Rises in frames the rect is painted in and falls in the others */
+};
+
+struct sAtlasHole
+{
+	int nX;
+	int nWidth;
+
+	bool operator ==(const sAtlasHole &sHole) const
+	{
+		return nX == sHole.nX && nWidth == sHole.nWidth;
+	}
+};
+
+struct sAtlasShelf
+{
+	int nY;
+	int nHeight;
+	int nX;									/**< Start of the free room at the end of the shelf */
+	PLCore::uint32 nRectCount;
+	PLCore::Array<sAtlasHole> lstHoles;		/**< Room of freed rects between the rects, sorted by position */
+};
+
+struct sAtlasPage
+{
+	PLRenderer::TextureBuffer *pTextureBuffer;
+	PLGraphics::Image cImage;				/**< Cpu copy of the page, the rects are painted into it */
+	PLCore::Array<sAtlasShelf*> lstShelves;
+	PLCore::Array<sAtlasRect*> lstRects;
+	int nShelvesHeight;						/**< Height taken by the shelves from the top of the page */
+	PLCore::uint32 nUsedArea;				/**< Area of the allocated rects */
+	bool bDirty;							/**< The image has changed since the last upload */
+	bool bHot;								/**< The page holds the frequently painted rects */
+	PLRenderer::VertexBuffer *pVertexBuffer;
+	PLCore::uint32 nBatchSize;				/**< Amount of quads the vertex buffer has room for */
+	PLCore::uint32 nBatchCount;				/**< Amount of quads in the vertex buffer */
+	bool bBatchDirty;
+	PLCore::uint32 nDrawnFrame;
+};
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Atlas that packs the surfaces of small windows and widgets into shared texture pages
+*
+*  @remarks
+*    Rects are packed into shelves, rows of the page with the height of the first rect that opened them. A rect goes to the
+*    lowest shelf it fits in, a new shelf is only opened when that would waste more than half the height of the rect.
+*    The room of a rect that is freed in the middle of a shelf is kept in the holes of the shelf, the smallest hole a new
+*    rect fits in is taken before the room at the end of the shelf.
+*    Paints are copied into the cpu copy of the page, a page that has changed is uploaded once when it is drawn next.
+*    Rects that are painted in most frames are moved to pages of their own, so that a static page is not uploaded again
+*    every frame because of one animated rect on it. Rects that stop painting are moved back to the static pages.
+*    When batching is enabled the windows of a page are drawn with one call by the first of them that is drawn in a frame,
+*    the windows of a page are then drawn in the order they have been allocated in instead of the order of the scene renderer.
+*/
+class TextureAtlas {
+
+
+	public:
+		PLBERKELIUM_API TextureAtlas(PLRenderer::Renderer &cRenderer);
+		PLBERKELIUM_API ~TextureAtlas();
+
+		/**
+		*  @brief
+		*    Returns if a surface is small enough to be put into the atlas
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*
+		*  @return
+		*    'true' if both are at most TEXTUREATLASMAXSIZE, else 'false'
+		*/
+		PLBERKELIUM_API static bool Fits(const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Allocates a rect in the atlas
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*
+		*  @return
+		*    the rect, give it back with Free(), a null pointer when the size does not fit the atlas
+		*/
+		PLBERKELIUM_API sAtlasRect *Allocate(const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Keeps a rect for a new size when it still fits, else allocates a new one
+		*
+		*  @remarks
+		*    The content of the current rect is copied to a new one.
+		*
+		*  @param[in] sAtlasRect * psRect
+		*    current rect, can be a null pointer, it is freed when it is not returned
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*
+		*  @return
+		*    the rect for the new size, a null pointer when the size does not fit the atlas
+		*/
+		PLBERKELIUM_API sAtlasRect *Reallocate(sAtlasRect *psRect, const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Gives a rect back to the atlas
+		*
+		*  @remarks
+		*    One static and one frequently painted page without rects are kept for the next rects, further pages without rects
+		*    are destroyed.
+		*
+		*  @param[in] sAtlasRect * psRect
+		*    rect to give back, can be a null pointer
+		*/
+		PLBERKELIUM_API void Free(sAtlasRect *psRect);
+
+		/**
+		*  @brief
+		*    Copies an image into a rect
+		*
+		*  @param[in] sAtlasRect & sRect
+		*  @param[in] const PLCore::uint8 * pImageBuffer
+		*    RGBA image data
+		*  @param[in] const int & nPitch
+		*    width of the image in pixels
+		*  @param[in] const int & nWidth
+		*    width of the part of the image to copy, clipped to the rect
+		*  @param[in] const int & nHeight
+		*    height of the part of the image to copy, clipped to the rect
+		*/
+		PLBERKELIUM_API void CopyToRect(sAtlasRect &sRect, const PLCore::uint8 *pImageBuffer, const int &nPitch, const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Copies a part of an image into the same position in a rect
+		*
+		*  @remarks
+		*    Used for the dirty rects of a paint, the rest of the rect keeps what has been painted before.
+		*
+		*  @param[in] sAtlasRect & sRect
+		*  @param[in] const PLCore::uint8 * pImageBuffer
+		*    RGBA image data
+		*  @param[in] const int & nPitch
+		*    width of the image in pixels
+		*  @param[in] const int & nX
+		*  @param[in] const int & nY
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*    part of the image to copy, clipped to the rect
+		*/
+		PLBERKELIUM_API void CopyRegionToRect(sAtlasRect &sRect, const PLCore::uint8 *pImageBuffer, const int &nPitch, const int &nX, const int &nY, const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Returns the texture buffer of the page of a rect
+		*
+		*  @remarks
+		*    The page is uploaded first when it has changed.
+		*
+		*  @param[in] const sAtlasRect & sRect
+		*
+		*  @return
+		*    the texture buffer, a null pointer on error
+		*/
+		PLBERKELIUM_API PLRenderer::TextureBuffer *GetTextureBuffer(const sAtlasRect &sRect);
+
+		/**
+		*  @brief
+		*    Sets the quad a rect is drawn on when it is batched
+		*
+		*  @param[in] sAtlasRect & sRect
+		*  @param[in] const PLMath::Vector2i & vPosition
+		*    screen position of the quad
+		*  @param[in] const PLMath::Vector2i & vSize
+		*    screen size of the quad
+		*  @param[in] const PLMath::Vector2i & vUsedSize
+		*    part of the rect that is drawn on the quad
+		*  @param[in] const bool & bBatched
+		*    'true' to draw the rect with the batch of its page, is ignored when batching is disabled
+		*/
+		PLBERKELIUM_API void SetQuad(sAtlasRect &sRect, const PLMath::Vector2i &vPosition, const PLMath::Vector2i &vSize, const PLMath::Vector2i &vUsedSize, const bool &bBatched);
+
+		/**
+		*  @brief
+		*    Returns the batch of the page of a rect
+		*
+		*  @remarks
+		*    The batch is a triangle list with the quads of all batched rects of the page, it is returned once per frame.
+		*
+		*  @param[in] const sAtlasRect & sRect
+		*  @param[out] PLCore::uint32 & nVertices
+		*    amount of vertices to draw
+		*
+		*  @return
+		*    the vertex buffer, a null pointer when the batch has already been drawn in this frame or is empty
+		*/
+		PLBERKELIUM_API PLRenderer::VertexBuffer *GetBatch(const sAtlasRect &sRect, PLCore::uint32 &nVertices);
+
+		/**
+		*  @brief
+		*    Starts a new frame, the batches can be drawn again
+		*
+		*  @remarks
+		*    Rects that have been painted in enough of the last frames are moved to the frequently painted pages,
+		*    rects that have not been painted for long enough are moved back.
+		*
+		*  @note
+		*    This is called by Gui on update.
+		*/
+		PLBERKELIUM_API void NextFrame();
+
+		/**
+		*  @brief
+		*    Sets if the windows of a page are drawn with one call
+		*
+		*  @param[in] const bool & bBatching
+		*    'true' to batch, 'false' to draw every window on its own with the page texture (default)
+		*/
+		PLBERKELIUM_API void SetBatching(const bool &bBatching);
+
+		/**
+		*  @brief
+		*    Returns if the windows of a page are drawn with one call
+		*
+		*  @return
+		*    'true' if batching is enabled, else 'false'
+		*/
+		PLBERKELIUM_API bool IsBatching() const;
+
+		/**
+		*  @brief
+		*    Returns the amount of pages
+		*
+		*  @return
+		*    amount of pages
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetNumOfPages() const;
+
+		/**
+		*  @brief
+		*    Returns how much of the pages is used by rects
+		*
+		*  @return
+		*    area of the rects divided by the area of the pages, 0 without pages
+		*/
+		PLBERKELIUM_API float GetUtilisation() const;
+
+		/**
+		*  @brief
+		*    Returns how much of the room the shelves have taken is not used by rects
+		*
+		*  @remarks
+		*    Room is lost to rects that are lower than their shelf and to the holes of rects that have been freed in the middle
+		*    of a shelf until new rects take them, the room at the end of a shelf and below the last shelf is not counted.
+		*
+		*  @return
+		*    0 when the shelves are packed without gaps, up to 1
+		*/
+		PLBERKELIUM_API float GetFragmentation() const;
+
+		/**
+		*  @brief
+		*    Returns how often pages have been uploaded
+		*
+		*  @return
+		*    amount of uploads
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetUploadCount() const;
+
+		/**
+		*  @brief
+		*    Returns how many batches have been drawn
+		*
+		*  @return
+		*    amount of batches
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetBatchCount() const;
+
+		/**
+		*  @brief
+		*    Returns how often rects have been moved between the static and the frequently painted pages
+		*
+		*  @return
+		*    amount of moves
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetMoveCount() const;
+
+	protected:
+
+	private:
+		/**
+		*  @brief
+		*    Allocates a rect in the static or in the frequently painted pages
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*  @param[in] const bool & bHot
+		*
+		*  @return
+		*    the rect, a null pointer when the size does not fit the atlas
+		*/
+		sAtlasRect *AllocateRect(const int &nWidth, const int &nHeight, const bool &bHot);
+
+		/**
+		*  @brief
+		*    Finds room for a rect and takes it
+		*
+		*  @remarks
+		*    Only the position of the rect is set, it is not added to the rects of its page.
+		*
+		*  @param[in] sAtlasRect & sRect
+		*  @param[in] const int & nRectWidth
+		*  @param[in] const int & nRectHeight
+		*    rounded size
+		*  @param[in] const bool & bHot
+		*    'true' to place the rect on a frequently painted page, else on a static page
+		*
+		*  @return
+		*    'true' if all went fine, else 'false' and the rect is left as it is
+		*/
+		bool Place(sAtlasRect &sRect, const int &nRectWidth, const int &nRectHeight, const bool &bHot);
+
+		/**
+		*  @brief
+		*    Gives the room of a rect back to its shelf
+		*
+		*  @remarks
+		*    The rect is not removed from the rects of its page.
+		*
+		*  @param[in] const sAtlasRect & sRect
+		*/
+		void Release(const sAtlasRect &sRect);
+
+		/**
+		*  @brief
+		*    Moves a rect with its content to a static or to a frequently painted page
+		*
+		*  @param[in] sAtlasRect & sRect
+		*  @param[in] const bool & bHot
+		*/
+		void Move(sAtlasRect &sRect, const bool &bHot);
+
+		/**
+		*  @brief
+		*    Returns the smallest hole of a shelf a rect fits in
+		*
+		*  @param[in] const sAtlasShelf & sShelf
+		*  @param[in] const int & nWidth
+		*
+		*  @return
+		*    index of the hole, -1 if none fits
+		*/
+		int FindHole(const sAtlasShelf &sShelf, const int &nWidth) const;
+
+		/**
+		*  @brief
+		*    Adds room to the holes of a shelf, merged with the holes next to it
+		*
+		*  @param[in] sAtlasShelf & sShelf
+		*  @param[in] const int & nX
+		*  @param[in] const int & nWidth
+		*/
+		void AddHole(sAtlasShelf &sShelf, const int &nX, const int &nWidth);
+
+		/**
+		*  @brief
+		*    Copies a part of an image into the same position in a rect
+		*
+		*  @param[in] const sAtlasRect & sRect
+		*  @param[in] const PLCore::uint8 * pImageBuffer
+		*  @param[in] const int & nPitch
+		*  @param[in] const int & nX
+		*  @param[in] const int & nY
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*
+		*  @see
+		*    - CopyRegionToRect()
+		*/
+		void CopyPixels(const sAtlasRect &sRect, const PLCore::uint8 *pImageBuffer, const int &nPitch, const int &nX, const int &nY, const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Creates a page
+		*
+		*  @param[in] const bool & bHot
+		*    'true' for a page of the frequently painted rects
+		*
+		*  @return
+		*    the page, a null pointer on error
+		*/
+		sAtlasPage *CreatePage(const bool &bHot);
+
+		/**
+		*  @brief
+		*    Destroys a page without rects when there is another empty page of its kind
+		*
+		*  @param[in] sAtlasPage * psPage
+		*/
+		void DestroyEmptyPage(sAtlasPage *psPage);
+
+		/**
+		*  @brief
+		*    Destroys a page
+		*
+		*  @param[in] sAtlasPage * psPage
+		*/
+		void DestroyPage(sAtlasPage *psPage);
+
+		/**
+		*  @brief
+		*    Fills the vertex buffer of a page with the quads of its batched rects
+		*
+		*  @param[in] sAtlasPage & sPage
+		*/
+		void UpdateBatch(sAtlasPage &sPage);
+
+		PLRenderer::Renderer *m_pRenderer;
+		PLCore::Array<sAtlasPage*> m_lstPages;
+		bool m_bBatching;
+		PLCore::uint32 m_nFrame;
+		PLCore::uint32 m_nUploadCount;
+		PLCore::uint32 m_nBatchCount;
+		PLCore::uint32 m_nMoveCount;
+
+
+};
+
+
+};
+
+
+#endif // __PLBERKELIUM_TEXTUREATLAS_H__
@@ -0,0 +1,224 @@
+#ifndef __PLBERKELIUM_TEXTUREPOOL_H__
+#define __PLBERKELIUM_TEXTUREPOOL_H__
+#pragma once
+
+
+//[-------------------------------------------------------]
+//[ Includes                                              ]
+//[-------------------------------------------------------]
+#include <PLCore/Container/Array.h>
+#include <PLCore/Container/HashMap.h>
+#include <PLCore/Tools/Timing.h>
+#include <PLGraphics/Image/Image.h>
+#include <PLRenderer/Renderer/Renderer.h>
+#include <PLRenderer/Renderer/TextureBuffer.h>
+#include <PLRenderer/Renderer/VertexBuffer.h>
+
+#include "PLBerkelium.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Defines                                               ]
+//[-------------------------------------------------------]
+#define TEXTUREPOOLGRANULARITY 64
+#define TEXTUREPOOLMAXVERTEXBUFFERS 32
+
+
+//[-------------------------------------------------------]
+//[ Structures                                            ]
+//[-------------------------------------------------------]
+struct sPooledTexture
+{
+	PLRenderer::TextureBuffer *pTextureBuffer;		/**< Owned by the pool while it is pooled */
+	PLCore::uint32 nSize;							/**< Size in bytes */
+	PLCore::uint64 nReleaseTime;					/**< Time in milliseconds the texture has been given back */
+};
+
+
+//[-------------------------------------------------------]
+//[ Classes                                               ]
+//[-------------------------------------------------------]
+/**
+*  @brief
+*    Pool of the textures and quads that windows, widgets and tool tips draw with
+*
+*  @remarks
+*    Widgets like select dropdowns come and go all the time, instead of destroying their textures and quads
+*    they are given back to the pool and handed out again to the next one. Textures are pooled by size class,
+*    a size that is asked for is rounded up to the next multiple of TEXTUREPOOLGRANULARITY in both directions.
+*    The memory of the pooled textures is capped, when it is exceeded the textures that have been pooled the longest are destroyed first.
+*/
+class TexturePool {
+
+
+	public:
+		PLBERKELIUM_API TexturePool(PLRenderer::Renderer &cRenderer);
+		PLBERKELIUM_API ~TexturePool();
+
+		/**
+		*  @brief
+		*    Returns the size class of a width or height
+		*
+		*  @param[in] const int & nSize
+		*
+		*  @return
+		*    the size rounded up to the next multiple of TEXTUREPOOLGRANULARITY
+		*/
+		PLBERKELIUM_API static int GetSizeClass(const int &nSize);
+
+		/**
+		*  @brief
+		*    Returns a texture buffer for an image
+		*
+		*  @remarks
+		*    A pooled texture of the size of the image is filled with the image, otherwise a new one is created from it.
+		*    Create the image with a size class (see GetSizeClass()) so that the texture can be pooled.
+		*
+		*  @param[in] const PLGraphics::Image & cImage
+		*
+		*  @return
+		*    the texture buffer, give it back with ReleaseTextureBuffer() instead of destroying it, a null pointer on error
+		*/
+		PLBERKELIUM_API PLRenderer::TextureBuffer *GetTextureBuffer(const PLGraphics::Image &cImage);
+
+		/**
+		*  @brief
+		*    Gives a texture buffer back to the pool
+		*
+		*  @param[in] PLRenderer::TextureBuffer * pTextureBuffer
+		*    texture buffer to give back, can be a null pointer
+		*  @param[in] const int & nWidth
+		*    width of the texture buffer
+		*  @param[in] const int & nHeight
+		*    height of the texture buffer
+		*/
+		PLBERKELIUM_API void ReleaseTextureBuffer(PLRenderer::TextureBuffer *pTextureBuffer, const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Returns a pooled vertex buffer
+		*
+		*  @remarks
+		*    The vertex buffers are the quads of SRPWindow, 4 vertices with a position and a texture coordinate.
+		*
+		*  @return
+		*    the vertex buffer, a null pointer when none is pooled
+		*/
+		PLBERKELIUM_API PLRenderer::VertexBuffer *GetVertexBuffer();
+
+		/**
+		*  @brief
+		*    Gives a vertex buffer back to the pool
+		*
+		*  @param[in] PLRenderer::VertexBuffer * pVertexBuffer
+		*    vertex buffer to give back, can be a null pointer
+		*/
+		PLBERKELIUM_API void ReleaseVertexBuffer(PLRenderer::VertexBuffer *pVertexBuffer);
+
+		/**
+		*  @brief
+		*    Sets the maximum memory of the pooled textures
+		*
+		*  @param[in] const PLCore::uint64 & nBytes
+		*    memory in bytes (default 64 MB), 0 pools nothing
+		*/
+		PLBERKELIUM_API void SetMemoryLimit(const PLCore::uint64 &nBytes);
+
+		/**
+		*  @brief
+		*    Returns the memory of the pooled textures
+		*
+		*  @return
+		*    memory in bytes, textures that are in use are not counted
+		*/
+		PLBERKELIUM_API PLCore::uint64 GetPooledMemory() const;
+
+		/**
+		*  @brief
+		*    Sets after how long a pooled texture is destroyed by Trim()
+		*
+		*  @param[in] const PLCore::uint64 & nTime
+		*    time in milliseconds (default 10000), 0 keeps the textures until the memory limit is reached
+		*/
+		PLBERKELIUM_API void SetTrimTime(const PLCore::uint64 &nTime);
+
+		/**
+		*  @brief
+		*    Destroys the textures that have not been used for the trim time
+		*
+		*  @note
+		*    This is called by Gui on update, see SetTrimTime().
+		*/
+		PLBERKELIUM_API void Trim();
+
+		/**
+		*  @brief
+		*    Destroys all pooled textures and vertex buffers
+		*/
+		PLBERKELIUM_API void Clear();
+
+		/**
+		*  @brief
+		*    Returns how many textures the pool had to create
+		*
+		*  @return
+		*    amount of created textures
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetCreatedTextureCount() const;
+
+		/**
+		*  @brief
+		*    Returns how many textures have been handed out again
+		*
+		*  @return
+		*    amount of reused textures
+		*/
+		PLBERKELIUM_API PLCore::uint32 GetReusedTextureCount() const;
+
+	protected:
+
+	private:
+		/**
+		*  @brief
+		*    Returns the key of the bucket of a size
+		*
+		*  @param[in] const int & nWidth
+		*  @param[in] const int & nHeight
+		*
+		*  @return
+		*    the key
+		*/
+		static PLCore::uint32 GetKey(const int &nWidth, const int &nHeight);
+
+		/**
+		*  @brief
+		*    Destroys the texture that has been pooled the longest
+		*
+		*  @return
+		*    'true' if a texture has been destroyed, else 'false' (nothing is pooled)
+		*/
+		bool DestroyOldestTexture();
+
+		PLRenderer::Renderer *m_pRenderer;
+		PLCore::HashMap<PLCore::uint32, PLCore::Array<sPooledTexture*>*> *m_pmapTextures;
+		PLCore::Array<PLRenderer::VertexBuffer*> m_lstVertexBuffers;
+		PLCore::uint64 m_nMemoryLimit;
+		PLCore::uint64 m_nPooledMemory;
+		PLCore::uint64 m_nTrimTime;
+		PLCore::uint32 m_nCreatedTextureCount;
+		PLCore::uint32 m_nReusedTextureCount;
+
+
+};
+
+
+};
+
+
+#endif // __PLBERKELIUM_TEXTUREPOOL_H__
@@ -11,11 +11,13 @@
 static const PLCore::String sBerkeliumVertexShaderSourceCodeGLSL = STRINGIFY(
 // Attributes
 attribute highp vec2 VertexPosition;	// Object space vertex position input
-attribute lowp  vec2 VertexTexCoord;	// Vertex texture coordinate input
-varying   lowp  vec2 VertexTexCoordVS;	// Vertex texture coordinate output
+attribute highp vec2 VertexTexCoord;	// Vertex texture coordinate input, an atlas page needs more than lowp
+varying   highp vec2 VertexTexCoordVS;	// Vertex texture coordinate output
 
 // Uniforms
 uniform highp mat4 ObjectSpaceToClipSpaceMatrix;	// Object space to clip space matrix
+uniform highp vec2 TextureCoordinateScale;			// Used part of the texture, the texture can be bigger than what is drawn
+uniform highp vec2 TextureCoordinateOffset;			// Start of the used part of the texture, not 0 in an atlas page
 
 // Programs
 void main()
@@ -26,8 +28,8 @@ void main()
 	// In case you want to have a fullscreen quad in here, replace the line above by
 //	gl_Position = vec4(VertexPosition, 1);
 
-	// Pass through the vertex texture coordinate
-	VertexTexCoordVS = VertexTexCoord;
+	// Scale the vertex texture coordinate to the used part of the texture
+	VertexTexCoordVS = TextureCoordinateOffset + VertexTexCoord*TextureCoordinateScale;
 }
 );	// STRINGIFY
 
@@ -38,16 +40,17 @@ void main()
 // GLSL (OpenGL 2.0 ("#version 110") and OpenGL ES 2.0 ("#version 100")) fragment shader source code, "#version" is added by hand
 static const PLCore::String sBerkeliumFragmentShaderSourceCodeGLSL = STRINGIFY(
 // Attributes
-varying lowp vec2 VertexTexCoordVS;	// Interpolated vertex texture coordinate input from vertex shader
+varying highp vec2 VertexTexCoordVS;	// Interpolated vertex texture coordinate input from vertex shader
 
 // Uniforms
 uniform lowp sampler2D TextureMap;	// Texture map
+uniform lowp vec4 ColorFactor;		// Color factor, used to gray out unresponsive windows
 
 // Programs
 void main()
 {
 	// Fragment color = fetched interpolated texel color
-	gl_FragColor = texture2D(TextureMap, VertexTexCoordVS).bgra; // thanks to Phosfor
+	gl_FragColor = texture2D(TextureMap, VertexTexCoordVS).bgra*ColorFactor; // thanks to Phosfor
 	// i know it says BGRA it seems to be working only this way
 }
 );	// STRINGIFY
@@ -0,0 +1,247 @@
+//[-------------------------------------------------------]
+//[ Header                                                ]
+//[-------------------------------------------------------]
+#include <PLCore/Base/Func/Functor.h>
+
+#include "PLBerkelium/ScriptParams.h"
+#include "PLBerkelium/SRPWindow.h"
+#include "PLBerkelium/Gui.h"
+#include "PLBerkelium/Benchmark.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Internal helpers                                      ]
+//[-------------------------------------------------------]
+namespace {
+
+	/**
+	*  @brief
+	*    Sample callback functions, a typical numeric and a typical text callback
+	*/
+	int SampleAdd(int nA, int nB)
+	{
+		return nA + nB;
+	}
+
+	String SampleLabel(String sText, double dValue)
+	{
+		return sText + String(dValue);
+	}
+
+	/**
+	*  @brief
+	*    Sample record of a bulk transfer
+	*/
+	struct sSampleRecord
+	{
+		uint32 nId;
+		float fX;
+		float fY;
+		uint32 nFlags;
+	};
+
+	/**
+	*  @brief
+	*    Returns the javascript that passes records to the page as JSON literal
+	*/
+	String GetJSONJavascript(const sSampleRecord *psRecords, uint32 nRecords)
+	{
+		// one string per record like any caller would create, joined in one buffer so that the join is not what is measured
+		Array<String> lstRecords;
+		lstRecords.Resize(nRecords);
+		uint32 nLength = 0;
+		for (uint32 i = 0; i < nRecords; i++)
+		{
+			const sSampleRecord &sRecord = psRecords[i];
+			lstRecords[i] = String::Format("%s{\"id\":%u,\"x\":%g,\"y\":%g,\"flags\":%u}", i ? "," : "", sRecord.nId, sRecord.fX, sRecord.fY, sRecord.nFlags);
+			nLength += lstRecords[i].GetLength();
+		}
+
+		static const String sBegin = "native.onrecords([";
+		static const String sEnd = "]);";
+		nLength += sBegin.GetLength() + sEnd.GetLength();
+		char *pszJavascript = new char[nLength + 1];
+		char *pszPosition = pszJavascript;
+		MemoryManager::Copy(pszPosition, sBegin.GetASCII(), sBegin.GetLength());
+		pszPosition += sBegin.GetLength();
+		for (uint32 i = 0; i < nRecords; i++)
+		{
+			MemoryManager::Copy(pszPosition, lstRecords[i].GetASCII(), lstRecords[i].GetLength());
+			pszPosition += lstRecords[i].GetLength();
+		}
+		MemoryManager::Copy(pszPosition, sEnd.GetASCII(), sEnd.GetLength());
+		pszPosition += sEnd.GetLength();
+		*pszPosition = '\0';
+
+		const String sJavascript(pszJavascript, true, int(nLength));
+		delete [] pszJavascript;
+		return sJavascript;
+	}
+
+}
+
+
+//[-------------------------------------------------------]
+//[ Functions                                             ]
+//[-------------------------------------------------------]
+void Benchmark::Run(const uint32 &nRuns)
+{
+	// the same arguments javascript would send for native.call('add', 1, 2)
+	Functor<int, int, int> cAdd(&SampleAdd);
+	const Berkelium::Script::Variant cAddArgs[2] = { Berkelium::Script::Variant(1.0), Berkelium::Script::Variant(2.0) };
+	Print("CallBack int(int, int)", CallBack(cAdd, cAddArgs, 2, nRuns));
+
+	// the same arguments javascript would send for native.call('label', 'say "hello" to', 42.5)
+	Functor<String, String, double> cLabel(&SampleLabel);
+	const Berkelium::Script::Variant cLabelArgs[2] = { Berkelium::Script::Variant(Berkelium::WideString::point_to(L"say \"hello\" to")), Berkelium::Script::Variant(42.5) };
+	Print("CallBack String(String, double)", CallBack(cLabel, cLabelArgs, 2, nRuns));
+
+	// the case the bulk transfer was made for
+	Print("BinaryTransfer " + String(BENCHMARKDEFAULTRECORDS) + " records", BinaryTransfer());
+}
+
+
+sBenchmarkResult Benchmark::CallBack(DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, const uint32 &nRuns)
+{
+	sBenchmarkResult sResult;
+	sResult.nRuns = nRuns;
+	sResult.nTime = 0;
+	sResult.nBaselineTime = 0;
+	sResult.nSize = 0;
+	sResult.nBaselineSize = 0;
+	String sReturn;
+
+	// typed path, exactly what SRPWindow does for a typed callback
+	if (ScriptParams::IsSupported(cDynFunc))
+	{
+		const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+		for (uint32 i = 0; i < nRuns; i++)
+			ScriptParams::Call(cDynFunc, pArgs, nNumArgs, &sReturn);
+		sResult.nTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+	}
+
+	// string path, exactly what SRPWindow does for a callback that is not typed
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+	for (uint32 i = 0; i < nRuns; i++)
+		ScriptParams::CallWithParameterString(cDynFunc, ScriptParams::ToParameterString(pArgs, nNumArgs), &sReturn);
+	sResult.nBaselineTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+
+	return sResult;
+}
+
+
+sBenchmarkResult Benchmark::BinaryTransfer(const uint32 &nRecords, const uint32 &nRuns)
+{
+	sBenchmarkResult sResult;
+	sResult.nRuns = nRuns;
+	sResult.nTime = 0;
+	sResult.nBaselineTime = 0;
+	sResult.nSize = 0;
+	sResult.nBaselineSize = 0;
+
+	sSampleRecord *psRecords = new sSampleRecord[nRecords];
+	for (uint32 i = 0; i < nRecords; i++)
+	{
+		psRecords[i].nId = i;
+		psRecords[i].fX = float(i) * 0.5f;
+		psRecords[i].fY = float(i) * 0.25f;
+		psRecords[i].nFlags = i % 7;
+	}
+
+	// blob, exactly what SRPWindow::SendBinary() builds
+	uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+	for (uint32 i = 0; i < nRuns; i++)
+	{
+		const String sJavascript = SRPWindow::GetBinaryJavascript("records", reinterpret_cast<const uint8*>(psRecords), nRecords * sizeof(sSampleRecord));
+		sResult.nSize = sJavascript.GetLength();
+	}
+	sResult.nTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+
+	// JSON literal of the same records
+	nStartTime = System::GetInstance()->GetMicroseconds();
+	for (uint32 i = 0; i < nRuns; i++)
+	{
+		const String sJavascript = GetJSONJavascript(psRecords, nRecords);
+		sResult.nBaselineSize = sJavascript.GetLength();
+	}
+	sResult.nBaselineTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+
+	delete [] psRecords;
+	return sResult;
+}
+
+
+bool Benchmark::WindowCreation(Gui &cGui, sWindowBenchmarkResult &sResult, const uint32 &nWindows, const String &sUrl)
+{
+	if (!cGui.GetWindowsMap()->Get(String(BENCHMARKWINDOWNAME "0")))
+	{
+		// first call, the windows are requested one after the other like an application opening its windows
+		for (uint32 i = 0; i < nWindows; i++)
+		{
+			const String sName = BENCHMARKWINDOWNAME + String(i);
+			cGui.AddWindow(sName, true, sUrl, 256, 256, int(i) * 16, int(i) * 16);
+			cGui.GetBerkeliumWindow(sName);
+		}
+		return false;
+	}
+
+	sResult.nWindows = nWindows;
+	sResult.nCreateTime = 0;
+	sResult.nFirstPaintLatency = 0;
+	sResult.nFirstCallBackLatency = 0;
+	for (uint32 i = 0; i < nWindows; i++)
+	{
+		const SRPWindow *pSRPWindow = cGui.GetWindowsMap()->Get(BENCHMARKWINDOWNAME + String(i));
+		if (!pSRPWindow || !pSRPWindow->GetFirstPaintLatency() || !pSRPWindow->GetFirstCallBackLatency())
+		{
+			// still waiting for this window
+			return false;
+		}
+		sResult.nCreateTime += pSRPWindow->GetCreateTime();
+		sResult.nFirstPaintLatency += pSRPWindow->GetFirstPaintLatency();
+		sResult.nFirstCallBackLatency += pSRPWindow->GetFirstCallBackLatency();
+	}
+	if (nWindows > 0)
+	{
+		sResult.nCreateTime /= nWindows;
+		sResult.nFirstPaintLatency /= nWindows;
+		sResult.nFirstCallBackLatency /= nWindows;
+	}
+
+	// done, the windows were only created for the benchmark
+	for (uint32 i = 0; i < nWindows; i++)
+	{
+		cGui.RemoveWindow(BENCHMARKWINDOWNAME + String(i));
+	}
+	return true;
+}
+
+
+void Benchmark::Print(const String &sName, const sBenchmarkResult &sResult)
+{
+	String sString = sName + ": " + String(sResult.nRuns) + " runs, " + String(sResult.nTime) + " us against " + String(sResult.nBaselineTime) + " us";
+	if (sResult.nTime > 0)
+		sString += String::Format(" (x%.2f)", double(sResult.nBaselineTime) / double(sResult.nTime));
+	if (sResult.nSize > 0 || sResult.nBaselineSize > 0)
+		sString = sString + ", " + String(sResult.nSize) + " bytes against " + String(sResult.nBaselineSize) + " bytes";
+	System::GetInstance()->GetConsole().Print("PLBerkelium::Benchmark - " + sString + '\n');
+}
+
+
+void Benchmark::Print(const String &sName, const sWindowBenchmarkResult &sResult)
+{
+	const String sString = sName + ": " + String(sResult.nWindows) + " windows, create " + String(sResult.nCreateTime) + " us, first paint " +
+		String(sResult.nFirstPaintLatency) + " us, first interaction " + String(sResult.nFirstCallBackLatency) + " us";
+	System::GetInstance()->GetConsole().Print("PLBerkelium::Benchmark - " + sString + '\n');
+}
+
+
+};
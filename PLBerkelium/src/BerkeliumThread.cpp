@@ -0,0 +1,234 @@
+//[-------------------------------------------------------]
+//[ Header                                                ]
+//[-------------------------------------------------------]
+#include "PLBerkelium/BerkeliumThread.h"
+#include "PLBerkelium/SRPWindow.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Functions		                                      ]
+//[-------------------------------------------------------]
+BerkeliumThread::BerkeliumThread() :
+	m_cCommandQueue(),
+	m_cCommandSignal(0, 1),
+	m_bInitializing(true),
+	m_bBerkeliumInitialized(false),
+	m_bStopRequested(false),
+	m_nPushedCommands(0),
+	m_nExecutedCommands(0)
+{
+}
+
+
+BerkeliumThread::~BerkeliumThread()
+{
+	// cleanup the commands that were never executed
+	sBrowserCommand *psCommand = nullptr;
+	while (m_cCommandQueue.Pop(psCommand))
+	{
+		delete psCommand;
+	}
+}
+
+
+bool BerkeliumThread::WaitForInitialization() const
+{
+	while (m_bInitializing)
+	{
+		System::GetInstance()->Sleep(1);
+	}
+	return m_bBerkeliumInitialized;
+}
+
+
+bool BerkeliumThread::IsCurrentThread() const
+{
+	return (System::GetInstance()->GetCurrentThread() == this);
+}
+
+
+void BerkeliumThread::PushCommand(sBrowserCommand *psCommand)
+{
+	// count first so that Flush() never misses a command
+	m_nPushedCommands++;
+	m_cCommandQueue.Push(psCommand);
+
+	// wake the thread up in case it is idle, there is at most one pending signal
+	m_cCommandSignal.Unlock();
+}
+
+
+uint32 BerkeliumThread::GetNumOfPushedCommands() const
+{
+	return m_nPushedCommands;
+}
+
+
+bool BerkeliumThread::IsExecuted(const uint32 &nPushedCommands) const
+{
+	// the difference keeps working when the counters wrap around, a thread that is not running does not execute anything
+	return (int(m_nExecutedCommands - nPushedCommands) >= 0 || !m_bBerkeliumInitialized || !IsActive());
+}
+
+
+uint32 BerkeliumThread::GetNumOfExecutedCommands() const
+{
+	return m_nExecutedCommands;
+}
+
+
+void BerkeliumThread::Flush() const
+{
+	// a thread that is not running does not execute anything
+	while (m_nExecutedCommands != m_nPushedCommands && m_bBerkeliumInitialized && IsActive())
+	{
+		System::GetInstance()->Sleep(1);
+	}
+}
+
+
+void BerkeliumThread::Stop()
+{
+	m_bStopRequested = true;
+	m_cCommandSignal.Unlock();
+	Join();
+}
+
+
+int BerkeliumThread::Run()
+{
+	// berkelium is bound to the thread that initializes it
+	m_bBerkeliumInitialized = Berkelium::init(Berkelium::FileString::empty());
+	m_bInitializing = false;
+	if (!m_bBerkeliumInitialized)
+	{
+		return -1;
+	}
+
+	while (!m_bStopRequested)
+	{
+		// execute the commands first so that berkelium handles them within this update
+		const bool bIdle = !ProcessCommands();
+		Berkelium::update();
+		if (bIdle && m_cCommandQueue.IsEmpty() && !m_bStopRequested)
+		{
+			// we do not want to keep a core busy, but a command must not wait for the timeout
+			m_cCommandSignal.TryLock(BERKELIUMTHREADIDLETIME);
+		}
+	}
+
+	// execute what is left, this is where the last windows get destroyed
+	ProcessCommands();
+	Berkelium::stopRunning();
+	return 0;
+}
+
+
+bool BerkeliumThread::ProcessCommands()
+{
+	bool bExecuted = false;
+	sBrowserCommand *psCommand = nullptr;
+	while (m_cCommandQueue.Pop(psCommand))
+	{
+		ExecuteCommand(psCommand);
+		delete psCommand;
+		m_nExecutedCommands++;
+		bExecuted = true;
+	}
+	return bExecuted;
+}
+
+
+void BerkeliumThread::ExecuteCommand(const sBrowserCommand *psCommand)
+{
+	// we are on the berkelium thread, so the window calls berkelium directly
+	SRPWindow *pSRPWindow = psCommand->pSRPWindow;
+	switch (psCommand->nType)
+	{
+		case sBrowserCommand::CommandCreate:
+			pSRPWindow->CreateBerkeliumWindowInstance(static_cast<const sBootstrapScript*>(psCommand->pParam));
+			break;
+
+		case sBrowserCommand::CommandDestroy:
+			pSRPWindow->DestroyBerkeliumWindow();
+			break;
+
+		case sBrowserCommand::CommandDestroyContext:
+			pSRPWindow->DestroyContext();
+			break;
+
+		case sBrowserCommand::CommandBind:
+			pSRPWindow->BindCallBackFunction(uint32(psCommand->nParam[1]), psCommand->sParam[0], psCommand->sParam[1], psCommand->nParam[0] != 0);
+			break;
+
+		case sBrowserCommand::CommandEvalOnStartLoading:
+			pSRPWindow->AddStartLoadingScript(psCommand->sParam[0]);
+			break;
+
+		case sBrowserCommand::CommandSettings:
+			pSRPWindow->SetWindowSettings(psCommand->nParam[0], psCommand->nParam[1], psCommand->nParam[2] != 0, psCommand->sParam[0]);
+			break;
+
+		case sBrowserCommand::CommandNavigate:
+			pSRPWindow->SendNavigateTo(psCommand->sParam[0]);
+			break;
+
+		case sBrowserCommand::CommandResize:
+			pSRPWindow->SendResize(psCommand->nParam[0], psCommand->nParam[1]);
+			break;
+
+		case sBrowserCommand::CommandJavascript:
+			pSRPWindow->ExecuteJavascript(psCommand->sParam[0]);
+			break;
+
+		case sBrowserCommand::CommandMouseMove:
+			pSRPWindow->SendMouseMove(psCommand->nParam[0], psCommand->nParam[1]);
+			break;
+
+		case sBrowserCommand::CommandMouseButton:
+			pSRPWindow->SendMouseButton(uint32(psCommand->nParam[0]), psCommand->nParam[1] != 0, psCommand->nParam[2]);
+			break;
+
+		case sBrowserCommand::CommandMouseWheel:
+			pSRPWindow->SendMouseWheel(psCommand->nParam[0], psCommand->nParam[1]);
+			break;
+
+		case sBrowserCommand::CommandText:
+			pSRPWindow->SendText(psCommand->sParam[0]);
+			break;
+
+		case sBrowserCommand::CommandKey:
+			pSRPWindow->SendKey(psCommand->nParam[0] != 0, psCommand->nParam[1], psCommand->nParam[2], psCommand->nParam[3]);
+			break;
+
+		case sBrowserCommand::CommandFocus:
+			pSRPWindow->SendFocus();
+			break;
+
+		case sBrowserCommand::CommandUnfocus:
+			pSRPWindow->SendUnfocus();
+			break;
+
+		case sBrowserCommand::CommandScriptReturn:
+			pSRPWindow->SendScriptReturn(psCommand->pParam, psCommand->sParam[0]);
+			break;
+
+		case sBrowserCommand::CommandReload:
+			pSRPWindow->SendReload();
+			break;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // PLBerkelium
@@ -26,12 +26,13 @@ pl_implement_class(Gui)
 //[-------------------------------------------------------]
 //[ Functions		                                      ]
 //[-------------------------------------------------------]
-Gui::Gui() :
+Gui::Gui(const bool &bThreaded) :
 	SlotOnUpdate(this),
 	SlotOnControl(this),
 	m_bBerkeliumInitialized(false),
 	m_bRenderersInitialized(false),
 	m_pmapWindows(new HashMap<String, SRPWindow*>),
+	m_pDummyWindow(nullptr),
 	m_pCurrentSceneRenderer(nullptr),
 	m_pCurrentRenderer(nullptr),
 	m_pSRPMousePointer(nullptr),
@@ -39,6 +40,7 @@ Gui::Gui() :
 	m_bControlsEnabled(true),
 	m_bIsUpdateConnected(false),
 	m_bIsControllerConnected(false),
+	m_pmapControlActions(new HashMap<Control*, uint32>),
 	m_sLastControl(""),
 	m_nLastMouseLeftReleaseTime(0),
 	m_pLastMouseWindow(nullptr),
@@ -46,15 +48,48 @@ Gui::Gui() :
 	m_vLastKnownMousePos(Vector2i::Zero),
 	m_pDragWindow(nullptr),
 	m_pResizeWindow(nullptr),
+	m_plstDefaultCallBackEvents(new List<sDefaultCallBackEvent*>),
+	m_plstResizePreviewWindows(new List<SRPWindow*>),
 	m_bMouseMoved(false),
 	m_vLockMousePos(Vector2i::Zero),
-	m_pmapTextButtonHandler(new HashMap<String, sButton*>),
-	m_pmapKeyButtonHandler(new HashMap<String, sButton*>),
-	m_nLastTextKeySendTime(0),
-	m_nLastKeySendTime(0),
-	m_nTextKeyHitCount(0),
-	m_nKeyHitCount(0)
+	m_nNumOfKeyStates(0),
+	m_psRepeatKeyState(nullptr),
+	m_nKeyRepeatDelay(400),
+	m_nKeyRepeatRate(50),
+	m_nPumpMode(PumpOnce),
+	m_nPumpBudget(2000),
+	m_nPumpMaxCount(8),
+	m_nPumpTime(0),
+	m_nPumpCount(0),
+	m_nLastPumpTime(0),
+	m_nLastPumpCount(0),
+	m_nLastIdlePumpTime(0),
+	m_bInputPending(false),
+	m_lstBootstrapScriptNames(),
+	m_lstBootstrapScriptSources(),
+	m_lstBootstrapScripts(),
+	m_nBootstrapBuildCount(0),
+	m_lstHitTestWindows(),
+	m_nHitTestZOrderRevision(0),
+	m_bHitTestDirty(true),
+	m_lstInputEvents(),
+	m_lstFreeInputEvents(),
+	m_nCoalescedInputCount(0),
+	m_pBerkeliumThread(bThreaded ? new BerkeliumThread : nullptr),
+	m_pTexturePool(nullptr),
+	m_pTextureAtlas(nullptr),
+	m_bTextureAtlasEnabled(true)
 {
+	// no key has been pressed yet
+	for (uint32 i = 0; i < MAXKEYSTATES; i++)
+	{
+		m_sKeyStates[i].bDown = false;
+		m_sKeyStates[i].bText = false;
+		m_sKeyStates[i].nKeyCode = 0;
+		m_sKeyStates[i].nNextRepeatTime = 0;
+	}
+	// the windows share one pre-built bootstrap script
+	BuildBootstrapScript();
 	// initialize everything need to run berkelium
 	Initialize();
 }
@@ -64,14 +99,36 @@ Gui::~Gui()
 {
 	// we should destroy all windows
 	DestroyWindows();
+	// we should destroy the dummy window
+	DestroyDummyWindow();
 	// we should destroy the mouse pointer
 	DestroyMousePointer();
+	// the windows have given their textures and atlas rects back, we can destroy them now
+	if (m_pTextureAtlas)
+	{
+		delete m_pTextureAtlas;
+	}
+	if (m_pTexturePool)
+	{
+		delete m_pTexturePool;
+	}
 	// we should stop berkelium from doing anything else
 	StopBerkelium();
 	// cleanup
+	RemoveInputEvents(nullptr);
+	for (uint32 i = 0; i < m_lstFreeInputEvents.GetNumOfElements(); i++)
+	{
+		delete m_lstFreeInputEvents[i];
+	}
+	for (uint32 i = 0; i < m_lstBootstrapScripts.GetNumOfElements(); i++)
+	{
+		delete [] m_lstBootstrapScripts[i]->pszScript;
+		delete m_lstBootstrapScripts[i];
+	}
 	delete m_pmapWindows;
-	delete m_pmapTextButtonHandler;
-	delete m_pmapKeyButtonHandler;
+	delete m_pmapControlActions;
+	delete m_plstDefaultCallBackEvents;
+	delete m_plstResizePreviewWindows;
 }
 
 
@@ -84,9 +141,9 @@ void Gui::DebugToConsole(const String &sString)
 
 bool Gui::AddWindow(const String &sName, const bool &pVisible, const String &sUrl, const int &nWidth, const int &nHeight, const int &nX, const int &nY, const bool &bTransparent, const bool &bEnabled)
 {
-	if (sName == "")
+	if (sName == "" || sName == BERKELIUMDUMMYWINDOW)
 	{
-		// we cannot create a window with an empty name
+		// we cannot create a window with an empty name or the name reserved for the dummy window
 		return false;
 	}
 	if (m_bBerkeliumInitialized)
@@ -119,6 +176,21 @@ bool Gui::AddWindow(const String &sName, const bool &pVisible, const String &sUr
 		pSRPWindow->GetData()->bNeedsFullUpdate = true;
 		pSRPWindow->GetData()->bLoaded = false;
 
+		// the window needs to know the berkelium thread before it creates a berkelium window
+		pSRPWindow->SetBerkeliumThread(m_pBerkeliumThread);
+		// the window takes its textures from the pool shared by all windows
+		pSRPWindow->SetTexturePool(m_pTexturePool);
+		// small windows and widgets are drawn from the atlas when it is enabled
+		pSRPWindow->SetTextureAtlas(m_bTextureAtlasEnabled ? m_pTextureAtlas : nullptr);
+		// the window reports its default callbacks to us
+		pSRPWindow->SetDefaultCallBackQueue(m_plstDefaultCallBackEvents);
+		// the window reports its resize previews to us
+		pSRPWindow->SetResizePreviewQueue(m_plstResizePreviewWindows);
+		// the new window has to be sorted into the hit test order
+		m_bHitTestDirty = true;
+		// every page of the window is bootstrapped with our pre-built script
+		pSRPWindow->SetBootstrapScript(&GetBootstrapScript());
+
 		// we initialize the window
 		if (pSRPWindow->Initialize(m_pCurrentRenderer, Vector2(float(nX), float(nY)), Vector2(float(nWidth), float(nHeight))))
 		{
@@ -148,6 +220,11 @@ bool Gui::AddWindow(const String &sName, const bool &pVisible, const String &sUr
 
 void Gui::DestroyWindows()
 {
+	// the events point to the windows
+	RemoveDefaultCallBackEvents(nullptr);
+	RemoveInputEvents(nullptr);
+	m_plstResizePreviewWindows->Clear();
+
 	if (m_bBerkeliumInitialized)
 	{
 		// get the iterator for all the windows created
@@ -163,17 +240,27 @@ void Gui::DestroyWindows()
 		}
 		// clear the hashmap
 		m_pmapWindows->Clear();
+		m_lstHitTestWindows.Reset();
 	}
 }
 
 
 void Gui::Initialize()
 {
-	// we try to initialize berkelium
-	m_bBerkeliumInitialized = Berkelium::init(Berkelium::FileString::empty());
+	if (m_pBerkeliumThread)
+	{
+		// berkelium is initialized by its own thread
+		m_bBerkeliumInitialized = m_pBerkeliumThread->Start() && m_pBerkeliumThread->WaitForInitialization();
+	}
+	else
+	{
+		// we try to initialize berkelium
+		m_bBerkeliumInitialized = Berkelium::init(Berkelium::FileString::empty());
+	}
 	if (m_bBerkeliumInitialized)
 	{
 		// we need to have a dummy window that returns from certain methods
+		// it has no berkelium window behind it, berkelium windows are only created when a window is shown or navigated
 		AddDummyWindow();
 	}
 	else
@@ -183,9 +270,16 @@ void Gui::Initialize()
 }
 
 
-void Gui::StopBerkelium() const
+void Gui::StopBerkelium()
 {
-	if (m_bBerkeliumInitialized)
+	if (m_pBerkeliumThread)
+	{
+		// the thread stops berkelium itself
+		m_pBerkeliumThread->Stop();
+		delete m_pBerkeliumThread;
+		m_pBerkeliumThread = nullptr;
+	}
+	else if (m_bBerkeliumInitialized)
 	{
 		// stop berkelium from running
 		Berkelium::stopRunning();
@@ -193,26 +287,253 @@ void Gui::StopBerkelium() const
 }
 
 
+bool Gui::IsBerkeliumThreaded() const
+{
+	return (m_pBerkeliumThread != nullptr);
+}
+
+
 Berkelium::Window *Gui::GetBerkeliumWindow(const PLCore::String &sName)
 {
-	if (m_pmapWindows->Get(sName) == NULL)
+	// return the berkelium window, the dummy window has none so this can be a nullptr
+	return GetWindow(sName)->GetBerkeliumWindow();
+}
+
+
+void Gui::UpdateBerkelium()
+{
+	// the input of this frame goes to berkelium right before it updates
+	FlushInputEvents();
+
+	if (m_pBerkeliumThread)
 	{
-		// we should return the berkelium window from the dummy window to prevent crashes on called functions
-		// the end user should always verify that the returned object is the right one
-		return m_pmapWindows->Get(BERKELIUMDUMMYWINDOW)->GetBerkeliumWindow();
+		// berkelium updates on its own thread
+		return;
+	}
+
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+
+	// update berkelium
+	Berkelium::update();
+
+	// keep track of the time spent in berkelium for this frame
+	m_nPumpTime += System::GetInstance()->GetMicroseconds() - nStartTime;
+	m_nPumpCount++;
+}
+
+
+void Gui::PumpBerkelium()
+{
+	// the pump statistics of the previous frame are complete now
+	m_nLastPumpTime = m_nPumpTime;
+	m_nLastPumpCount = m_nPumpCount;
+	m_nPumpTime = 0;
+	m_nPumpCount = 0;
+
+	// the input of this frame goes to berkelium right before it updates, also when the update is skipped
+	FlushInputEvents();
+
+	if (m_pBerkeliumThread)
+	{
+		// berkelium updates on its own thread, we only process what it has send to the windows
+		Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+		while (cIterator.HasNext())
+		{
+			cIterator.Next()->ProcessBrowserEvents();
+		}
+		return;
+	}
+
+	if ((m_nPumpMode & PumpIdle) && AreAllWindowsIdle())
+	{
+		// nothing to see or load, but we still update once in a while so berkelium keeps processing its messages
+		if ((Timing::GetInstance()->GetPastTime() - m_nLastIdlePumpTime) < BERKELIUMIDLEPUMPINTERVAL)
+		{
+			return;
+		}
+		m_nLastIdlePumpTime = Timing::GetInstance()->GetPastTime();
+	}
+
+	if (m_nPumpMode & PumpBudget)
+	{
+		// update berkelium until the time slice or the maximum amount of updates is used up
+		const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+		do
+		{
+			UpdateBerkelium();
+		}
+		while (m_nPumpCount < m_nPumpMaxCount && (System::GetInstance()->GetMicroseconds() - nStartTime) < m_nPumpBudget);
 	}
 	else
 	{
-		// return the berkelium window
-		return m_pmapWindows->Get(sName)->GetBerkeliumWindow();
+		// update berkelium once
+		UpdateBerkelium();
 	}
 }
 
 
-void Gui::UpdateBerkelium()
+bool Gui::AreAllWindowsIdle() const
 {
-	// update berkelium
-	Berkelium::update();
+	// get the iterator for the windows
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	// loop trough the windows
+	while (cIterator.HasNext())
+	{
+		SRPWindow *pSRPWindow = cIterator.Next();
+		if (pSRPWindow->IsBerkeliumWindowCreated() && (pSRPWindow->GetData()->bIsVisable || !pSRPWindow->GetData()->bLoaded))
+		{
+			// this window is shown or still loading
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void Gui::SetPumpMode(const uint32 &nPumpMode)
+{
+	m_nPumpMode = nPumpMode;
+}
+
+
+uint32 Gui::GetPumpMode() const
+{
+	return m_nPumpMode;
+}
+
+
+void Gui::SetPumpBudget(const uint32 &nMicroseconds, const uint32 &nMaxPumps)
+{
+	m_nPumpBudget = nMicroseconds;
+	m_nPumpMaxCount = (nMaxPumps > 0) ? nMaxPumps : 1;
+}
+
+
+uint64 Gui::GetPumpTime() const
+{
+	return m_nLastPumpTime;
+}
+
+
+uint32 Gui::GetPumpCount() const
+{
+	return m_nLastPumpCount;
+}
+
+
+uint32 Gui::GetCoalescedInputCount() const
+{
+	return m_nCoalescedInputCount;
+}
+
+
+void Gui::SetKeyRepeat(const uint32 &nDelay, const uint32 &nRate)
+{
+	m_nKeyRepeatDelay = nDelay;
+	m_nKeyRepeatRate = (nRate > 0) ? nRate : 1;
+}
+
+
+uint32 Gui::GetKeyRepeatDelay() const
+{
+	return m_nKeyRepeatDelay;
+}
+
+
+uint32 Gui::GetKeyRepeatRate() const
+{
+	return m_nKeyRepeatRate;
+}
+
+
+void Gui::AddBootstrapScript(const String &sName, const String &sJavascript)
+{
+	const int nIndex = m_lstBootstrapScriptNames.GetIndex(sName);
+	if (nIndex < 0)
+	{
+		m_lstBootstrapScriptNames.Add(sName);
+		m_lstBootstrapScriptSources.Add(sJavascript);
+	}
+	else
+	{
+		// replace the library, it keeps its place in the script
+		m_lstBootstrapScriptSources[nIndex] = sJavascript;
+	}
+	BuildBootstrapScript();
+
+	// the open pages get the library right away, the windows still use the bootstrap script they were created with
+	const String sLibrary = "\ntry {\n" + sJavascript + "\n} catch (e) {}\n";
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	while (cIterator.HasNext())
+	{
+		cIterator.Next()->ApplyBootstrapLibrary(sLibrary);
+	}
+}
+
+
+bool Gui::RemoveBootstrapScript(const String &sName)
+{
+	const int nIndex = m_lstBootstrapScriptNames.GetIndex(sName);
+	if (nIndex < 0)
+	{
+		// we cannot remove a library that cannot be found
+		return false;
+	}
+
+	m_lstBootstrapScriptNames.RemoveAtIndex(nIndex);
+	m_lstBootstrapScriptSources.RemoveAtIndex(nIndex);
+	BuildBootstrapScript();
+	return true;
+}
+
+
+const String &Gui::GetBootstrapScript() const
+{
+	// the last build is the current one
+	return m_lstBootstrapScripts[m_lstBootstrapScripts.GetNumOfElements() - 1]->sScript;
+}
+
+
+uint32 Gui::GetBootstrapBuildCount() const
+{
+	return m_nBootstrapBuildCount;
+}
+
+
+void Gui::BuildBootstrapScript()
+{
+	// the built-in script comes first, the helper libraries can use native.post() and the like
+	#include "NativePost_JS.h"
+	sBootstrapScript *psBootstrapScript = new sBootstrapScript;
+	psBootstrapScript->sScript = sNativePostSourceCodeJS;
+	for (uint32 i = 0; i < m_lstBootstrapScriptSources.GetNumOfElements(); i++)
+	{
+		psBootstrapScript->sScript += "\ntry {\n" + m_lstBootstrapScriptSources[i] + "\n} catch (e) {}\n";
+	}
+
+	// the berkelium thread gets a plain copy of the unicode version, a string would share its buffer with this thread
+	psBootstrapScript->nLength = psBootstrapScript->sScript.GetLength();
+	psBootstrapScript->pszScript = new wchar_t[psBootstrapScript->nLength + 1];
+	MemoryManager::Copy(psBootstrapScript->pszScript, psBootstrapScript->sScript.GetUnicode(), (psBootstrapScript->nLength + 1) * sizeof(wchar_t));
+	psBootstrapScript->nCommandMark = 0;
+	if (m_lstBootstrapScripts.GetNumOfElements() > 0)
+	{
+		// the commands that have been pushed until now may still read the previous build
+		m_lstBootstrapScripts[m_lstBootstrapScripts.GetNumOfElements() - 1]->nCommandMark = m_pBerkeliumThread ? m_pBerkeliumThread->GetNumOfPushedCommands() : 0;
+	}
+	m_lstBootstrapScripts.Add(psBootstrapScript);
+	m_nBootstrapBuildCount++;
+
+	// get the iterator for the windows
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	// loop trough the windows
+	while (cIterator.HasNext())
+	{
+		cIterator.Next()->SetBootstrapScript(psBootstrapScript);
+	}
+
+	// no window refers to the previous build anymore
+	BootstrapScriptHandler();
 }
 
 
@@ -235,6 +556,13 @@ void Gui::SetRenderers(Renderer *pRenderer, SceneRenderer *pSceneRenderer)
 				m_pCurrentRenderer = pRenderer;
 				m_pCurrentSceneRenderer = pSceneRenderer;
 				m_bRenderersInitialized = true;
+				// the windows share their textures through one pool
+				m_pTexturePool = new TexturePool(*pRenderer);
+				if (m_bTextureAtlasEnabled)
+				{
+					// small windows share the pages of the atlas
+					m_pTextureAtlas = new TextureAtlas(*pRenderer);
+				}
 
 				//hack: [10-07-2012 Icefire] perhaps the following can be moved somewhere else
 				// create the mouse pointer
@@ -245,13 +573,42 @@ void Gui::SetRenderers(Renderer *pRenderer, SceneRenderer *pSceneRenderer)
 }
 
 
+TexturePool *Gui::GetTexturePool() const
+{
+	return m_pTexturePool;
+}
+
+
+void Gui::SetTextureAtlasEnabled(const bool &bEnabled)
+{
+	m_bTextureAtlasEnabled = bEnabled;
+	if (m_bTextureAtlasEnabled && !m_pTextureAtlas && m_bRenderersInitialized)
+	{
+		// the atlas is kept once created, windows in it are not moved out when it is disabled again
+		m_pTextureAtlas = new TextureAtlas(*m_pCurrentRenderer);
+	}
+}
+
+
+bool Gui::IsTextureAtlasEnabled() const
+{
+	return m_bTextureAtlasEnabled;
+}
+
+
+TextureAtlas *Gui::GetTextureAtlas() const
+{
+	return m_pTextureAtlas;
+}
+
+
 sWindowsData *Gui::GetWindowData(const PLCore::String &sName)
 {
 	if (m_pmapWindows->Get(sName) == NULL)
 	{
 		// we should return the data from the dummy window to prevent crashes on called functions
 		// the end user should always verify that the returned data is the right one
-		return m_pmapWindows->Get(BERKELIUMDUMMYWINDOW)->GetData();
+		return m_pDummyWindow->GetData();
 	}
 	else
 	{
@@ -265,32 +622,38 @@ sWindowsData *Gui::GetWindowData(const PLCore::String &sName)
 void Gui::AddDummyWindow()
 {
 	// we create the window
-	SRPWindow *pSRPWindow = new SRPWindow(BERKELIUMDUMMYWINDOW);
+	m_pDummyWindow = new SRPWindow(BERKELIUMDUMMYWINDOW);
 
 	// we assign data to it
-	pSRPWindow->GetData()->bIsVisable = false;
-	pSRPWindow->GetData()->nFrameWidth = -1;
-	pSRPWindow->GetData()->nFrameHeight = -1;
-	pSRPWindow->GetData()->nXPos = -1;
-	pSRPWindow->GetData()->nYPos = -1;
-	pSRPWindow->GetData()->bKeyboardEnabled = false;
-	pSRPWindow->GetData()->bMouseEnabled = false;
+	m_pDummyWindow->GetData()->bIsVisable = false;
+	m_pDummyWindow->GetData()->sUrl = "";
+	m_pDummyWindow->GetData()->nFrameWidth = -1;
+	m_pDummyWindow->GetData()->nFrameHeight = -1;
+	m_pDummyWindow->GetData()->nXPos = -1;
+	m_pDummyWindow->GetData()->nYPos = -1;
+	m_pDummyWindow->GetData()->bTransparent = false;
+	m_pDummyWindow->GetData()->bKeyboardEnabled = false;
+	m_pDummyWindow->GetData()->bMouseEnabled = false;
+	m_pDummyWindow->GetData()->bNeedsFullUpdate = false;
+	m_pDummyWindow->GetData()->bLoaded = false;
+
+	// the dummy window is not initialized and not added to the hashmap, so it will never create a berkelium window
+}
 
-	// we create a berkelium window
-	pSRPWindow->CreateBerkeliumWindow();
 
-	// we add the created dummy window to the hashmap
-	m_pmapWindows->Add(BERKELIUMDUMMYWINDOW, pSRPWindow);
+void Gui::DestroyDummyWindow()
+{
+	if (m_pDummyWindow)
+	{
+		// cleanup the instance
+		m_pDummyWindow->DestroyInstance();
+		m_pDummyWindow = nullptr;
+	}
 }
 
 
 bool Gui::RemoveWindow(const String &sName)
 {
-	if (sName == BERKELIUMDUMMYWINDOW)
-	{
-		// we should never remove the dummy window
-		return false;
-	}
 	if (m_pmapWindows->Get(sName) == NULL)
 	{
 		// we cannot remove a window that cannot be found
@@ -311,6 +674,12 @@ bool Gui::RemoveWindow(const String &sName)
 		{
 			m_pLastMouseWindow = nullptr;
 		}
+		// the window cannot process its queued default callbacks and input anymore
+		RemoveDefaultCallBackEvents(pSRPWindow);
+		RemoveInputEvents(pSRPWindow);
+		m_plstResizePreviewWindows->Remove(pSRPWindow);
+		// the window must not be hit anymore
+		m_bHitTestDirty = true;
 		
 		// remove the scene render pass from the renderer
 		pSRPWindow->RemoveSceneRenderPass();
@@ -346,7 +715,7 @@ SRPWindow *Gui::GetWindow(const PLCore::String &sName)
 	{
 		// we should return the dummy window to prevent crashes on called functions
 		// the end user should always verify that the returned window is the right one
-		return m_pmapWindows->Get(BERKELIUMDUMMYWINDOW);
+		return m_pDummyWindow;
 	}
 	else
 	{
@@ -374,58 +743,161 @@ bool Gui::IsBerkeliumInitialized() const
 }
 
 
-void Gui::MouseMove(const SRPWindow *pSRPWindow, const Vector2i &vMousePos) const
+void Gui::MouseMove(SRPWindow *pSRPWindow, const Vector2i &vMousePos)
 {
+	if (pSRPWindow->IsInputBlocked())
+	{
+		// a hung page would only pile up mouse moves
+		return;
+	}
 	// move the mouse for berkelium
-	pSRPWindow->GetBerkeliumWindow()->mouseMoved(pSRPWindow->GetRelativeMousePosition(vMousePos).x, pSRPWindow->GetRelativeMousePosition(vMousePos).y);
+	QueueInputEvent(sInputEvent::InputMouseMove, pSRPWindow, pSRPWindow->GetRelativeMousePosition(vMousePos).x, pSRPWindow->GetRelativeMousePosition(vMousePos).y);
 }
 
 
-void Gui::UnFocusAllWindows()
+void Gui::QueueInputEvent(const uint32 &nType, SRPWindow *pSRPWindow, const int &nParam0, const int &nParam1, const int &nParam2, const int &nParam3, const String &sText)
 {
-	// focused window needs to be a nullptr
-	m_pFocusedWindow = nullptr;
-	// get the iterator for all the windows
-	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
-	// loop trough the windows
-	while (cIterator.HasNext())
+	if (nType == sInputEvent::InputMouseMove || nType == sInputEvent::InputMouseWheel)
+	{
+		// look back until the last button or key, those keep their order
+		for (int i = int(m_lstInputEvents.GetNumOfElements()) - 1; i >= 0; i--)
+		{
+			sInputEvent *psEvent = m_lstInputEvents[i];
+			if (psEvent->nType != sInputEvent::InputMouseMove && psEvent->nType != sInputEvent::InputMouseWheel)
+			{
+				break;
+			}
+			if (psEvent->nType == nType && psEvent->pSRPWindow == pSRPWindow)
+			{
+				if (nType == sInputEvent::InputMouseMove)
+				{
+					// the latest position wins
+					psEvent->nParam[0] = nParam0;
+					psEvent->nParam[1] = nParam1;
+				}
+				else
+				{
+					// the wheel deltas add up
+					psEvent->nParam[0] += nParam0;
+					psEvent->nParam[1] += nParam1;
+				}
+				m_nCoalescedInputCount++;
+				return;
+			}
+		}
+	}
+
+	// the events are reused once flushed, so there is no allocation once enough events exist
+	sInputEvent *psEvent = nullptr;
+	if (m_lstFreeInputEvents.GetNumOfElements() > 0)
+	{
+		psEvent = m_lstFreeInputEvents[m_lstFreeInputEvents.GetNumOfElements() - 1];
+		m_lstFreeInputEvents.RemoveAtIndex(m_lstFreeInputEvents.GetNumOfElements() - 1);
+	}
+	else
+	{
+		psEvent = new sInputEvent;
+	}
+	psEvent->nType = nType;
+	psEvent->nTime = System::GetInstance()->GetMicroseconds();
+	psEvent->pSRPWindow = pSRPWindow;
+	psEvent->nParam[0] = nParam0;
+	psEvent->nParam[1] = nParam1;
+	psEvent->nParam[2] = nParam2;
+	psEvent->nParam[3] = nParam3;
+	psEvent->sText = sText;
+	m_lstInputEvents.Add(psEvent);
+}
+
+
+void Gui::FlushInputEvents()
+{
+	for (uint32 i = 0; i < m_lstInputEvents.GetNumOfElements(); i++)
 	{
-		// unfocus the window
-		cIterator.Next()->GetBerkeliumWindow()->unfocus();
+		sInputEvent *psEvent = m_lstInputEvents[i];
+		switch (psEvent->nType)
+		{
+			case sInputEvent::InputMouseMove:
+				psEvent->pSRPWindow->SendMouseMove(psEvent->nParam[0], psEvent->nParam[1]);
+				break;
+
+			case sInputEvent::InputMouseButton:
+				psEvent->pSRPWindow->SendMouseButton(psEvent->nParam[0], psEvent->nParam[1] != 0, psEvent->nParam[2]);
+				break;
+
+			case sInputEvent::InputMouseWheel:
+				psEvent->pSRPWindow->SendMouseWheel(psEvent->nParam[0], psEvent->nParam[1]);
+				break;
+
+			case sInputEvent::InputText:
+				psEvent->pSRPWindow->SendText(psEvent->sText);
+				break;
+
+			case sInputEvent::InputKey:
+				psEvent->pSRPWindow->SendKey(psEvent->nParam[0] != 0, psEvent->nParam[1], psEvent->nParam[2], psEvent->nParam[3]);
+				break;
+
+			case sInputEvent::InputFocus:
+				psEvent->pSRPWindow->SendFocus();
+				break;
+
+			case sInputEvent::InputUnfocus:
+				psEvent->pSRPWindow->SendUnfocus();
+				break;
+		}
+		if (psEvent->nType != sInputEvent::InputFocus && psEvent->nType != sInputEvent::InputUnfocus)
+		{
+			// the latency of the input is measured from when it occurred
+			psEvent->pSRPWindow->MarkInput(psEvent->nTime);
+		}
+
+		// keep the event for reuse
+		m_lstFreeInputEvents.Add(psEvent);
+
+		// berkelium has input to process, see PumpLowLatency
+		m_bInputPending = true;
 	}
+	m_lstInputEvents.Reset();
 }
 
 
-List<SRPWindow*> *Gui::GetMouseEnabledWindows()
+void Gui::RemoveInputEvents(const SRPWindow *pSRPWindow)
 {
-	// create an empty list
-	List<SRPWindow*> *plstMouseEnabledWindows = new List<SRPWindow*>;
+	for (uint32 i = 0; i < m_lstInputEvents.GetNumOfElements(); )
+	{
+		sInputEvent *psEvent = m_lstInputEvents[i];
+		if (!pSRPWindow || psEvent->pSRPWindow == pSRPWindow)
+		{
+			m_lstInputEvents.RemoveAtIndex(i);
+			delete psEvent;
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
 
+void Gui::UnFocusAllWindows()
+{
+	// focused window needs to be a nullptr
+	m_pFocusedWindow = nullptr;
+	// the held keys were meant for the window that had the focus
+	ResetKeyStates();
 	// get the iterator for all the windows
 	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
 	// loop trough the windows
 	while (cIterator.HasNext())
 	{
 		SRPWindow *pSRPWindow = cIterator.Next();
-		if (pSRPWindow->GetData()->bIsVisable && pSRPWindow->GetData()->bMouseEnabled)
+		if (pSRPWindow->IsBerkeliumWindowCreated())
 		{
-			// if the window is visible and the mouse for the window is enabled then add the window to the list
-			plstMouseEnabledWindows->Add(pSRPWindow);
+			// unfocus the window, windows without a berkelium window are never focused
+			// the focus is queued with the input so that keys that were typed before still go to the window that had the focus
+			QueueInputEvent(sInputEvent::InputUnfocus, pSRPWindow);
 		}
 	}
-
-	if (plstMouseEnabledWindows->GetNumOfElements() > 0)
-	{
-		// list has items so return the list
-		return plstMouseEnabledWindows;
-	}
-	else
-	{
-		// we do not need the list any more
-		delete plstMouseEnabledWindows;
-		// return nothing because the list is empty
-		return nullptr;
-	}
 }
 
 
@@ -439,8 +911,12 @@ void Gui::FocusWindow(SRPWindow *pSRPWindow)
 			// unfocus all windows
 			UnFocusAllWindows();
 		}
-		// focus the window
-		pSRPWindow->GetBerkeliumWindow()->focus();
+		// the held keys were meant for the window that had the focus
+		ResetKeyStates();
+		// make sure the berkelium window exists before we focus it, this also thaws a frozen window
+		pSRPWindow->CreateBerkeliumWindow();
+		// focus the window in order with the input
+		QueueInputEvent(sInputEvent::InputFocus, pSRPWindow);
 		// set the window to front
 		pSRPWindow->MoveToFront();
 		// set the new focused window
@@ -449,69 +925,98 @@ void Gui::FocusWindow(SRPWindow *pSRPWindow)
 }
 
 
-List<SRPWindow*> *Gui::GetMouseOverWindows(const List<SRPWindow*> *plstEnabledWindows, const Vector2i &vMousePos)
+SRPWindow *Gui::GetWindowAt(const Vector2i &vMousePos)
 {
-	if (!plstEnabledWindows)
+	// the z-order only needs to be sorted again when windows where added, removed or moved to front
+	if (m_bHitTestDirty || m_nHitTestZOrderRevision != SRPWindow::GetZOrderRevision())
 	{
-		// return nothing because the enabled windows list is not valid
-		return nullptr;
+		UpdateHitTestWindows();
 	}
 
-	// create an empty list
-	List<SRPWindow*> *plstMouseOverWindows = new List<SRPWindow*>;
-
-	// get the iterator for the enabled windows
-	Iterator<SRPWindow*> cIterator = plstEnabledWindows->GetIterator();
-	// loop trough the enabled windows
-	while (cIterator.HasNext())
+	// front to back, the first window that is hit is the top most one
+	for (uint32 i = 0; i < m_lstHitTestWindows.GetNumOfElements(); i++)
 	{
-		SRPWindow *pSRPWindow = cIterator.Next();
+		SRPWindow *pSRPWindow = m_lstHitTestWindows[i];
+		if (!pSRPWindow->GetData()->bIsVisable || !pSRPWindow->GetData()->bMouseEnabled)
+		{
+			// the window does not take mouse events
+			continue;
+		}
 
 		// get the relative mouse position for the window
 		Vector2i vRelativeMousePos = pSRPWindow->GetRelativeMousePosition(vMousePos);
-
-		if (vRelativeMousePos.x > 0 && vRelativeMousePos.y > 0 && vRelativeMousePos.x < pSRPWindow->GetSize().x && vRelativeMousePos.y < pSRPWindow->GetSize().y)
+		if (vRelativeMousePos.x > 0 && vRelativeMousePos.y > 0 && vRelativeMousePos.x < pSRPWindow->GetData()->nFrameWidth && vRelativeMousePos.y < pSRPWindow->GetData()->nFrameHeight &&
+			pSRPWindow->IsHitAt(vRelativeMousePos))
 		{
-			// the mouse is currently over the window, so we add the window to the list
-			plstMouseOverWindows->Add(pSRPWindow);
+			// the mouse is currently over the window, clicks fall through transparent parts of windows with alpha hit testing
+			return pSRPWindow;
 		}
-		else
+
+		// check if any widgets are drawn for the window
+		if (pSRPWindow->GetWidgets()->GetNumOfElements() > 0)
 		{
-			// check if any widgets are drawn for the window
-			if (pSRPWindow->GetWidgets()->GetNumOfElements() > 0)
+			// get the iterator for the widgets
+			Iterator<sWidget*> cWidgetIterator = pSRPWindow->GetWidgets()->GetIterator();
+			// loop trough the widgets
+			while (cWidgetIterator.HasNext())
 			{
-				// get the iterator for the widgets
-				Iterator<sWidget*> cWidgetIterator = pSRPWindow->GetWidgets()->GetIterator();
-				// loop trough the widgets
-				while (cWidgetIterator.HasNext())
-				{
-					sWidget *psWidget = cWidgetIterator.Next();
+				sWidget *psWidget = cWidgetIterator.Next();
 
-					// get the relative mouse position for the widget
-					Vector2i vRelativeMousePosWidget = pSRPWindow->GetRelativeMousePositionWidget(psWidget, vMousePos);
-
-					if (vRelativeMousePosWidget.x > 0 && vRelativeMousePosWidget.y > 0 && vRelativeMousePosWidget.x < psWidget->nWidth && vRelativeMousePosWidget.y < psWidget->nHeight)
-					{
-						// the mouse is currently over the widget, so we add the window to the list
-						plstMouseOverWindows->Add(pSRPWindow);
-					}
+				// get the relative mouse position for the widget
+				Vector2i vRelativeMousePosWidget = pSRPWindow->GetRelativeMousePositionWidget(psWidget, vMousePos);
+				if (vRelativeMousePosWidget.x > 0 && vRelativeMousePosWidget.y > 0 && vRelativeMousePosWidget.x < psWidget->nWidth && vRelativeMousePosWidget.y < psWidget->nHeight)
+				{
+					// the mouse is currently over the widget of the window
+					return pSRPWindow;
 				}
 			}
 		}
 	}
 
-	if (plstMouseOverWindows->GetNumOfElements() > 0)
+	// the mouse is not over any window
+	return nullptr;
+}
+
+
+void Gui::UpdateHitTestWindows()
+{
+	m_lstHitTestWindows.Reset();
+	Array<int> lstIndices;
+	Array<SRPWindow*> lstFallbackWindows;
+
+	// get the iterator for all the windows
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	// loop trough the windows
+	while (cIterator.HasNext())
 	{
-		// list has items so return the list
-		return plstMouseOverWindows;
+		SRPWindow *pSRPWindow = cIterator.Next();
+
+		// the scene render pass index is a linear search, so it is only looked up once per window
+		const int nIndex = pSRPWindow->GetSceneRenderPassIndex();
+		if (nIndex < 0)
+		{
+			// a window that is not drawn by a scene renderer is only hit when no drawn window is
+			lstFallbackWindows.Add(pSRPWindow);
+			continue;
+		}
+
+		// insert sorted by descending index, the window that is drawn last comes first
+		uint32 nPosition = 0;
+		while (nPosition < lstIndices.GetNumOfElements() && lstIndices[nPosition] > nIndex)
+		{
+			nPosition++;
+		}
+		lstIndices.AddAtIndex(nIndex, nPosition);
+		m_lstHitTestWindows.AddAtIndex(pSRPWindow, nPosition);
 	}
-	else
+	// the fallback windows come behind all drawn windows
+	for (uint32 i = 0; i < lstFallbackWindows.GetNumOfElements(); i++)
 	{
-		// we do not need the list any more
-		delete plstMouseOverWindows;
-		// return nothing because the list is empty
-		return nullptr;
+		m_lstHitTestWindows.Add(lstFallbackWindows[i]);
 	}
+
+	m_nHitTestZOrderRevision = SRPWindow::GetZOrderRevision();
+	m_bHitTestDirty = false;
 }
 
 
@@ -525,6 +1030,13 @@ bool Gui::ConnectController(Controller *pController)
 {
 	if (pController && !m_bIsControllerConnected)
 	{
+		// map the controls to their actions once, so events do not need to compare names
+		Iterator<Control*> cIterator = pController->GetControls().GetIterator();
+		while (cIterator.HasNext())
+		{
+			AddControlAction(*cIterator.Next());
+		}
+
 		// connect the controller to the handler
 		pController->SignalOnControl.Connect(SlotOnControl);
 		m_bIsControllerConnected = true;
@@ -536,13 +1048,26 @@ bool Gui::ConnectController(Controller *pController)
 
 void Gui::OnUpdate()
 {
-	UpdateBerkelium();
+	JavascriptHandler();
+	PumpBerkelium();
 	// mouse handler?
 	KeyboardHandler();
+	if ((m_nPumpMode & PumpLowLatency) && (m_bInputPending || m_lstInputEvents.GetNumOfElements()))
+	{
+		// input has been send (or key repeats are about to be), have berkelium process it right away,
+		// once per update no matter how many control events there were
+		UpdateBerkelium();
+	}
+	m_bInputPending = false;
+	CoalescedCallBackHandler();
 	DefaultCallBackHandler();
 	DragWindowHandler();
 	ResizeWindowHandler();
-	// resize window handler
+	AutoFreezeHandler();
+	WatchdogHandler();
+	TexturePoolHandler();
+	TextureAtlasHandler();
+	BootstrapScriptHandler();
 }
 
 
@@ -559,7 +1084,7 @@ bool Gui::ConnectEventUpdate(SceneContext *pSceneContext)
 }
 
 
-void Gui::MouseEvents(Control &cControl)
+void Gui::MouseEvents(Control &cControl, const uint32 &nAction)
 {
 	// get the frontend
 	Frontend &cFrontend = static_cast<FrontendApplication*>(CoreApplication::GetApplication())->GetFrontend();
@@ -592,15 +1117,17 @@ void Gui::MouseEvents(Control &cControl)
 
 		// get the window that the mouse is over
 		// if there are more window under the mouse then it will return the top most
-		SRPWindow *pSRPWindow = GetTopMostWindow(GetMouseOverWindows(GetMouseEnabledWindows(), vMousePos));
+		SRPWindow *pSRPWindow = GetWindowAt(vMousePos);
 		if (pSRPWindow)
 		{
+			// input keeps the window from freezing
+			pSRPWindow->ResetIdleTime();
 			// move the mouse on the window
 			MouseMove(pSRPWindow, vMousePos);
 			// process mouse clicks on the window
-			MouseClicks(pSRPWindow, cControl);
+			MouseClicks(pSRPWindow, cControl, nAction);
 			// process mouse scrolls on the window
-			MouseScrolls(pSRPWindow, cControl);
+			MouseScrolls(pSRPWindow, cControl, nAction);
 			// set the window that the mouse last had contact with
 			m_pLastMouseWindow = pSRPWindow;
 		}
@@ -616,9 +1143,9 @@ void Gui::MouseEvents(Control &cControl)
 			if (m_pFocusedWindow)
 			{
 				// process mouse scrolls for the focused window
-				MouseScrolls(m_pFocusedWindow, cControl);
+				MouseScrolls(m_pFocusedWindow, cControl, nAction);
 
-				if (cControl.GetName() == "MouseLeft")
+				if (nAction == ActionMouseLeft)
 				{
 					// we clicked outside a window so we need to unfocus it
 					//undone: [10-07-2012 Icefire] this should only happen on mouse down, also allow for more mouse buttons to unfocus a window (right, middle, etc)
@@ -626,7 +1153,7 @@ void Gui::MouseEvents(Control &cControl)
 				}
 			}
 
-			if (cControl.GetName() == "MouseLeft")
+			if (nAction == ActionMouseLeft)
 			{
 				// set the state for the left mouse button
 				m_bMouseLeftDown = reinterpret_cast<Button&>(cControl).IsPressed();
@@ -640,9 +1167,19 @@ void Gui::MouseEvents(Control &cControl)
 }
 
 
-void Gui::MouseClicks(SRPWindow *pSRPWindow, Control &cControl)
+void Gui::MouseClicks(SRPWindow *pSRPWindow, Control &cControl, const uint32 &nAction)
 {
-	if (cControl.GetName() == "MouseLeft")
+	if (pSRPWindow->IsFrozen() && (nAction == ActionMouseLeft || nAction == ActionMouseRight))
+	{
+		// clicking a frozen window brings it back to life
+		pSRPWindow->Thaw();
+	}
+	if (!pSRPWindow->IsBerkeliumWindowCreated() || pSRPWindow->IsInputBlocked())
+	{
+		// nothing to click on
+		return;
+	}
+	if (nAction == ActionMouseLeft)
 	{
 		// mouse clicked on a window so we need to focus it
 		//todo: [10-07-2012 Icefire] have this happen on mouse down only
@@ -651,13 +1188,13 @@ void Gui::MouseClicks(SRPWindow *pSRPWindow, Control &cControl)
 		if ((Timing::GetInstance()->GetPastTime() - m_nLastMouseLeftReleaseTime) > 0 && (Timing::GetInstance()->GetPastTime() - m_nLastMouseLeftReleaseTime) < 250)
 		{
 			// we should send a double click
-			pSRPWindow->GetBerkeliumWindow()->mouseButton(0, reinterpret_cast<Button&>(cControl).IsPressed(), 2);
+			QueueInputEvent(sInputEvent::InputMouseButton, pSRPWindow, 0, reinterpret_cast<Button&>(cControl).IsPressed(), 2);
 			m_nLastMouseLeftReleaseTime = 0;
 		}
 		else
 		{
 			// send a single click
-			pSRPWindow->GetBerkeliumWindow()->mouseButton(0, reinterpret_cast<Button&>(cControl).IsPressed());
+			QueueInputEvent(sInputEvent::InputMouseButton, pSRPWindow, 0, reinterpret_cast<Button&>(cControl).IsPressed(), 1);
 			if (!reinterpret_cast<Button&>(cControl).IsPressed())
 			{
 				// mouse button has been released
@@ -672,32 +1209,26 @@ void Gui::MouseClicks(SRPWindow *pSRPWindow, Control &cControl)
 			}
 		}
 	}
-	if (cControl.GetName() == "MouseRight")
+	if (nAction == ActionMouseRight)
 	{
 		// mouse clicked on a window so we need to focus it
 		//todo: [10-07-2012 Icefire] have this happen on mouse down only
 		FocusWindow(pSRPWindow);
 
 		// send a right mouse click
-		pSRPWindow->GetBerkeliumWindow()->mouseButton(2, reinterpret_cast<Button&>(cControl).IsPressed());
+		QueueInputEvent(sInputEvent::InputMouseButton, pSRPWindow, 2, reinterpret_cast<Button&>(cControl).IsPressed(), 1);
 	}
 }
 
 
-void Gui::MouseScrolls(SRPWindow *pSRPWindow, Control &cControl)
+void Gui::MouseScrolls(SRPWindow *pSRPWindow, Control &cControl, const uint32 &nAction)
 {
-	if (pSRPWindow)
+	if (pSRPWindow && nAction == ActionMouseWheel)
 	{
-		if (pSRPWindow->GetData()->bIsVisable && pSRPWindow->GetData()->bMouseEnabled)
+		if (pSRPWindow->GetData()->bIsVisable && pSRPWindow->GetData()->bMouseEnabled && pSRPWindow->IsBerkeliumWindowCreated() && !pSRPWindow->IsInputBlocked())
 		{
-			if (cControl.GetType() == ControlAxis)
-			{
-				if (cControl.GetName() == "MouseWheel")
-				{
-					// if all of the above is true, send mouse scroll
-					pSRPWindow->GetBerkeliumWindow()->mouseWheel(0, int(static_cast<Axis&>(cControl).GetValue()));
-				}
-			}
+			// if all of the above is true, send mouse scroll
+			QueueInputEvent(sInputEvent::InputMouseWheel, pSRPWindow, 0, int(static_cast<Axis&>(cControl).GetValue()));
 		}
 	}
 }
@@ -705,57 +1236,90 @@ void Gui::MouseScrolls(SRPWindow *pSRPWindow, Control &cControl)
 
 void Gui::OnControl(Control &cControl)
 {
+	uint32 nKeySlot = MAXKEYSTATES;
+	const uint32 nAction = GetControlAction(cControl, nKeySlot);
+	switch (nAction)
 	{
-		//undone: [10-07-2012 Icefire] filter out anything but mouse events
-		MouseEvents(cControl);
+		case ActionMouseMove:
+		case ActionMouseLeft:
+		case ActionMouseRight:
+		case ActionMouseWheel:
+			MouseEvents(cControl, nAction);
+			break;
+
+		case ActionKeyText:
+		case ActionKeyVirtual:
+			KeyboardEvents(cControl, nAction, nKeySlot);
+			break;
+
+		default:
+			// the control is of no interest to us
+			return;
 	}
+}
+
 
+uint32 Gui::GetControlAction(Control &cControl, uint32 &nKeySlot)
+{
+	uint32 nValue = m_pmapControlActions->Get(&cControl);
+	if (nValue == ActionUnknown)
 	{
-		//undone: [10-07-2012 Icefire] filter out anything but keyboard events
-		KeyboardEvents(cControl);
+		// the control is not part of the connected controller, map it once
+		nValue = AddControlAction(cControl);
 	}
+
+	const uint32 nAction = nValue & ((1 << CONTROLACTIONBITS) - 1);
+	if (nAction == ActionKeyText || nAction == ActionKeyVirtual)
+		nKeySlot = nValue >> CONTROLACTIONBITS;
+	return nAction;
 }
 
 
-SRPWindow *Gui::GetTopMostWindow(List<SRPWindow*> *plstWindows)
+uint32 Gui::AddControlAction(Control &cControl)
 {
-	if (plstWindows)
+	uint32 nValue = MapControlAction(cControl);
+	if (nValue == ActionKeyText || nValue == ActionKeyVirtual)
 	{
-		if (plstWindows->GetNumOfElements() == 1)
+		if (m_nNumOfKeyStates < MAXKEYSTATES)
 		{
-			// if the list has only one item return it
-			return plstWindows->Get(0);
+			// the key keeps its slot as long as we run
+			nValue |= m_nNumOfKeyStates << CONTROLACTIONBITS;
+			m_nNumOfKeyStates++;
 		}
 		else
 		{
-			// prepare for the current topmost window
-			SRPWindow *pTopMostWindow = nullptr;
-
-			int nHigherIndex = -1;
+			// there is no state left for this key
+			nValue = ActionNone;
+		}
+	}
+	m_pmapControlActions->Add(&cControl, nValue);
+	return nValue;
+}
 
-			// get the iterator for the windows in the list
-			Iterator<SRPWindow*> cIterator = plstWindows->GetIterator();
-			// loop trough the windows
-			while (cIterator.HasNext())
-			{
-				SRPWindow *pSRPWindow = cIterator.Next();
-				if (pSRPWindow->GetSceneRenderPassIndex() > nHigherIndex)
-				{
-					// if the window is top most, keep it
-					nHigherIndex = pSRPWindow->GetSceneRenderPassIndex();
-					pTopMostWindow = pSRPWindow;
-				}
-			}
 
-			// return the top most window, can be a nullptr
-			return pTopMostWindow;
-		}
+uint32 Gui::MapControlAction(Control &cControl) const
+{
+	const String sName = cControl.GetName();
+	if (sName.GetSubstring(0, 5) == "Mouse")
+	{
+		if (sName == "MouseLeft" && cControl.GetType() == ControlButton)
+			return ActionMouseLeft;
+		else if (sName == "MouseRight" && cControl.GetType() == ControlButton)
+			return ActionMouseRight;
+		else if (sName == "MouseWheel" && cControl.GetType() == ControlAxis)
+			return ActionMouseWheel;
+		return ActionMouseMove;
 	}
-	else
+	if (sName.GetSubstring(0, 8) == "Keyboard" && cControl.GetType() == ControlButton)
 	{
-		// return nothing
-		return nullptr;
+		// the character of a key does not change
+		const Button &cButton = static_cast<Button&>(cControl);
+		if (String(cButton.GetCharacter()).IsAlphaNumeric() || sName == "KeyboardSpace" || sName == "KeyboardReturn")
+			return ActionKeyText;
+		else if (sName == "KeyboardBackspace" || sName == "KeyboardTab")
+			return ActionKeyVirtual;
 	}
+	return ActionNone;
 }
 
 
@@ -774,117 +1338,148 @@ bool Gui::SetMousePointerVisible(const bool &bVisible) const
 }
 
 
-void Gui::DefaultCallBackHandler()
+void Gui::JavascriptHandler()
 {
 	// get the iterator for the windows
 	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
 	// loop trough the windows
 	while (cIterator.HasNext())
 	{
-		SRPWindow *pSRPWindow = cIterator.Next();
+		// execute the queued javascript before berkelium updates
+		cIterator.Next()->FlushJavascript();
+	}
+}
+
+
+void Gui::CoalescedCallBackHandler()
+{
+	// get the iterator for the windows
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	// loop trough the windows
+	while (cIterator.HasNext())
+	{
+		// dispatch the last calls of the callback functions
+		cIterator.Next()->DispatchCoalescedCallBacks();
+	}
+}
+
+
+void Gui::DefaultCallBackHandler()
+{
+	// the events are taken from the front one by one, closing a window removes its remaining events from the queue
+	while (!m_plstDefaultCallBackEvents->IsEmpty())
+	{
+		sDefaultCallBackEvent *psEvent = m_plstDefaultCallBackEvents->Get(0);
+		m_plstDefaultCallBackEvents->RemoveAtIndex(0);
+		SRPWindow *pSRPWindow = psEvent->pSRPWindow;
 
-		// check if callback is present
-		if (pSRPWindow->GetNumberOfCallBacks() > 0)
+		switch (psEvent->nId)
 		{
-			if (pSRPWindow->GetCallBack(DRAGWINDOW))
-			{
+			case SRPWindow::CallBackDragWindow:
 				m_pDragWindow = pSRPWindow;
-				// call back is processed so we clear them
-				pSRPWindow->RemoveCallBacks();
-			}
-			else if (pSRPWindow->GetCallBack(HIDEWINDOW))
-			{
+				// call back is processed so we clear it
+				pSRPWindow->RemoveDefaultCallBack(psEvent->nId);
+				break;
+
+			case SRPWindow::CallBackHideWindow:
 				pSRPWindow->GetData()->bIsVisable = false;
-				// call back is processed so we clear them
-				pSRPWindow->RemoveCallBacks();
-			}
-			else if (pSRPWindow->GetCallBack(CLOSEWINDOW))
-			{
+				// call back is processed so we clear it
+				pSRPWindow->RemoveDefaultCallBack(psEvent->nId);
+				break;
+
+			case SRPWindow::CallBackCloseWindow:
 				RemoveWindow(pSRPWindow->GetName());
 				// call back is processed and should get cleared by the remove window method
-			}
-			else if (pSRPWindow->GetCallBack(RESIZEWINDOW))
-			{
+				break;
+
+			case SRPWindow::CallBackResizeWindow:
 				m_pResizeWindow = pSRPWindow;
-				// call back is processed so we clear them
-				pSRPWindow->RemoveCallBacks();
-			}
+				// call back is processed so we clear it
+				pSRPWindow->RemoveDefaultCallBack(psEvent->nId);
+				break;
+		}
+
+		// cleanup
+		delete psEvent;
+	}
+}
+
+
+void Gui::RemoveDefaultCallBackEvents(const SRPWindow *pSRPWindow)
+{
+	for (uint32 i = 0; i < m_plstDefaultCallBackEvents->GetNumOfElements(); )
+	{
+		sDefaultCallBackEvent *psEvent = m_plstDefaultCallBackEvents->Get(i);
+		if (!pSRPWindow || psEvent->pSRPWindow == pSRPWindow)
+		{
+			m_plstDefaultCallBackEvents->RemoveAtIndex(i);
+			delete psEvent;
+		}
+		else
+		{
+			i++;
 		}
 	}
 }
 
 
-void Gui::KeyboardEvents(Control &cControl)
+void Gui::KeyboardEvents(Control &cControl, const uint32 &nAction, const uint32 &nKeySlot)
 {
 	//hack: [10-07-2012 Icefire] i am not yet satisfied with this method, so expect this to change
 
-	if (m_pFocusedWindow)
+	// get the button class
+	Button &cButton = reinterpret_cast<Button&>(cControl);
+
+	// the key states are kept per control, keys that share a character are still told apart
+	sKeyState *psState = &m_sKeyStates[nKeySlot];
+
+	if (!cButton.IsPressed())
 	{
-		// check if the focused window allows for key events
-		if (m_pFocusedWindow->GetData()->bKeyboardEnabled)
+		// a release is handled whatever has the focus, else the key would keep repeating
+		psState->bDown = false;
+		if (m_psRepeatKeyState == psState)
 		{
-			// check if the event is for the keyboard
-			if (cControl.GetName().GetSubstring(0, 8) == "Keyboard")
-			{
-				// get the button class
-				Button &cButton = reinterpret_cast<Button&>(cControl);
+			// the released key does not repeat anymore
+			m_psRepeatKeyState = nullptr;
+		}
+		return;
+	}
 
-				if (cButton.IsPressed())
-				{
-					sButton *psButton = new sButton;
+	// check if there is a focused window that allows for key events
+	if (!m_pFocusedWindow || !m_pFocusedWindow->GetData()->bKeyboardEnabled)
+	{
+		return;
+	}
 
-					if (String(cButton.GetCharacter()).IsAlphaNumeric())
-					{
-						AddTextKey(cButton.GetName(), cButton.GetCharacter(), psButton);
-					}
-					else if (cButton.GetName() == "KeyboardSpace")
-					{
-						AddTextKey(cButton.GetName(), cButton.GetCharacter(), psButton);
-					}
-					else if (cButton.GetName() == "KeyboardBackspace")
-					{
-						AddKey(cButton.GetName(), cButton.GetCharacter(), psButton);
-					}
-					else if (cButton.GetName() == "KeyboardTab")
-					{
-						AddKey(cButton.GetName(), cButton.GetCharacter(), psButton);
-					}
-					else if (cButton.GetName() == "KeyboardReturn")
-					{
-						AddTextKey(cButton.GetName(), cButton.GetCharacter(), psButton);
-					}
-					else
-					{
-						psButton->bValid = false;
-					}
-				}
-				else
-				{
-					if (m_pmapTextButtonHandler->GetNumOfElements() == 1)
-					{
-						m_nTextKeyHitCount = 0;
-					}
-					m_pmapTextButtonHandler->Remove(cButton.GetName());
+	if (psState->bDown)
+	{
+		// the key is already held, we generate the repeats ourselves
+		return;
+	}
 
-					if (m_pmapKeyButtonHandler->GetNumOfElements() == 1)
-					{
-						m_nKeyHitCount = 0;
-					}
-					m_pmapKeyButtonHandler->Remove(cButton.GetName());
-				}
-			}
-		}
+	if (nAction == ActionKeyText)
+	{
+		// send as text
+		psState->bText = true;
+		psState->sText = cButton.GetCharacter();
 	}
+	else
+	{
+		// send as virtual key, the character is the key code
+		psState->bText = false;
+		psState->nKeyCode = uint8(cButton.GetCharacter());
+	}
+
+	// the last pressed key is the one that repeats
+	psState->bDown = true;
+	psState->nNextRepeatTime = Timing::GetInstance()->GetPastTime() + m_nKeyRepeatDelay;
+	m_psRepeatKeyState = psState;
+	SendKeyState(*psState);
 }
 
 
 bool Gui::SetWindowVisible(const String &sName, const bool &bVisible)
 {
-	if (sName == BERKELIUMDUMMYWINDOW)
-	{
-		// we should not do this on the dummy window
-		return false;
-	}
 	if (m_pmapWindows->Get(sName) == NULL)
 	{
 		// we cannot find the window
@@ -899,6 +1494,12 @@ bool Gui::SetWindowVisible(const String &sName, const bool &bVisible)
 			UnFocusAllWindows();
 		}
 
+		if (bVisible)
+		{
+			// the berkelium window is created lazily, the first time the window is shown
+			m_pmapWindows->Get(sName)->CreateBerkeliumWindow();
+		}
+
 		// set the visibility of the window
 		m_pmapWindows->Get(sName)->GetData()->bIsVisable = bVisible;
 		return true;
@@ -941,135 +1542,158 @@ void Gui::DragWindowHandler()
 
 void Gui::KeyboardHandler()
 {
-	//hack: [10-07-2012 Icefire] i am not yet satisfied with this method, so expect this to change
+	if (!m_psRepeatKeyState)
+	{
+		// no key is held
+		return;
+	}
 
 	if (m_pFocusedWindow)
 	{
-		if (m_pFocusedWindow->GetData()->bKeyboardEnabled)
+		// keys are held down so the window is not idle
+		m_pFocusedWindow->ResetIdleTime();
+	}
+
+	// the repeats are due by time, the rate does not depend on the frame rate
+	sKeyState &sState = *m_psRepeatKeyState;
+	const uint64 nTime = Timing::GetInstance()->GetPastTime();
+	if (nTime >= sState.nNextRepeatTime)
+	{
+		SendKeyState(sState);
+		sState.nNextRepeatTime += m_nKeyRepeatRate;
+		if (nTime >= sState.nNextRepeatTime)
 		{
-			if (m_pmapTextButtonHandler->GetNumOfElements() > 0)
-			{
-				Iterator<sButton*> cIterator = m_pmapTextButtonHandler->GetIterator();
-				while (cIterator.HasNext())
-				{
-					sButton *psButton = cIterator.Next();
-					if (psButton->bValid)
-					{
-						if (m_nTextKeyHitCount == 0)
-						{
-							m_pFocusedWindow->GetBerkeliumWindow()->textEvent(psButton->sKey.GetUnicode(), psButton->sKey.GetLength());
-							m_nLastTextKeySendTime = Timing::GetInstance()->GetPastTime();
-							m_nTextKeyHitCount++;
-						}
-						else
-						{
-							if (m_nTextKeyHitCount == 1)
-							{
-								if ((Timing::GetInstance()->GetPastTime() - m_nLastTextKeySendTime) > 400)
-								{
-									m_pFocusedWindow->GetBerkeliumWindow()->textEvent(psButton->sKey.GetUnicode(), psButton->sKey.GetLength());
-									m_nLastTextKeySendTime = Timing::GetInstance()->GetPastTime();
-									m_nTextKeyHitCount++;
-								}
-							}
-							else
-							{
-								if ((Timing::GetInstance()->GetPastTime() - m_nLastTextKeySendTime) > 50)
-								{
-									m_pFocusedWindow->GetBerkeliumWindow()->textEvent(psButton->sKey.GetUnicode(), psButton->sKey.GetLength());
-									m_nLastTextKeySendTime = Timing::GetInstance()->GetPastTime();
-									m_nTextKeyHitCount++;
-								}
-							}
-						}
-					}
-				}
-			}
-			if (m_pmapKeyButtonHandler->GetNumOfElements() > 0)
-			{
-				Iterator<sButton*> cIterator = m_pmapKeyButtonHandler->GetIterator();
-				while (cIterator.HasNext())
-				{
-					sButton *psButton = cIterator.Next();
-					if (psButton->bValid)
-					{
-						if (m_nKeyHitCount == 0)
-						{
-							m_pFocusedWindow->GetBerkeliumWindow()->keyEvent(true, 0, psButton->nKey, 0);
-							m_nLastKeySendTime = Timing::GetInstance()->GetPastTime();
-							m_nKeyHitCount++;
-						}
-						else
-						{
-							if (m_nKeyHitCount == 1)
-							{
-								if ((Timing::GetInstance()->GetPastTime() - m_nLastKeySendTime) > 400)
-								{
-									m_pFocusedWindow->GetBerkeliumWindow()->keyEvent(true, 0, psButton->nKey, 0);
-									m_nLastKeySendTime = Timing::GetInstance()->GetPastTime();
-									m_nKeyHitCount++;
-								}
-							}
-							else
-							{
-								if ((Timing::GetInstance()->GetPastTime() - m_nLastKeySendTime) > 50)
-								{
-									m_pFocusedWindow->GetBerkeliumWindow()->keyEvent(true, 0, psButton->nKey, 0);
-									m_nLastKeySendTime = Timing::GetInstance()->GetPastTime();
-									m_nKeyHitCount++;
-								}
-							}
-						}
-					}
-				}
-			}
+			// we are behind (slow updates or a stall), the missed repeats are dropped instead of being send in a burst
+			sState.nNextRepeatTime = nTime + m_nKeyRepeatRate;
 		}
 	}
 }
 
 
-void Gui::AddTextKey(const String &sName, const String &sKey, sButton *psButton)
+bool Gui::SendKeyState(const sKeyState &sState)
 {
-	//hack: [10-07-2012 Icefire] i am not yet satisfied with this method
+	if (!m_pFocusedWindow || !m_pFocusedWindow->GetData()->bKeyboardEnabled || !m_pFocusedWindow->IsBerkeliumWindowCreated() || m_pFocusedWindow->IsInputBlocked())
+	{
+		// there is no window to send the key to
+		return false;
+	}
 
-	m_pmapTextButtonHandler->Clear();
-	psButton->bValid = true;
-	psButton->sKey = sKey;
-	m_pmapTextButtonHandler->Add(sName, psButton);
-	m_nTextKeyHitCount = 0;
+	if (sState.bText)
+	{
+		// the string shares its buffer, so this does not allocate
+		QueueInputEvent(sInputEvent::InputText, m_pFocusedWindow, 0, 0, 0, 0, sState.sText);
+	}
+	else
+	{
+		QueueInputEvent(sInputEvent::InputKey, m_pFocusedWindow, true, 0, sState.nKeyCode, 0);
+	}
+	return true;
 }
 
 
-void Gui::AddKey(const PLCore::String &sName, const char &nKey, sButton *psButton)
+void Gui::ResetKeyStates()
 {
-	//hack: [10-07-2012 Icefire] i am not yet satisfied with this method
-
-	psButton->bValid = true;
-	psButton->nKey = nKey;
-	m_pmapKeyButtonHandler->Add(sName, psButton);
-	m_nKeyHitCount = 0;
+	for (uint32 i = 0; i < m_nNumOfKeyStates; i++)
+	{
+		m_sKeyStates[i].bDown = false;
+	}
+	m_psRepeatKeyState = nullptr;
 }
 
 
 void Gui::DebugNamesOfWindows()
 {
-	if (m_pmapWindows->GetNumOfElements() > 1)
+	if (m_pmapWindows->GetNumOfElements() > 0)
 	{
-		DebugToConsole("Amount of windows found: " + String(m_pmapWindows->GetNumOfElements() - 1) + "\n");
+		DebugToConsole("Amount of windows found: " + String(m_pmapWindows->GetNumOfElements()) + "\n");
 
 		Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
 		while (cIterator.HasNext())
 		{
 			SRPWindow *pSRPWindow = cIterator.Next();
-			if (pSRPWindow->GetName() != BERKELIUMDUMMYWINDOW)
+			DebugToConsole("Window name: '" + pSRPWindow->GetName() + "'\n");
+			DebugToConsole("\t- Visible?: " + String(pSRPWindow->GetData()->bIsVisable ? "True" : "False") + "\n");
+			DebugToConsole("\t- Size: " + pSRPWindow->GetSize().ToString() + "\n");
+			DebugToConsole("\t- Position: " + pSRPWindow->GetPosition().ToString() + "\n");
+			DebugToConsole("\t- Loaded?: " + String(pSRPWindow->GetData()->bLoaded ? "True" : "False") + "\n");
+			DebugToConsole("\t- Created?: " + String(pSRPWindow->IsBerkeliumWindowCreated() ? "True" : "False") + "\n\n");
+		}
+	}
+}
+
+
+void Gui::AutoFreezeHandler()
+{
+	// get the iterator for the windows
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	// loop trough the windows
+	while (cIterator.HasNext())
+	{
+		SRPWindow *pSRPWindow = cIterator.Next();
+		if (pSRPWindow != m_pFocusedWindow && pSRPWindow != m_pDragWindow && pSRPWindow != m_pResizeWindow)
+		{
+			// freeze the window if it has been idle long enough, windows we interact with are left alone
+			pSRPWindow->UpdateAutoFreeze();
+		}
+	}
+}
+
+
+void Gui::TexturePoolHandler()
+{
+	if (m_pTexturePool)
+	{
+		// destroy the textures that nobody has asked for in a while
+		m_pTexturePool->Trim();
+	}
+}
+
+
+void Gui::TextureAtlasHandler()
+{
+	if (m_pTextureAtlas)
+	{
+		if (m_pTextureAtlas->IsBatching())
+		{
+			// the batches are filled with where the windows are now
+			Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+			while (cIterator.HasNext())
 			{
-				DebugToConsole("Window name: '" + pSRPWindow->GetName() + "'\n");
-				DebugToConsole("\t- Visible?: " + String(pSRPWindow->GetData()->bIsVisable ? "True" : "False") + "\n");
-				DebugToConsole("\t- Size: " + pSRPWindow->GetSize().ToString() + "\n");
-				DebugToConsole("\t- Position: " + pSRPWindow->GetPosition().ToString() + "\n");
-				DebugToConsole("\t- Loaded?: " + String(pSRPWindow->GetData()->bLoaded ? "True" : "False") + "\n\n");
+				cIterator.Next()->UpdateAtlasQuad();
 			}
 		}
+		m_pTextureAtlas->NextFrame();
+	}
+}
+
+
+void Gui::BootstrapScriptHandler()
+{
+	// the last build is the current one, the marks of the previous ones only grow
+	while (m_lstBootstrapScripts.GetNumOfElements() > 1)
+	{
+		sBootstrapScript *psBootstrapScript = m_lstBootstrapScripts[0];
+		if (m_pBerkeliumThread && !m_pBerkeliumThread->IsExecuted(psBootstrapScript->nCommandMark))
+		{
+			// the berkelium thread may still read it
+			break;
+		}
+		m_lstBootstrapScripts.RemoveAtIndex(0);
+		delete [] psBootstrapScript->pszScript;
+		delete psBootstrapScript;
+	}
+}
+
+
+void Gui::WatchdogHandler()
+{
+	// get the iterator for the windows
+	Iterator<SRPWindow*> cIterator = m_pmapWindows->GetIterator();
+	// loop trough the windows
+	while (cIterator.HasNext())
+	{
+		// apply the unresponsive policy of the window
+		cIterator.Next()->UpdateWatchdog();
 	}
 }
 
@@ -1079,6 +1703,23 @@ void Gui::ResizeWindowHandler()
 	//todo: [06-07-2012 Icefire] this resizing handler works for now, however the way we resize the buffer now is still not acceptable.
 	// also keep in mind that this current approach thinks the resize is triggered from the bottom right corner of the windows.
 
+	// only the windows that have reported a resize preview are looked at
+	for (uint32 i = 0; i < m_plstResizePreviewWindows->GetNumOfElements(); )
+	{
+		SRPWindow *pSRPWindow = m_plstResizePreviewWindows->Get(i);
+		// resize the window when its resize preview is due
+		pSRPWindow->UpdateResizePreview();
+		if (pSRPWindow->IsResizePreviewed())
+		{
+			i++;
+		}
+		else
+		{
+			// the preview has been applied or replaced by a resize
+			m_plstResizePreviewWindows->RemoveAtIndex(i);
+		}
+	}
+
 	if (m_pResizeWindow)
 	{
 		if (m_bMouseLeftDown)
@@ -1104,15 +1745,15 @@ void Gui::ResizeWindowHandler()
 					m_vLockMousePos.y <= m_pResizeWindow->GetRelativeMousePosition(m_vLastKnownMousePos).y)
 				{
 					// we should make the window bigger
-					Vector2i vNewSize = m_pResizeWindow->GetSize() - (m_vLockMousePos - m_pResizeWindow->GetRelativeMousePosition(m_vLastKnownMousePos));
+					Vector2i vNewSize = m_pResizeWindow->GetPreviewSize() - (m_vLockMousePos - m_pResizeWindow->GetRelativeMousePosition(m_vLastKnownMousePos));
 					// check if the new size difference is bigger than 1px in any direction so to not call to many resize updates
-					if ((vNewSize - m_pResizeWindow->GetSize()).x > 1 || (vNewSize - m_pResizeWindow->GetSize()).y > 1)
+					if ((vNewSize - m_pResizeWindow->GetPreviewSize()).x > 1 || (vNewSize - m_pResizeWindow->GetPreviewSize()).y > 1)
 					{
 						// check if new window size is at least 4 x 4 pixels, if you need smaller windows than that you should switch your field to nanotechnology
 						if (vNewSize.x >= 4 && vNewSize.y >= 4)
 						{
-							// we resize the window
-							m_pResizeWindow->ResizeWindow(vNewSize.x, vNewSize.y);
+							// we stretch the window, it is resized once the size has settled
+							m_pResizeWindow->PreviewResize(vNewSize.x, vNewSize.y);
 							// we should reset the locked mouse position since the window has been resized
 							m_vLockMousePos = Vector2i::Zero;
 						}
@@ -1121,18 +1762,18 @@ void Gui::ResizeWindowHandler()
 				else
 				{
 					// we should make the window smaller
-					Vector2i vNewSize = m_pResizeWindow->GetSize() - (m_vLockMousePos - m_pResizeWindow->GetRelativeMousePosition(m_vLastKnownMousePos));
+					Vector2i vNewSize = m_pResizeWindow->GetPreviewSize() - (m_vLockMousePos - m_pResizeWindow->GetRelativeMousePosition(m_vLastKnownMousePos));
 					// check if the new size difference is bigger than 2px in any direction so to not call to many resize updates
-					if ((m_pResizeWindow->GetSize() - vNewSize).x > 2 ||
-						(m_pResizeWindow->GetSize() - vNewSize).y > 2 ||
-						(m_pResizeWindow->GetSize() - vNewSize).x < -2 ||
-						(m_pResizeWindow->GetSize() - vNewSize).y < -2)
+					if ((m_pResizeWindow->GetPreviewSize() - vNewSize).x > 2 ||
+						(m_pResizeWindow->GetPreviewSize() - vNewSize).y > 2 ||
+						(m_pResizeWindow->GetPreviewSize() - vNewSize).x < -2 ||
+						(m_pResizeWindow->GetPreviewSize() - vNewSize).y < -2)
 					{
 						// check if new window size is at least 4 x 4 pixels, if you need smaller windows than that you should switch your field to nanotechnology
 						if (vNewSize.x >= 4 && vNewSize.y >= 4)
 						{
-							// we resize the window
-							m_pResizeWindow->ResizeWindow(vNewSize.x, vNewSize.y);
+							// we stretch the window, it is resized once the size has settled
+							m_pResizeWindow->PreviewResize(vNewSize.x, vNewSize.y);
 							// we should reset the locked mouse position since the window has been resized
 							m_vLockMousePos = Vector2i::Zero;
 						}
@@ -1146,6 +1787,7 @@ void Gui::ResizeWindowHandler()
 		else
 		{
 			// the left mouse is not pressed anymore so we can reset the following
+			m_pResizeWindow->ApplyResizePreview();
 			m_vLockMousePos = Vector2i::Zero;
 			m_pResizeWindow = nullptr;
 		}
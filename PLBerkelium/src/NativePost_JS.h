@@ -0,0 +1,160 @@
+//[-------------------------------------------------------]
+//[ Define helper macro                                   ]
+//[-------------------------------------------------------]
+#define STRINGIFY(ME) #ME
+
+
+//[-------------------------------------------------------]
+//[ Javascript source code                                ]
+//[-------------------------------------------------------]
+// Javascript that adds native.post(name, args) and native.call(name, args) to every page, the whole script is wrapped in parentheses so that its commas survive STRINGIFY
+// native.post() messages are flattened into the arguments of one NativePost call per animation frame, see SRPWindow::DispatchNativePost()
+// native.call() returns a promise that c++ settles through native._settle() by correlation id, see SRPWindow::DispatchNativeCall()
+// native.model is kept in sync by c++ through native._patch(), see SRPWindow::SyncState()
+// native.onbinary() receives the blobs c++ sends through native._binary(), see SRPWindow::SendBinary()
+static const PLCore::String sNativePostSourceCodeJS = STRINGIFY(
+(function()
+{
+	// messages posted since the last flush as name, number of arguments and the arguments
+	var aQueue = [];
+	var bScheduled = false;
+
+	function Flush()
+	{
+		bScheduled = false;
+		var aBatch = aQueue;
+		aQueue = [];
+		if (aBatch.length > 0)
+			NativePost.apply(null, aBatch);
+	}
+
+	window.native = window.native || {};
+	// interned ids of the callback functions by name, see SRPWindow::BindCallBackFunction()
+	window.native._ids = window.native._ids || {};
+	window.native.post = function(sName, aArgs)
+	{
+		aArgs = aArgs || [];
+		aQueue.push(window.native._ids[sName] || sName, aArgs.length);
+		for (var i = 0; i < aArgs.length; i++)
+			aQueue.push(aArgs[i]);
+
+		// flush once per animation frame no matter how many messages are posted
+		if (!bScheduled)
+		{
+			bScheduled = true;
+			if (window.requestAnimationFrame)
+				window.requestAnimationFrame(Flush);
+			else if (window.webkitRequestAnimationFrame)
+				window.webkitRequestAnimationFrame(Flush);
+			else
+				window.setTimeout(Flush, 16);
+		}
+	};
+
+	// promises of native.call() that c++ has not settled yet, by correlation id
+	var aPending = {};
+	var nLastCallId = 0;
+
+	function CreatePromise(nCallId)
+	{
+		if (window.Promise)
+			return new window.Promise(function(fResolve, fReject) { aPending[nCallId] = { resolve: fResolve, reject: fReject }; });
+
+		// minimal thenable for engines without promises, then() does not chain
+		var aHandlers = [];
+		var cResult = null;
+		function Notify(aHandler)
+		{
+			var fHandler = cResult.bResolved ? aHandler[0] : aHandler[1];
+			if (fHandler)
+				fHandler(cResult.sValue);
+		}
+		function Settle(bResolved, sValue)
+		{
+			cResult = { bResolved: bResolved, sValue: sValue };
+			for (var i = 0; i < aHandlers.length; i++)
+				Notify(aHandlers[i]);
+		}
+		aPending[nCallId] = { resolve: function(sValue) { Settle(true, sValue); }, reject: function(sValue) { Settle(false, sValue); } };
+		return { then: function(fResolve, fReject) { if (cResult) Notify([fResolve, fReject]); else aHandlers.push([fResolve, fReject]); return this; } };
+	}
+
+	window.native.call = function(sName, aArgs)
+	{
+		var nCallId = ++nLastCallId;
+		var cPromise = CreatePromise(nCallId);
+		// the page does not wait for c++, the result arrives through native._settle()
+		NativeCall.apply(null, [nCallId, window.native._ids[sName] || sName].concat(aArgs || []));
+		return cPromise;
+	};
+
+	window.native._settle = function(nCallId, bResolved, sValue)
+	{
+		var cPending = aPending[nCallId];
+		if (cPending)
+		{
+			delete aPending[nCallId];
+			if (bResolved)
+				cPending.resolve(sValue);
+			else
+				cPending.reject(sValue);
+		}
+	};
+
+	// state that c++ has set, changes arrive as a flat object of dotted paths and their new values, null removes a value
+	var aPatchListeners = [];
+	window.native.model = {};
+	window.native.onpatch = function(fListener)
+	{
+		aPatchListeners.push(fListener);
+	};
+
+	window.native._patch = function(cChanges)
+	{
+		for (var sPath in cChanges)
+		{
+			var aKeys = sPath.split(".");
+			var cNode = window.native.model;
+			for (var i = 0; i < aKeys.length - 1; i++)
+			{
+				if (typeof cNode[aKeys[i]] !== "object" || cNode[aKeys[i]] === null)
+					cNode[aKeys[i]] = {};
+				cNode = cNode[aKeys[i]];
+			}
+			if (cChanges[sPath] === null)
+				delete cNode[aKeys[aKeys.length - 1]];
+			else
+				cNode[aKeys[aKeys.length - 1]] = cChanges[sPath];
+		}
+		for (var i = 0; i < aPatchListeners.length; i++)
+			aPatchListeners[i](cChanges, window.native.model);
+	};
+
+	// blobs arrive base64 encoded, atob() is native and the bytes go straight into an ArrayBuffer
+	var aBinaryListeners = {};
+	window.native.onbinary = function(sName, fListener)
+	{
+		aBinaryListeners[sName] = aBinaryListeners[sName] || [];
+		aBinaryListeners[sName].push(fListener);
+	};
+
+	window.native._binary = function(sName, sBase64)
+	{
+		var aListeners = aBinaryListeners[sName];
+		if (!aListeners)
+			return;
+		var sBytes = window.atob(sBase64);
+		var aBytes = new Uint8Array(sBytes.length);
+		for (var i = 0; i < sBytes.length; i++)
+			aBytes[i] = sBytes.charCodeAt(i);
+		for (var i = 0; i < aListeners.length; i++)
+			aListeners[i](aBytes.buffer);
+	};
+})();
+);	// STRINGIFY
+
+
+//[-------------------------------------------------------]
+//[ Undefine helper macro                                 ]
+//[-------------------------------------------------------]
+#undef STRINGIFY
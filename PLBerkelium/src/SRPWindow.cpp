@@ -22,6 +22,17 @@ namespace PLBerkelium {
 pl_implement_class(SRPWindow)
 
 
+//[-------------------------------------------------------]
+//[ Internal data                                         ]
+//[-------------------------------------------------------]
+namespace {
+
+	// revision of the z-order of all windows, see SRPWindow::GetZOrderRevision()
+	uint32 g_nZOrderRevision = 0;
+
+}
+
+
 //[-------------------------------------------------------]
 //[ Functions		                                      ]
 //[-------------------------------------------------------]
@@ -37,22 +48,101 @@ SRPWindow::SRPWindow(const String &sName) :
 	m_pTextureBuffer(nullptr),
 	m_pTextureBufferNew(nullptr),
 	m_cImage(),
+	m_nTextureWidth(0),
+	m_nTextureHeight(0),
+	m_nImageWidth(0),
+	m_nImageHeight(0),
+	m_nTexturePaintedWidth(0),
+	m_nTexturePaintedHeight(0),
+	m_nTextureAllocationCount(0),
+	m_pTexturePool(nullptr),
+	m_pTextureAtlas(nullptr),
+	m_psAtlasRect(nullptr),
+	m_psAtlasRectOld(nullptr),
 	m_psWindowsData(new sWindowsData),
 	m_bInitialized(false),
 	m_bReadyToDraw(false),
 	m_pBerkeliumContext(nullptr),
 	m_pToolTip(nullptr),
 	m_bToolTipEnabled(false),
-	m_pmapDefaultCallBacks(new HashMap<String, sCallBack*>),
-	m_pmapCallBackFunctions(new HashMap<PLCore::String, PLCore::DynFuncPtr>),
+	m_ppDefaultCallBacks(new sCallBack*[NUMOFDEFAULTCALLBACKS]),
+	m_pmapCallBackFunctions(new HashMap<PLCore::String, sCallBackFunction*>),
+	m_lstCallBackFunctionTable(),
 	m_bIgnoreBufferUpdate(false),
-	m_pmapWidgets(new HashMap<Berkelium::Widget*, sWidget*>)
-{
-	// we need to create a berkelium context
-	// it might be wise to centralize the context back to the Gui class because each context is represented my a Berkelium.exe process on runtime
-	// the only downside of this is when a window crashes it needs to refresh all windows within the context so they will lose their current state
-	//todo: [10-07-2012 Icefire] this needs to be moved back to gui
-	CreateBerkeliumContext();
+	m_pmapWidgets(new HashMap<Berkelium::Widget*, sWidget*>),
+	m_bFrozen(false),
+	m_nAutoFreezeTime(0),
+	m_nLastActivityTime(0),
+	m_pBerkeliumThread(nullptr),
+	m_plstDefaultCallBackEvents(nullptr),
+	m_plstResizePreviewWindows(nullptr),
+	m_psBootstrapScript(nullptr),
+	m_nNumOfStartLoadingScripts(0),
+	m_nCreateTime(0),
+	m_nCreateRequestTime(0),
+	m_nFirstPaintLatency(0),
+	m_nFirstCallBackLatency(0),
+	m_pPublishedBerkeliumWindow(nullptr),
+	m_nCreateCommandMark(0),
+	m_bBerkeliumWindowCreated(false),
+	m_pPaintQueue(new SPSCQueue<sBrowserEvent*>),
+	m_pEventQueue(new SPSCQueue<sBrowserEvent*>),
+	m_nUnresponsivePolicy(UnresponsiveNone),
+	m_nUnresponsiveTimeout(10000),
+	m_bUnresponsive(false),
+	m_bUnresponsiveReloaded(false),
+	m_nUnresponsiveStartTime(0),
+	m_nMaxUnresponsiveTime(0),
+	m_nUnresponsiveCount(0),
+	m_nTypedCallBackCount(0),
+	m_nTypedCallBackTime(0),
+	m_nStringCallBackCount(0),
+	m_nStringCallBackTime(0),
+	m_nNativePostBatchCount(0),
+	m_nNativePostMessageCount(0),
+	m_plstCoalescedCallBacks(new List<sCoalescedCallBack*>),
+	m_pmapCoalescedCallBacks(new HashMap<String, sCoalescedCallBack*>),
+	m_nCoalescedDroppedCount(0),
+	m_nCoalescedDispatchedCount(0),
+	m_lstQueuedJavascript(),
+	m_lstPendingJavascript(),
+	m_pmapQueuedJavascriptKeys(new HashMap<String, uint32>),
+	m_nReplacedJavascriptCount(0),
+	m_nFlushedJavascriptCount(0),
+	m_nCurrentCallId(0),
+	m_bCurrentCallDeferred(false),
+	m_cSettledCallBacksMutex(),
+	m_lstSettledCallBacks(),
+	m_pmapState(new HashMap<String, sStateValue*>),
+	m_lstDirtyState(),
+	m_pmapStateObjects(new HashMap<String, sStateObject*>),
+	m_nStateValueCount(0),
+	m_nBinaryByteCount(0),
+	m_nBinaryEncodeTime(0),
+	m_bAlphaHitTest(false),
+	m_nAlphaHitTestThreshold(16),
+	m_pCoverageMask(nullptr),
+	m_nCoverageMaskWidth(0),
+	m_nCoverageMaskHeight(0),
+	m_nPendingInputTime(0),
+	m_nPendingInputCommand(0),
+	m_nPaintedInputTime(0),
+	m_bResizePreview(false),
+	m_nPreviewWidth(0),
+	m_nPreviewHeight(0),
+	m_nPreviewStartTime(0),
+	m_nPreviewChangeTime(0),
+	m_nResizeStableTime(100),
+	m_nMaxPreviewTime(250),
+	m_nResizeCount(0),
+	m_nPreviewResizeCount(0)
+{
+	MemoryManager::Set(m_nUnresponsiveHistogram, 0, sizeof(m_nUnresponsiveHistogram));
+	MemoryManager::Set(m_sInputLatency, 0, sizeof(m_sInputLatency));
+	MemoryManager::Set(m_ppDefaultCallBacks, 0, sizeof(sCallBack*) * NUMOFDEFAULTCALLBACKS);
+
+	// the berkelium context and window are created on demand by CreateBerkeliumWindow()
+	// each context is represented by a Berkelium.exe process on runtime, so windows that are never shown never cost us one
 }
 
 
@@ -60,17 +150,51 @@ SRPWindow::~SRPWindow()
 {
 	// we should clear the callbacks
 	RemoveCallBacks();
+	delete [] m_ppDefaultCallBacks;
 	// we destroy the used berkelium window
 	DestroyBerkeliumWindow();
 	// destroy the context
 	DestroyContext();
+	if (m_pBerkeliumThread)
+	{
+		// wait until the berkelium thread has destroyed the window, it will not send us anything after that
+		m_pBerkeliumThread->Flush();
+	}
 	// destroy the tool tip window
 	DestroyToolTipWindow();
 	// cleanup
-	if (nullptr != m_pVertexBuffer)
+	ClearBrowserEvents();
+	delete m_pPaintQueue;
+	delete m_pEventQueue;
+	delete [] m_pCoverageMask;
+	ClearCoalescedCallBacks();
+	delete m_plstCoalescedCallBacks;
+	delete m_pmapCoalescedCallBacks;
+	delete m_pmapQueuedJavascriptKeys;
+	Iterator<sSettledCallBack*> cSettledIterator = m_lstSettledCallBacks.GetIterator();
+	while (cSettledIterator.HasNext())
+	{
+		delete cSettledIterator.Next();
+	}
+	Iterator<sStateValue*> cStateIterator = m_pmapState->GetIterator();
+	while (cStateIterator.HasNext())
+	{
+		delete cStateIterator.Next();
+	}
+	delete m_pmapState;
+	Iterator<sStateObject*> cStateObjectIterator = m_pmapStateObjects->GetIterator();
+	while (cStateObjectIterator.HasNext())
+	{
+		delete cStateObjectIterator.Next();
+	}
+	delete m_pmapStateObjects;
+	Iterator<sCallBackFunction*> cIterator = m_pmapCallBackFunctions->GetIterator();
+	while (cIterator.HasNext())
 	{
-		delete m_pVertexBuffer;
+		delete cIterator.Next();
 	}
+	delete m_pmapCallBackFunctions;
+	DestroyVertexBuffer(m_pVertexBuffer);
 	if (nullptr != m_pProgramWrapper)
 	{
 		delete m_pProgramWrapper;
@@ -83,19 +207,33 @@ SRPWindow::~SRPWindow()
 	{
 		delete m_pVertexShader;
 	}
-	if (nullptr != m_pTextureBuffer)
+	Iterator<sWidget*> cWidgetIterator = m_pmapWidgets->GetIterator();
+	while (cWidgetIterator.HasNext())
 	{
-		delete m_pTextureBuffer;
+		DestroyWidget(cWidgetIterator.Next());
 	}
-	if (nullptr != m_pTextureBufferNew)
+	delete m_pmapWidgets;
+	DestroyTextureBuffer(m_pTextureBuffer, m_nTextureWidth, m_nTextureHeight);
+	DestroyTextureBuffer(m_pTextureBufferNew, m_nImageWidth, m_nImageHeight);
+	if (m_pTextureAtlas)
 	{
-		delete m_pTextureBufferNew;
+		m_pTextureAtlas->Free(m_psAtlasRect);
+		m_pTextureAtlas->Free(m_psAtlasRectOld);
 	}
 }
 
 
 void SRPWindow::DebugToConsole(const String &sString)
 {
+	if (IsOnBerkeliumThread())
+	{
+		// the console is used by the render thread, the text is printed when the window processes its events
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventConsole, nullptr);
+		psEvent->sText = sString;
+		m_pEventQueue->Push(psEvent);
+		return;
+	}
+
 	//undone: [10-07-2012 Icefire] this should be deprecated when not needed anymore
 	System::GetInstance()->GetConsole().Print("PLBerkelium::SRPWindow - " + sString);
 }
@@ -103,6 +241,16 @@ void SRPWindow::DebugToConsole(const String &sString)
 
 void SRPWindow::Draw(Renderer &cRenderer, const SQCull &cCullQuery)
 {
+	if (m_pBerkeliumThread)
+	{
+		// apply the paints the berkelium thread has send us
+		ProcessPaintEvents();
+	}
+	if (m_bInitialized && m_psWindowsData->bIsVisable && !m_bBerkeliumWindowCreated && !m_bFrozen)
+	{
+		// the window has been made visible without Gui::SetWindowVisible(), create the berkelium window now
+		CreateBerkeliumWindow();
+	}
 	if (m_bReadyToDraw)
 	{
 		// draw the window and widgets if we are ready
@@ -114,13 +262,38 @@ void SRPWindow::Draw(Renderer &cRenderer, const SQCull &cCullQuery)
 
 void SRPWindow::onPaint(Berkelium::Window *win, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect)
 {
+	if (IsOnBerkeliumThread())
+	{
+		// the buffer is only valid during this call, copy it and let Draw() apply it
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventPaint, win);
+		CopyPaint(psEvent, sourceBuffer, sourceBufferRect, numCopyRects, copyRects, dx, dy, scrollRect);
+		m_pPaintQueue->Push(psEvent);
+		return;
+	}
+
+	// painting means the window is not idle
+	ResetIdleTime();
+
+	if (!m_nFirstPaintLatency && m_nCreateRequestTime)
+	{
+		// the first paint of the berkelium window
+		m_nFirstPaintLatency = System::GetInstance()->GetMicroseconds() - m_nCreateRequestTime;
+	}
+
+	if (!m_pBerkeliumThread)
+	{
+		// berkelium paints right now, with a thread the time of the paint event is used
+		MarkPaint(System::GetInstance()->GetMicroseconds(), 0);
+	}
+
 	if (!m_bIgnoreBufferUpdate)
 	{
 		if (m_psWindowsData->bNeedsFullUpdate)
 		{
 			// awaiting a full update disregard all partials ones until the full one comes in
-			BufferCopyFull(m_cImage.GetBuffer()->GetData(), m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect);
+			BufferCopyFull(m_cImage.GetBuffer()->GetData(), m_nImageWidth, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect);
 			BufferUploadToGPU();
+			UpdateCoverageMask(0, 0, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
 			m_psWindowsData->bNeedsFullUpdate = false;
 		}
 		else
@@ -128,22 +301,29 @@ void SRPWindow::onPaint(Berkelium::Window *win, const unsigned char *sourceBuffe
 			if (sourceBufferRect.width() == m_psWindowsData->nFrameWidth && sourceBufferRect.height() == m_psWindowsData->nFrameHeight)
 			{
 				// did not suspect a full update but got it anyway, it might happen and is ok
-				BufferCopyFull(m_cImage.GetBuffer()->GetData(), m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect);
+				BufferCopyFull(m_cImage.GetBuffer()->GetData(), m_nImageWidth, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect);
 				BufferUploadToGPU();
+				UpdateCoverageMask(0, 0, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
 			}
 			else
 			{
 				if (dx != 0 || dy != 0)
 				{
 					// a scroll has taken place
-					BufferCopyScroll(m_cImage.GetBuffer()->GetData(), m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects, dx, dy, scrollRect);
-					BufferUploadToGPU();
+					BufferCopyScroll(m_cImage.GetBuffer()->GetData(), m_nImageWidth, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects, dx, dy, scrollRect);
+					BufferUploadToGPU(1, &scrollRect);
+					// the scrolled content and the newly painted rectangles are both within the scroll rectangle
+					UpdateCoverageMask(scrollRect.left(), scrollRect.top(), scrollRect.width(), scrollRect.height());
 				}
 				else
 				{
 					// normal partial updates
-					BufferCopyRects(m_cImage.GetBuffer()->GetData(), m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects);
-					BufferUploadToGPU();
+					BufferCopyRects(m_cImage.GetBuffer()->GetData(), m_nImageWidth, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects);
+					BufferUploadToGPU(numCopyRects, copyRects);
+					for (size_t i = 0; i < numCopyRects; i++)
+					{
+						UpdateCoverageMask(copyRects[i].left(), copyRects[i].top(), copyRects[i].width(), copyRects[i].height());
+					}
 				}
 			}
 		}
@@ -161,8 +341,16 @@ void SRPWindow::onCreatedWindow(Berkelium::Window *win, Berkelium::Window *newWi
 
 VertexBuffer *SRPWindow::CreateVertexBuffer(const Vector2 &vPosition, const Vector2 &vImageSize)
 {
+	// the quads all look the same, a pooled one only needs to be filled
+	VertexBuffer *pVertexBuffer = m_pTexturePool ? m_pTexturePool->GetVertexBuffer() : nullptr;
+	if (pVertexBuffer)
+	{
+		UpdateVertexBuffer(pVertexBuffer, vPosition, vImageSize);
+		return pVertexBuffer;
+	}
+
 	// lets create a vertex buffer
-	VertexBuffer *pVertexBuffer = m_pCurrentRenderer->CreateVertexBuffer();
+	pVertexBuffer = m_pCurrentRenderer->CreateVertexBuffer();
 	if (pVertexBuffer)
 	{
 		// setup and allocate the vertex buffer
@@ -312,23 +500,32 @@ bool SRPWindow::Initialize(Renderer *pRenderer, const Vector2 &vPosition, const
 
 	if (m_pVertexBuffer && m_pProgramWrapper)
 	{
-		// create the image
-		m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, 1));
-		// create the texture buffer
-		m_pTextureBuffer = reinterpret_cast<TextureBuffer*>(pRenderer->CreateTextureBuffer2D(m_cImage, TextureBuffer::Unknown, 0));
+		// create the image with the size class of the window
+		m_nImageWidth = GetTextureCapacity(m_psWindowsData->nFrameWidth, 0);
+		m_nImageHeight = GetTextureCapacity(m_psWindowsData->nFrameHeight, 0);
+		m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_nImageWidth, m_nImageHeight, 1));
+		m_nTexturePaintedWidth = m_psWindowsData->nFrameWidth;
+		m_nTexturePaintedHeight = m_psWindowsData->nFrameHeight;
+		// a small window is drawn from the atlas, else create the texture buffer
+		m_psAtlasRect = m_pTextureAtlas ? m_pTextureAtlas->Allocate(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight) : nullptr;
+		if (!m_psAtlasRect)
+		{
+			m_pTextureBuffer = CreateTextureBuffer(m_cImage);
+			m_nTextureWidth = m_nImageWidth;
+			m_nTextureHeight = m_nImageHeight;
+		}
 
-		if (m_pTextureBuffer)
+		if (m_pTextureBuffer || m_psAtlasRect)
 		{
 			// create the image buffer
 			if (nullptr != m_cImage.GetBuffer()->GetData())
 			{
-				// create a berkelium window
-				CreateBerkeliumWindow();
-				// set the default window settings
-				SetWindowSettings();
-				// set the default callback functions
-				SetDefaultCallBackFunctions();
 				m_bInitialized = true;
+				if (m_psWindowsData->bIsVisable)
+				{
+					// create a berkelium window, hidden windows create theirs when they are shown or navigated
+					CreateBerkeliumWindow();
+				}
 				return true;
 			}
 			// image buffer could not be created
@@ -354,56 +551,182 @@ void SRPWindow::DestroyInstance() const
 
 void SRPWindow::DrawWindow()
 {
-	if (m_bInitialized && m_psWindowsData->bIsVisable) // should suffice
+	// a window that has moved into the atlas keeps drawing its texture until it has been painted there
+	// a window that has moved out of the atlas keeps drawing its old rect until its texture has been painted
+	const sAtlasRect *psAtlasRect = m_psAtlasRect ? m_psAtlasRect : m_psAtlasRectOld;
+	const bool bAtlas = (nullptr != psAtlasRect && nullptr == m_pTextureBuffer);
+	if (m_bInitialized && m_psWindowsData->bIsVisable && (bAtlas || m_pTextureBuffer)) // should suffice
 	{
-		// set the program
-		m_pCurrentRenderer->SetProgram(m_pProgramWrapper);
-		// set the render state to allow for transparency
-		m_pCurrentRenderer->SetRenderState(RenderState::BlendEnable, true);
+		// the window is drawn with the other windows of its atlas page, by the first of them that is drawn
+		const bool bBatched = bAtlas && psAtlasRect->bBatched;
+		uint32 nVertices = 4;
+		VertexBuffer *pVertexBuffer = bBatched ? m_pTextureAtlas->GetBatch(*psAtlasRect, nVertices) : m_pVertexBuffer;
 
-		//todo: [10-07-2012 Icefire] let (re)sizing be handled by the program uniform, see http://dev.pixellight.org/forum/viewtopic.php?f=6&t=503
+		if (pVertexBuffer)
 		{
-			const Rectangle &cViewportRect = m_pCurrentRenderer->GetViewport();
-			float fX1 = cViewportRect.vMin.x;
-			float fY1 = cViewportRect.vMin.y;
-			float fX2 = cViewportRect.vMax.x;
-			float fY2 = cViewportRect.vMax.y;
+			// set the program
+			m_pCurrentRenderer->SetProgram(m_pProgramWrapper);
+			// set the render state to allow for transparency
+			m_pCurrentRenderer->SetRenderState(RenderState::BlendEnable, true);
 
-			Matrix4x4 m_mObjectSpaceToClipSpace;
-			m_mObjectSpaceToClipSpace.OrthoOffCenter(fX1, fX2, fY1, fY2, -1.0f, 1.0f);
+			//todo: [10-07-2012 Icefire] let (re)sizing be handled by the program uniform, see http://dev.pixellight.org/forum/viewtopic.php?f=6&t=503
+			{
+				const Rectangle &cViewportRect = m_pCurrentRenderer->GetViewport();
+				float fX1 = cViewportRect.vMin.x;
+				float fY1 = cViewportRect.vMin.y;
+				float fX2 = cViewportRect.vMax.x;
+				float fY2 = cViewportRect.vMax.y;
 
-			// create program uniform
-			ProgramUniform *pProgramUniform = m_pProgramWrapper->GetUniform("ObjectSpaceToClipSpaceMatrix");
-			if (pProgramUniform)
-				pProgramUniform->Set(m_mObjectSpaceToClipSpace);
+				Matrix4x4 m_mObjectSpaceToClipSpace;
+				m_mObjectSpaceToClipSpace.OrthoOffCenter(fX1, fX2, fY1, fY2, -1.0f, 1.0f);
 
-			const int nTextureUnit = m_pProgramWrapper->Set("TextureMap", m_pTextureBuffer);
-			if (nTextureUnit >= 0)
-			{
-				// set sampler states
-				m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::AddressU, TextureAddressing::Clamp);
-				m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::AddressV, TextureAddressing::Clamp);
-				m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::MagFilter, TextureFiltering::None);
-				m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::MinFilter, TextureFiltering::None);
-				m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::MipFilter, TextureFiltering::None);
+				// create program uniform
+				ProgramUniform *pProgramUniform = m_pProgramWrapper->GetUniform("ObjectSpaceToClipSpaceMatrix");
+				if (pProgramUniform)
+					pProgramUniform->Set(m_mObjectSpaceToClipSpace);
+
+				// the texture can be bigger than the window, only its upper left part is drawn
+				// in the atlas the window starts at its rect, the quads of a batch have their own texture coordinates
+				// until a resized window has been painted again, the part that has been painted is stretched over the quad
+				ProgramUniform *pScaleUniform = m_pProgramWrapper->GetUniform("TextureCoordinateScale");
+				ProgramUniform *pOffsetUniform = m_pProgramWrapper->GetUniform("TextureCoordinateOffset");
+				if (bBatched)
+				{
+					if (pScaleUniform)
+						pScaleUniform->Set(1.0f, 1.0f);
+					if (pOffsetUniform)
+						pOffsetUniform->Set(0.0f, 0.0f);
+				}
+				else if (bAtlas)
+				{
+					if (pScaleUniform)
+						pScaleUniform->Set(float(m_nTexturePaintedWidth) / float(TEXTUREATLASPAGESIZE), float(m_nTexturePaintedHeight) / float(TEXTUREATLASPAGESIZE));
+					if (pOffsetUniform)
+						pOffsetUniform->Set(float(psAtlasRect->nX) / float(TEXTUREATLASPAGESIZE), float(psAtlasRect->nY) / float(TEXTUREATLASPAGESIZE));
+				}
+				else
+				{
+					if (pScaleUniform && m_nTextureWidth > 0 && m_nTextureHeight > 0)
+						pScaleUniform->Set(float(m_nTexturePaintedWidth) / float(m_nTextureWidth), float(m_nTexturePaintedHeight) / float(m_nTextureHeight));
+					if (pOffsetUniform)
+						pOffsetUniform->Set(0.0f, 0.0f);
+				}
+
+				// an unresponsive window shows its last frame grayed out
+				pProgramUniform = m_pProgramWrapper->GetUniform("ColorFactor");
+				if (pProgramUniform)
+				{
+					if (m_bUnresponsive && (m_nUnresponsivePolicy & UnresponsiveOverlay))
+						pProgramUniform->Set(0.5f, 0.5f, 0.5f, 1.0f);
+					else
+						pProgramUniform->Set(1.0f, 1.0f, 1.0f, 1.0f);
+				}
+
+				const int nTextureUnit = m_pProgramWrapper->Set("TextureMap", bAtlas ? m_pTextureAtlas->GetTextureBuffer(*psAtlasRect) : m_pTextureBuffer);
+				if (nTextureUnit >= 0)
+				{
+					// set sampler states
+					m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::AddressU, TextureAddressing::Clamp);
+					m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::AddressV, TextureAddressing::Clamp);
+					m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::MagFilter, TextureFiltering::None);
+					m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::MinFilter, TextureFiltering::None);
+					m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::MipFilter, TextureFiltering::None);
+				}
+
+				// set vertex attributes
+				m_pProgramWrapper->Set("VertexPosition", pVertexBuffer, VertexBuffer::Position);
+				m_pProgramWrapper->Set("VertexTexCoord", pVertexBuffer, VertexBuffer::TexCoord);
 			}
 
-			// set vertex attributes
-			m_pProgramWrapper->Set("VertexPosition", m_pVertexBuffer, VertexBuffer::Position);
-			m_pProgramWrapper->Set("VertexTexCoord", m_pVertexBuffer, VertexBuffer::TexCoord);
+			// draw primitives
+			m_pCurrentRenderer->DrawPrimitives(bBatched ? Primitive::TriangleList : Primitive::TriangleStrip, 0, nVertices);
 		}
 
-		// draw primitives
-		m_pCurrentRenderer->DrawPrimitives(Primitive::TriangleStrip, 0, 4);
+		if (m_nPaintedInputTime)
+		{
+			// the painted input is now on screen
+			AddInputLatency(LatencyDraw, System::GetInstance()->GetMicroseconds() - m_nPaintedInputTime);
+			m_nPaintedInputTime = 0;
+		}
 	}
 }
 
 
-void SRPWindow::BufferCopyFull(uint8 *pImageBuffer, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect)
+void SRPWindow::BufferCopyFull(uint8 *pImageBuffer, const int &nPitch, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect)
 {
 	if (sourceBufferRect.left() == 0 && sourceBufferRect.top() == 0 && sourceBufferRect.right() == nWidth && sourceBufferRect.bottom() == nHeight)
 	{
-		MemoryManager::Copy(pImageBuffer, sourceBuffer, sourceBufferRect.right() * sourceBufferRect.bottom() * 4);
+		if (nPitch == nWidth)
+		{
+			MemoryManager::Copy(pImageBuffer, sourceBuffer, sourceBufferRect.right() * sourceBufferRect.bottom() * 4);
+		}
+		else
+		{
+			// the image is wider than the frame, copy row by row
+			for (int nRow = 0; nRow < nHeight; nRow++)
+			{
+				MemoryManager::Copy(&pImageBuffer[nRow * nPitch * 4], sourceBuffer + nRow * nWidth * 4, nWidth * 4);
+			}
+		}
+	}
+}
+
+
+int SRPWindow::GetTextureCapacity(const int &nSize, const int &nCapacity)
+{
+	if (nSize <= nCapacity && nSize >= nCapacity / TEXTURESHRINKDIVISOR)
+	{
+		// the size fits and does not waste too much
+		return nCapacity;
+	}
+	if (nCapacity == 0)
+	{
+		// the first allocation gets no room to grow, most windows never change their size
+		return TexturePool::GetSizeClass(nSize);
+	}
+
+	// leave room to grow, rounded to a size class so that the texture can be pooled
+	return TexturePool::GetSizeClass(nSize + nSize / TEXTUREGROWTHDIVISOR);
+}
+
+
+TextureBuffer *SRPWindow::CreateTextureBuffer(const Image &cImage)
+{
+	if (m_pTexturePool)
+	{
+		// a texture the pool hands back is no allocation
+		const uint32 nCreatedTextureCount = m_pTexturePool->GetCreatedTextureCount();
+		TextureBuffer *pTextureBuffer = m_pTexturePool->GetTextureBuffer(cImage);
+		m_nTextureAllocationCount += m_pTexturePool->GetCreatedTextureCount() - nCreatedTextureCount;
+		return pTextureBuffer;
+	}
+	m_nTextureAllocationCount++;
+	return reinterpret_cast<TextureBuffer*>(m_pCurrentRenderer->CreateTextureBuffer2D(cImage, TextureBuffer::Unknown, 0));
+}
+
+
+void SRPWindow::DestroyTextureBuffer(TextureBuffer *pTextureBuffer, const int &nWidth, const int &nHeight)
+{
+	if (m_pTexturePool)
+	{
+		m_pTexturePool->ReleaseTextureBuffer(pTextureBuffer, nWidth, nHeight);
+	}
+	else if (nullptr != pTextureBuffer)
+	{
+		delete pTextureBuffer;
+	}
+}
+
+
+void SRPWindow::DestroyVertexBuffer(VertexBuffer *pVertexBuffer)
+{
+	if (m_pTexturePool)
+	{
+		m_pTexturePool->ReleaseVertexBuffer(pVertexBuffer);
+	}
+	else if (nullptr != pVertexBuffer)
+	{
+		delete pVertexBuffer;
 	}
 }
 
@@ -414,6 +737,7 @@ bool SRPWindow::AddSceneRenderPass(SceneRenderer *pSceneRenderer)
 	if (pSceneRenderer->Add(*reinterpret_cast<SceneRendererPass*>(this)))
 	{
 		m_pCurrentSceneRenderer = pSceneRenderer;
+		g_nZOrderRevision++;
 		return true;
 	}
 	else
@@ -430,6 +754,7 @@ bool SRPWindow::RemoveSceneRenderPass()
 		// remove scene render pass
 		if (m_pCurrentSceneRenderer->Remove(*reinterpret_cast<SceneRendererPass*>(this)))
 		{
+			g_nZOrderRevision++;
 			return true;
 		}
 		else
@@ -445,16 +770,183 @@ bool SRPWindow::RemoveSceneRenderPass()
 
 void SRPWindow::CreateBerkeliumWindow()
 {
-	// check if berkelium window is already created
+	if (m_bFrozen)
+	{
+		// a frozen window needs its image back before it can receive paints
+		Thaw();
+		return;
+	}
+
+	// check if berkelium window is already created, windows that are not initialized (like the dummy window) never create one
+	if (!m_bBerkeliumWindowCreated && m_bInitialized)
+	{
+		m_bBerkeliumWindowCreated = true;
+		// the latencies are measured from now on, no matter on which thread the window is created
+		m_nCreateRequestTime = System::GetInstance()->GetMicroseconds();
+		m_nFirstPaintLatency = 0;
+		m_nFirstCallBackLatency = 0;
+		// create the berkelium context and window, the default callback functions need to be bound before navigating
+		CreateBerkeliumWindowInstance(m_psBootstrapScript);
+		if (!m_pBerkeliumThread && !m_pBerkeliumWindow)
+		{
+			// the berkelium window could not be created
+			m_bBerkeliumWindowCreated = false;
+			return;
+		}
+		// bind the callback functions that where added while there was no berkelium window
+		BindCallBackFunctions();
+		// set the default window settings
+		SetWindowSettings(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, m_psWindowsData->bTransparent, m_psWindowsData->sUrl);
+	}
+}
+
+
+void SRPWindow::CreateBerkeliumWindowInstance(const sBootstrapScript *psBootstrapScript)
+{
+	if (m_pBerkeliumThread && !IsOnBerkeliumThread())
+	{
+		// the berkelium thread publishes the window with EventCreated, only the one of this command is taken
+		m_nCreateCommandMark = m_pBerkeliumThread->GetNumOfPushedCommands();
+		// the berkelium thread does not count the scripts, the bootstrap script or the built-in script is added on creation
+		m_nNumOfStartLoadingScripts = 1;
+		// the script goes with the command, the berkelium thread never reads the script pointer that we may change meanwhile
+		QueueCommand(sBrowserCommand::CommandCreate, 0, 0, 0, 0, "", "", const_cast<sBootstrapScript*>(psBootstrapScript));
+		return;
+	}
+
 	if (!m_pBerkeliumWindow)
 	{
+		if (!m_pBerkeliumContext)
+		{
+			// create the berkelium context
+			CreateBerkeliumContext();
+		}
 		// create berkelium window
+		const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
 		m_pBerkeliumWindow = Berkelium::Window::create(m_pBerkeliumContext);
+		if (m_pBerkeliumWindow)
+		{
+			// set the default callback functions
+			if (!m_pBerkeliumThread)
+				m_nNumOfStartLoadingScripts = 0;
+			SetDefaultCallBackFunctions(psBootstrapScript);
+		}
+		const uint64 nCreateTime = System::GetInstance()->GetMicroseconds() - nStartTime;
+
+		if (IsOnBerkeliumThread())
+		{
+			// the render thread reads the window and the time when it processes the event
+			sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventCreated, m_pBerkeliumWindow);
+			psEvent->nParam[0] = int(nCreateTime);
+			m_pEventQueue->Push(psEvent);
+		}
+		else
+		{
+			m_nCreateTime = nCreateTime;
+		}
+	}
+}
+
+
+void SRPWindow::NavigateTo(const String &sUrl)
+{
+	// remember the url so that it is used on creation and recreation
+	m_psWindowsData->sUrl = sUrl;
+	// the last known url of a frozen window should not override the url we just set
+	m_sLastKnownUrl = sUrl;
+
+	if (m_bBerkeliumWindowCreated)
+	{
+		// navigate the existing berkelium window
+		SendNavigateTo(sUrl);
+	}
+	else
+	{
+		// create (or thaw) the berkelium window, this will navigate to the url we just set
+		CreateBerkeliumWindow();
+	}
+}
+
+
+bool SRPWindow::Freeze()
+{
+	if (m_bFrozen || !m_bReadyToDraw || !m_bBerkeliumWindowCreated)
+	{
+		// there is no snapshot to keep or we are already frozen
+		return false;
+	}
+
+	// we destroy the berkelium window and its context, the texture keeps the last painted frame
+	DestroyBerkeliumWindow();
+	DestroyContext();
+
+	// release the cpu copy of the buffer
+	m_cImage = Image();
+
+	m_bFrozen = true;
+	return true;
+}
+
+
+bool SRPWindow::Thaw()
+{
+	if (!m_bFrozen)
+	{
+		// nothing to thaw
+		return false;
+	}
+	m_bFrozen = false;
+
+	// recreate the image, the texture keeps being drawn until the first full paint comes in
+	m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_nImageWidth, m_nImageHeight, 1));
+	m_psWindowsData->bNeedsFullUpdate = true;
+
+	if (m_sLastKnownUrl != "")
+	{
+		// we navigate to where we left off
+		m_psWindowsData->sUrl = m_sLastKnownUrl;
+	}
+
+	// recreate the berkelium window
+	CreateBerkeliumWindow();
+	ResetIdleTime();
+	return true;
+}
+
+
+bool SRPWindow::IsFrozen() const
+{
+	return m_bFrozen;
+}
+
+
+void SRPWindow::SetAutoFreeze(const uint32 &nSeconds)
+{
+	m_nAutoFreezeTime = uint64(nSeconds) * 1000;
+	ResetIdleTime();
+}
+
+
+void SRPWindow::ResetIdleTime()
+{
+	m_nLastActivityTime = Timing::GetInstance()->GetPastTime();
+}
+
+
+void SRPWindow::UpdateAutoFreeze()
+{
+	if (m_nAutoFreezeTime > 0 && !m_bFrozen && m_bBerkeliumWindowCreated && m_psWindowsData->bLoaded)
+	{
+		if ((Timing::GetInstance()->GetPastTime() - m_nLastActivityTime) > m_nAutoFreezeTime)
+		{
+			// no paints and no input for a while, release the browser
+			Freeze();
+		}
 	}
 }
 
 
-void SRPWindow::BufferCopyRects(PLCore::uint8 *pImageBuffer, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects)
+void SRPWindow::BufferCopyRects(PLCore::uint8 *pImageBuffer, const int &nPitch, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects)
 {
 	for (size_t i = 0; i < numCopyRects; i++)
 	{
@@ -467,7 +959,7 @@ void SRPWindow::BufferCopyRects(PLCore::uint8 *pImageBuffer, int &nWidth, int &n
 
 		for(int nCrHeightIndex = 0; nCrHeightIndex < nCrHeight; nCrHeightIndex++)
 		{
-			int nStartPosition = (nWidth - nBrLeft) * nBrTop + (nBrTop * nBrLeft) + nBrLeft + (nWidth * nCrHeightIndex);
+			int nStartPosition = (nPitch - nBrLeft) * nBrTop + (nBrTop * nBrLeft) + nBrLeft + (nPitch * nCrHeightIndex);
 			MemoryManager::Copy(
 				&pImageBuffer[nStartPosition * 4],
 				sourceBuffer + (nCrLeft + (nCrHeightIndex + nCrTop) * sourceBufferRect.width()) * 4,
@@ -478,31 +970,77 @@ void SRPWindow::BufferCopyRects(PLCore::uint8 *pImageBuffer, int &nWidth, int &n
 }
 
 
-void SRPWindow::BufferUploadToGPU()
+void SRPWindow::BufferUploadToGPU(size_t numCopyRects, const Berkelium::Rect *copyRects)
 {
 	if (m_bInitialized)
 	{
 		// upload data to GPU
-		if (m_pTextureBufferNew)
+		if (m_psAtlasRect)
+		{
+			// the atlas page is uploaded once for all its windows when it is drawn
+			if (numCopyRects && !m_pTextureBuffer && !m_pTextureBufferNew &&
+				m_nTexturePaintedWidth == m_psWindowsData->nFrameWidth && m_nTexturePaintedHeight == m_psWindowsData->nFrameHeight)
+			{
+				// the rect holds the rest of the window already, only what has been painted is copied
+				for (size_t i = 0; i < numCopyRects; i++)
+				{
+					m_pTextureAtlas->CopyRegionToRect(*m_psAtlasRect, m_cImage.GetBuffer()->GetData(), m_nImageWidth, copyRects[i].left(), copyRects[i].top(), copyRects[i].width(), copyRects[i].height());
+				}
+			}
+			else
+			{
+				m_pTextureAtlas->CopyToRect(*m_psAtlasRect, m_cImage.GetBuffer()->GetData(), m_nImageWidth, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
+			}
+			if (m_pTextureBuffer || m_pTextureBufferNew)
+			{
+				// the window has moved into the atlas
+				DestroyTextureBuffer(m_pTextureBuffer, m_nTextureWidth, m_nTextureHeight);
+				DestroyTextureBuffer(m_pTextureBufferNew, m_nImageWidth, m_nImageHeight);
+				m_pTextureBuffer = nullptr;
+				m_pTextureBufferNew = nullptr;
+				m_nTextureWidth = 0;
+				m_nTextureHeight = 0;
+			}
+		}
+		else if (m_pTextureBufferNew)
 		{
 			m_pTextureBufferNew->CopyDataFrom(0, TextureBuffer::R8G8B8A8, m_cImage.GetBuffer()->GetData());
-			if (m_pTextureBuffer)
-				delete m_pTextureBuffer;
+			DestroyTextureBuffer(m_pTextureBuffer, m_nTextureWidth, m_nTextureHeight);
 			m_pTextureBuffer = m_pTextureBufferNew;
 			m_pTextureBufferNew = nullptr;
-			UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(m_psWindowsData->nFrameWidth), float(m_psWindowsData->nFrameHeight)));
+			m_nTextureWidth = m_nImageWidth;
+			m_nTextureHeight = m_nImageHeight;
+			// a preview that started since keeps being stretched
+			const Vector2i vSize = GetPreviewSize();
+			UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(vSize.x), float(vSize.y)));
 		}
-		else
+		else if (m_pTextureBuffer)
 		{
 			m_pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, m_cImage.GetBuffer()->GetData());
 		}
+		else
+		{
+			// the window has moved out of the atlas
+			m_pTextureBuffer = CreateTextureBuffer(m_cImage);
+			m_nTextureWidth = m_nImageWidth;
+			m_nTextureHeight = m_nImageHeight;
+		}
+		if (m_psAtlasRectOld && m_pTextureBuffer)
+		{
+			// the window has moved out of the atlas and no longer draws its old rect
+			m_pTextureAtlas->Free(m_psAtlasRectOld);
+			m_psAtlasRectOld = nullptr;
+		}
+		// the drawn texture or rect shows the window at its current size now
+		m_nTexturePaintedWidth = m_psWindowsData->nFrameWidth;
+		m_nTexturePaintedHeight = m_psWindowsData->nFrameHeight;
 		// set state for future usage
 		if (!m_bReadyToDraw) m_bReadyToDraw = true;
 	}
 }
 
 
-void SRPWindow::BufferCopyScroll(PLCore::uint8 *pImageBuffer, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect)
+void SRPWindow::BufferCopyScroll(PLCore::uint8 *pImageBuffer, const int &nPitch, int &nWidth, int &nHeight, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect)
 {
 	Berkelium::Rect scrolled_rect = scrollRect.translate(-dx, -dy);
 	Berkelium::Rect scrolled_shared_rect = scrollRect.intersect(scrolled_rect);
@@ -512,7 +1050,7 @@ void SRPWindow::BufferCopyScroll(PLCore::uint8 *pImageBuffer, int &nWidth, int &
 		int hig = scrollRect.height();
 		int top = scrollRect.top();
 		int left = scrollRect.left();
-		int tw = nWidth;
+		int tw = nPitch;
 
 		if (dy < 0) // scroll down
 		{
@@ -556,7 +1094,7 @@ void SRPWindow::BufferCopyScroll(PLCore::uint8 *pImageBuffer, int &nWidth, int &
 
 		for(int nCrHeightIndex = 0; nCrHeightIndex < nCrHeight; nCrHeightIndex++)
 		{
-			int nStartPosition = (nWidth - nBrLeft) * nBrTop + (nBrTop * nBrLeft) + nBrLeft + (nWidth * nCrHeightIndex);
+			int nStartPosition = (nPitch - nBrLeft) * nBrTop + (nBrTop * nBrLeft) + nBrLeft + (nPitch * nCrHeightIndex);
 			MemoryManager::Copy(
 				&pImageBuffer[nStartPosition * 4],
 				sourceBuffer + (nCrLeft + (nCrHeightIndex + nCrTop) * sourceBufferRect.width()) * 4,
@@ -569,12 +1107,39 @@ void SRPWindow::BufferCopyScroll(PLCore::uint8 *pImageBuffer, int &nWidth, int &
 
 void SRPWindow::onLoad(Berkelium::Window *win)
 {
+	if (IsOnBerkeliumThread())
+	{
+		m_pEventQueue->Push(CreateBrowserEvent(sBrowserEvent::EventLoad, win));
+		return;
+	}
+
 	m_psWindowsData->bLoaded = true;
+	// the new page starts with an empty model
+	MarkStateDirty();
+
+	if (m_lstPendingJavascript.GetNumOfElements())
+	{
+		// the javascript that was executed before the berkelium window was created goes to its first page
+		const Array<String> lstPendingJavascript = m_lstPendingJavascript;
+		m_lstPendingJavascript.Clear();
+		for (uint32 i = 0; i < lstPendingJavascript.GetNumOfElements(); i++)
+		{
+			ExecuteJavascript(lstPendingJavascript[i]);
+		}
+	}
 }
 
 
 void SRPWindow::onLoadingStateChanged(Berkelium::Window *win, bool isLoading)
 {
+	if (IsOnBerkeliumThread())
+	{
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventLoadingStateChanged, win);
+		psEvent->nParam[0] = isLoading;
+		m_pEventQueue->Push(psEvent);
+		return;
+	}
+
 	if (isLoading)
 	{
 		m_psWindowsData->bLoaded = false;
@@ -586,8 +1151,13 @@ void SRPWindow::MoveToFront()
 {
 	if (m_bInitialized && m_pCurrentSceneRenderer)
 	{
-		// move scene render pass to front
-		m_pCurrentSceneRenderer->MoveElement(m_pCurrentSceneRenderer->GetIndex(*reinterpret_cast<SceneRendererPass*>(this)), m_pCurrentSceneRenderer->GetNumOfElements() - 1);
+		const int nIndex = m_pCurrentSceneRenderer->GetIndex(*reinterpret_cast<SceneRendererPass*>(this));
+		if (nIndex != int(m_pCurrentSceneRenderer->GetNumOfElements()) - 1)
+		{
+			// move scene render pass to front
+			m_pCurrentSceneRenderer->MoveElement(nIndex, m_pCurrentSceneRenderer->GetNumOfElements() - 1);
+			g_nZOrderRevision++;
+		}
 	}
 }
 
@@ -626,6 +1196,12 @@ void SRPWindow::onScriptAlert(Berkelium::Window *win, Berkelium::WideString mess
 
 void SRPWindow::onCrashed(Berkelium::Window *win)
 {
+	if (IsOnBerkeliumThread())
+	{
+		m_pEventQueue->Push(CreateBrowserEvent(sBrowserEvent::EventCrashed, win));
+		return;
+	}
+
 	// the window has crashed so we should recreate it
 	RecreateWindow();
 }
@@ -633,503 +1209,1889 @@ void SRPWindow::onCrashed(Berkelium::Window *win)
 
 void SRPWindow::onUnresponsive(Berkelium::Window *win)
 {
-	//undone: [10-07-2012 Icefire] not used or implemented
+	if (IsOnBerkeliumThread())
+	{
+		m_pEventQueue->Push(CreateBrowserEvent(sBrowserEvent::EventUnresponsive, win));
+		return;
+	}
+
 	DebugToConsole("onUnresponsive()\n");
+	if (!m_bUnresponsive)
+	{
+		// the watchdog takes it from here
+		m_bUnresponsive = true;
+		m_bUnresponsiveReloaded = false;
+		m_nUnresponsiveStartTime = Timing::GetInstance()->GetPastTime();
+		m_nUnresponsiveCount++;
+	}
 }
 
 
 void SRPWindow::onResponsive(Berkelium::Window *win)
 {
-	//undone: [10-07-2012 Icefire] not used or implemented
+	if (IsOnBerkeliumThread())
+	{
+		m_pEventQueue->Push(CreateBrowserEvent(sBrowserEvent::EventResponsive, win));
+		return;
+	}
+
 	DebugToConsole("onResponsive()\n");
+	EndUnresponsive();
 }
 
 
-void SRPWindow::onAddressBarChanged(Berkelium::Window *win, Berkelium::URLString newURL)
+void SRPWindow::SetUnresponsivePolicy(const uint32 &nPolicy, const uint32 &nTimeout)
 {
-	m_sLastKnownUrl = newURL.data();
+	m_nUnresponsivePolicy = nPolicy;
+	m_nUnresponsiveTimeout = uint64(nTimeout) * 1000;
 }
 
 
-void SRPWindow::RecreateWindow()
+uint32 SRPWindow::GetUnresponsivePolicy() const
 {
-	m_bInitialized = false;
-	// destroy the berkelium window
-	DestroyBerkeliumWindow();
-	// destroy the context
-	DestroyContext();
-	// create a new context
-	CreateBerkeliumContext();
-	// create a new berkelium window
-	CreateBerkeliumWindow();
-	// set the window settings
-	SetWindowSettings();
-	m_bInitialized = true;
+	return m_nUnresponsivePolicy;
 }
 
 
-void SRPWindow::CreateBerkeliumContext()
+bool SRPWindow::IsUnresponsive() const
 {
-	//todo: [10-07-2012 Icefire] should move back to gui
-	m_pBerkeliumContext = Berkelium::Context::create();
+	return m_bUnresponsive;
 }
 
 
-void SRPWindow::DestroyContext()
+bool SRPWindow::IsInputBlocked() const
 {
-	//todo: [10-07-2012 Icefire] should move back to gui
-	m_pBerkeliumContext->destroy();
-	m_pBerkeliumContext = nullptr;
+	return (m_bUnresponsive && (m_nUnresponsivePolicy & UnresponsiveBlockInput));
 }
 
 
-Berkelium::Window *SRPWindow::GetBerkeliumWindow() const
+uint64 SRPWindow::GetUnresponsiveTime() const
 {
-	return m_pBerkeliumWindow;
+	return m_bUnresponsive ? (Timing::GetInstance()->GetPastTime() - m_nUnresponsiveStartTime) : 0;
 }
 
 
-sWindowsData *SRPWindow::GetData() const
+uint64 SRPWindow::GetMaxUnresponsiveTime() const
 {
-	return m_psWindowsData;
+	return m_nMaxUnresponsiveTime;
 }
 
 
-String SRPWindow::GetName() const
+uint32 SRPWindow::GetUnresponsiveCount() const
 {
-	return m_sWindowName;
+	return m_nUnresponsiveCount;
 }
 
 
-void SRPWindow::DestroyBerkeliumWindow()
+const uint32 *SRPWindow::GetUnresponsiveHistogram() const
 {
-	if (m_pBerkeliumWindow)
-	{
-		// stop window navigation
-		m_pBerkeliumWindow->stop();
-		// unfocus window
-		m_pBerkeliumWindow->unfocus();
-		// destroy window
-		m_pBerkeliumWindow->destroy();
-		// set nullptr
-		m_pBerkeliumWindow = nullptr;
-	}
+	return m_nUnresponsiveHistogram;
 }
 
 
-void SRPWindow::SetWindowSettings()
+uint32 SRPWindow::GetTypedCallBackCount() const
 {
-	m_pBerkeliumWindow->resize(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
-	m_pBerkeliumWindow->setTransparent(m_psWindowsData->bTransparent);
-	m_pBerkeliumWindow->setDelegate(this);
-	m_pBerkeliumWindow->navigateTo(m_psWindowsData->sUrl.GetASCII(), m_psWindowsData->sUrl.GetLength());
+	return m_nTypedCallBackCount;
 }
 
 
-Vector2i SRPWindow::GetPosition() const
+uint64 SRPWindow::GetTypedCallBackTime() const
 {
-	if (m_psWindowsData->nXPos && m_psWindowsData->nYPos)
-	{
-		// return the position of the window
-		return Vector2i(m_psWindowsData->nXPos, m_psWindowsData->nYPos);
-	}
-	else
-	{
-		return Vector2i::NegativeOne;
-	}
+	return m_nTypedCallBackTime;
 }
 
 
-Vector2i SRPWindow::GetSize() const
+uint32 SRPWindow::GetStringCallBackCount() const
 {
-	if (m_psWindowsData->nFrameWidth && m_psWindowsData->nFrameHeight)
-	{
-		// return the size of the window
-		return Vector2i(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
-	}
-	else
+	return m_nStringCallBackCount;
+}
+
+
+uint64 SRPWindow::GetStringCallBackTime() const
+{
+	return m_nStringCallBackTime;
+}
+
+
+uint32 SRPWindow::GetNativePostBatchCount() const
+{
+	return m_nNativePostBatchCount;
+}
+
+
+uint32 SRPWindow::GetNativePostMessageCount() const
+{
+	return m_nNativePostMessageCount;
+}
+
+
+void SRPWindow::MarkInput(const uint64 &nInputTime)
+{
+	if (!m_nPendingInputTime && m_bBerkeliumWindowCreated)
 	{
-		return Vector2i::NegativeOne;
+		// later input is painted along with the earliest one
+		m_nPendingInputTime = nInputTime;
+		// the input has just been pushed, a paint can only show it once the berkelium thread has executed it
+		m_nPendingInputCommand = m_pBerkeliumThread ? m_pBerkeliumThread->GetNumOfPushedCommands() : 0;
 	}
 }
 
 
-Vector2i SRPWindow::GetRelativeMousePosition(const Vector2i &vMousePos) const
+const sLatencyHistogram *SRPWindow::GetInputLatencyHistogram(const uint32 &nLatency) const
 {
-	return Vector2i(vMousePos.x - m_psWindowsData->nXPos, vMousePos.y - m_psWindowsData->nYPos);
+	return (nLatency <= LatencyDraw) ? &m_sInputLatency[nLatency] : nullptr;
 }
 
 
-int SRPWindow::GetSceneRenderPassIndex()
+uint32 SRPWindow::GetInputLatency(const uint32 &nLatency, const uint32 &nPercentile) const
 {
-	if (m_pCurrentSceneRenderer)
+	const sLatencyHistogram *psHistogram = GetInputLatencyHistogram(nLatency);
+	if (!psHistogram || psHistogram->nCount == 0)
 	{
-		// return scene render pass index
-		return m_pCurrentSceneRenderer->GetIndex(*reinterpret_cast<SceneRendererPass*>(this));
+		return 0;
 	}
-	else
+
+	// the amount of latencies that have to be within the returned one, at least one
+	const uint32 nPercent = (nPercentile > 100) ? 100 : nPercentile;
+	uint64 nRank = (uint64(psHistogram->nCount) * nPercent + 99) / 100;
+	if (nRank == 0)
 	{
-		return -1;
+		nRank = 1;
+	}
+
+	uint64 nTotal = 0;
+	for (uint32 i = 0; i < LATENCYHISTOGRAMSIZE - 1; i++)
+	{
+		nTotal += psHistogram->nBuckets[i];
+		if (nTotal >= nRank)
+		{
+			// the upper bound of the bucket
+			return i + 1;
+		}
 	}
+
+	// the last bucket has no upper bound, so the longest latency is used
+	return uint32((psHistogram->nMaxTime + 999) / 1000);
 }
 
 
-void SRPWindow::onJavascriptCallback(Berkelium::Window *win, void *replyMsg, Berkelium::URLString origin, Berkelium::WideString funcName, Berkelium::Script::Variant *args, size_t numArgs)
+void SRPWindow::ResetInputLatency()
 {
-	//	Javascript has called a bound function on this Window.
-	//	Parameters:
-	//		win			Window instance that fired this event.
-	// 		pReplyMsg	If non-NULL, opaque reply identifier to be passed to synchronousScriptReturn.
-	// 		url			Origin of the sending script.
-	// 		funcName	name of function to call.
-	// 		args		list of variants passed into function.
-	// 		numArgs		number of arguments.
-
-	// create new callback
-	sCallBack *pCallBack = new sCallBack;
+	MemoryManager::Set(m_sInputLatency, 0, sizeof(m_sInputLatency));
+}
 
-	// set the callback attributes
-	pCallBack->pWindow = win;
-	pCallBack->sFunctionName = funcName.data();
-	pCallBack->nNumberOfParameters = numArgs;
-	pCallBack->OriginUrl = origin;
-	pCallBack->pReplyMsg = replyMsg;
-	pCallBack->pParameters = args;
 
-	String sParams = "";
+void SRPWindow::CallCallBackFunction(const sCallBackFunction *psCallBackFunction, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, String *psResult)
+{
+	DynFuncPtr pDynFuncPtr = psCallBackFunction->pDynFunc;
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
 
-	// loop trough the arguments
-	for (size_t i = 0; i < numArgs; i++)
+	// the result is only of interest when javascript is waiting for a response
+	bool bCalled = false;
+	if (psCallBackFunction->bTyped)
 	{
-		Berkelium::WideString jsonStr = toJSON(args[i]);
-
-		//todo: [10-07-2012 Icefire] add additional argument types and verify them working
-		if (args[i].type() == Berkelium::Script::Variant::JSSTRING)
-		{
-			// string
-			//question: [10-07-2012 Icefire] what if more than one parameter and one of them has a whitespace, needs testing
-			sParams = sParams + "Param" + String(i) + "=" + String(args[i].toString().data()) + " ";
-		}
-		else if (args[i].type() == Berkelium::Script::Variant::JSBOOLEAN)
+		// the arguments go straight into the parameters of the function
+		bCalled = ScriptParams::Call(*pDynFuncPtr, pArgs, nNumArgs, psResult);
+		if (bCalled)
 		{
-			// boolean
-			sParams = sParams + "Param" + String(i) + "=" + String(jsonStr.data()) + " ";
+			m_nTypedCallBackCount++;
+			m_nTypedCallBackTime += System::GetInstance()->GetMicroseconds() - nStartTime;
 		}
-		else if (args[i].type() == Berkelium::Script::Variant::JSDOUBLE)
+		else
 		{
-			// double
-			sParams = sParams + "Param" + String(i) + "=" + String(jsonStr.data()) + " ";
+			DebugToConsole("Typed call of '" + psCallBackFunction->sJSFunctionName + "' failed, the parameter string is used instead\n");
 		}
-		else
+	}
+	if (!bCalled)
+	{
+		const String sParams = ScriptParams::ToParameterString(pArgs, nNumArgs);
+		if (nNumArgs > 0)
 		{
-			// else or undefined
-			sParams = sParams + "Param" + String(i) + "=" + String(jsonStr.data()) + " ";
+			DebugToConsole("!Parameters from Javascript resulted in the following being send to the callback function!\n");
+			DebugToConsole("\t>> " + sParams + " <<\n\n");
 		}
 
-		Berkelium::Script::toJSON_free(jsonStr);
-	}
+		ScriptParams::CallWithParameterString(*pDynFuncPtr, sParams, psResult);
 
-	if (numArgs > 0)
-	{
-		DebugToConsole("!Parameters from Javascript resulted in the following being send to the callback function!\n");
-		DebugToConsole("\t>> " + sParams + " <<\n\n");
+		m_nStringCallBackCount++;
+		m_nStringCallBackTime += System::GetInstance()->GetMicroseconds() - nStartTime;
 	}
+}
 
-	// create dynamic function pointer
-	DynFuncPtr pDynFuncPtr = m_pmapCallBackFunctions->Get(pCallBack->sFunctionName);
-	if (pDynFuncPtr)
+
+void SRPWindow::DispatchNativePost(const Berkelium::Script::Variant *pArgs, size_t nNumArgs)
+{
+	m_nNativePostBatchCount++;
+
+	// every message is its name, the number of arguments and the arguments
+	size_t i = 0;
+	while (i + 1 < nNumArgs)
 	{
-		// check if there is a return type
-		if (pDynFuncPtr->GetReturnTypeID() == TypeNull || pDynFuncPtr->GetReturnTypeID() == TypeInvalid)
+		sCallBackFunction *psCallBackFunction = GetCallBackFunction(pArgs[i]);
+		const int nNumParameters = pArgs[i + 1].toInteger();
+		i += 2;
+		if (nNumParameters < 0 || i + size_t(nNumParameters) > nNumArgs)
 		{
-			// call the function without a return
-			pDynFuncPtr->Call(sParams);
+			// the batch was not created by native.post()
+			DebugToConsole("!Malformed native.post() batch!\n");
+			return;
 		}
-		else
-		{
-			// call the function with a return
-			String sResult = pDynFuncPtr->CallWithReturn(sParams);
 
-			// check if javascript is waiting for a response
-			if (replyMsg)
-			{
-				// send result back to javascript
-				win->synchronousScriptReturn(replyMsg, Berkelium::Script::Variant(sResult.GetUnicode()));
-			}
+		// call the callback function, batched messages do not have a return
+		if (psCallBackFunction)
+		{
+			PostCallBackFunction(psCallBackFunction, &pArgs[i], size_t(nNumParameters), nullptr);
 		}
+		m_nNativePostMessageCount++;
+		i += size_t(nNumParameters);
 	}
+}
+
 
-	// check if the callback is part of the default ones
-	if (pCallBack->sFunctionName == DRAGWINDOW ||
-		pCallBack->sFunctionName == HIDEWINDOW ||
-		pCallBack->sFunctionName == CLOSEWINDOW ||
-		pCallBack->sFunctionName == RESIZEWINDOW)
+void SRPWindow::DispatchNativeCall(const Berkelium::Script::Variant *pArgs, size_t nNumArgs)
+{
+	if (nNumArgs < 2)
 	{
-		// add the callback to the hashmap so that the Gui class can process it
-		m_pmapDefaultCallBacks->Add(pCallBack->sFunctionName, pCallBack);
+		// the call was not made by native.call()
+		DebugToConsole("!Malformed native.call()!\n");
+		return;
 	}
-	else
+
+	const uint32 nCallId = uint32(pArgs[0].toInteger());
+	const sCallBackFunction *psCallBackFunction = GetCallBackFunction(pArgs[1]);
+	if (!psCallBackFunction)
 	{
-		// we do not need the callback struct and its data anymore
+		SettleCallBack(nCallId, false, "Unknown function '" + ScriptParams::ToString(pArgs[1]) + "'");
+		return;
+	}
 
-		// i am not sure if you need to cleanup the children of a struct when you delete a struct
-		delete pCallBack->pParameters;
-		delete pCallBack->pReplyMsg;
-		delete pCallBack;
+	// the function may defer the promise while it is called
+	m_nCurrentCallId = nCallId;
+	m_bCurrentCallDeferred = false;
+	String sResult = "";
+	CallCallBackFunction(psCallBackFunction, &pArgs[2], nNumArgs - 2, &sResult);
+	if (!m_bCurrentCallDeferred)
+	{
+		SettleCallBack(nCallId, true, sResult);
 	}
+	m_nCurrentCallId = 0;
 }
 
 
-void SRPWindow::MoveWindow(const int &nX, const int &nY)
+uint32 SRPWindow::DeferCallBack()
 {
-	//question: [10-07-2012 Icefire] i am not sure yet if this method is right for this use case
+	if (m_nCurrentCallId)
+	{
+		m_bCurrentCallDeferred = true;
+	}
+	return m_nCurrentCallId;
+}
 
-	m_psWindowsData->nXPos = nX;
-	m_psWindowsData->nYPos = nY;
-	UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(nX), float(nY)), Vector2(float(m_psWindowsData->nFrameWidth), float(m_psWindowsData->nFrameHeight)));
+
+void SRPWindow::ResolveCallBack(const uint32 &nCallId, const String &sResult)
+{
+	SettleCallBack(nCallId, true, sResult);
 }
 
 
-void SRPWindow::onTooltipChanged(Berkelium::Window *win, Berkelium::WideString text)
+void SRPWindow::RejectCallBack(const uint32 &nCallId, const String &sError)
 {
-	//undone: [10-07-2012 Icefire] deprecate
+	SettleCallBack(nCallId, false, sError);
+}
 
-	if (m_bToolTipEnabled)
+
+void SRPWindow::SettleCallBack(const uint32 &nCallId, const bool &bResolved, const String &sValue)
+{
+	sSettledCallBack *psSettledCallBack = new sSettledCallBack;
+	psSettledCallBack->nCallId = nCallId;
+	psSettledCallBack->bResolved = bResolved;
+	psSettledCallBack->sValue = sValue;
+
+	// worker threads may settle their calls at any time
+	m_cSettledCallBacksMutex.Lock();
+	m_lstSettledCallBacks.Add(psSettledCallBack);
+	m_cSettledCallBacksMutex.Unlock();
+}
+
+
+void SRPWindow::ProcessSettledCallBacks()
+{
+	// take the settled calls and leave the lock to the worker threads as soon as possible
+	m_cSettledCallBacksMutex.Lock();
+	if (m_lstSettledCallBacks.IsEmpty())
 	{
-		if (!m_pToolTip)
-		{
-			// tool tip needs to be created
-			SetupToolTipWindow();
-		}
-		// set the tooltip
-		SetToolTip(String(text.data()));
+		m_cSettledCallBacksMutex.Unlock();
+		return;
+	}
+	List<sSettledCallBack*> lstSettledCallBacks = m_lstSettledCallBacks;
+	m_lstSettledCallBacks.Clear();
+	m_cSettledCallBacksMutex.Unlock();
+
+	// the promises are settled together with the other queued javascript
+	Iterator<sSettledCallBack*> cIterator = lstSettledCallBacks.GetIterator();
+	while (cIterator.HasNext())
+	{
+		sSettledCallBack *psSettledCallBack = cIterator.Next();
+		EnqueueJavascript("native._settle(" + String(psSettledCallBack->nCallId) + (psSettledCallBack->bResolved ? ", true, " : ", false, ") + ToJavascriptString(psSettledCallBack->sValue) + ");");
+		delete psSettledCallBack;
 	}
 }
 
 
-void SRPWindow::SetupToolTipWindow()
+void SRPWindow::SetStateString(const String &sPath, const String &sValue)
 {
-	//undone: [10-07-2012 Icefire] deprecate
+	SetStateLiteral(sPath, ToJavascriptString(sValue));
+}
 
-	// create tool tip window and set data
-	m_pToolTip = new SRPWindow("ToolTip");
-	m_pToolTip->GetData()->bIsVisable = false;
-	m_pToolTip->GetData()->sUrl = "file:///D:/plice/PLMain/Code/GameClient/bin/tooltip.html";
-	m_pToolTip->GetData()->nFrameWidth = 512;
-	m_pToolTip->GetData()->nFrameHeight = 64;
-	m_pToolTip->GetData()->nXPos = 0;
-	m_pToolTip->GetData()->nYPos = 0;
-	m_pToolTip->GetData()->bTransparent = true;
-	m_pToolTip->GetData()->bKeyboardEnabled = false;
-	m_pToolTip->GetData()->bMouseEnabled = false;
-	m_pToolTip->GetData()->bNeedsFullUpdate = true;
-	m_pToolTip->GetData()->bLoaded = false;
 
-	// initialize the tool tip
-	if (m_pToolTip->Initialize(m_pCurrentRenderer, Vector2::Zero, Vector2(float(512), float(64))))
+void SRPWindow::SetStateNumber(const String &sPath, const double &dValue)
+{
+	SetStateLiteral(sPath, ToJavascriptNumber(dValue));
+}
+
+
+void SRPWindow::SetStateBoolean(const String &sPath, const bool &bValue)
+{
+	SetStateLiteral(sPath, bValue ? "true" : "false");
+}
+
+
+void SRPWindow::RemoveState(const String &sPath)
+{
+	// null removes the value from the model, the entry is removed once that is send
+	if (m_pmapState->Get(sPath))
 	{
-		// add the scene render pass for the tool tip
-		m_pToolTip->AddSceneRenderPass(m_pCurrentSceneRenderer);
+		SetStateLiteral(sPath, "null");
 	}
-	else
+}
+
+
+void SRPWindow::BindStateObject(const String &sPath, Object *pObject)
+{
+	if (pObject && !m_pmapStateObjects->Get(sPath))
 	{
-		// destroy the left overs because the tooltip could not be initialized
-		DestroyToolTipWindow();
+		m_pmapStateObjects->Add(sPath, new sStateObject(*pObject));
 	}
 }
 
 
-void SRPWindow::DestroyToolTipWindow()
+void SRPWindow::UnbindStateObject(const String &sPath)
 {
-	//undone: [10-07-2012 Icefire] deprecate
-
-	if (m_pToolTip)
+	sStateObject *psStateObject = m_pmapStateObjects->Get(sPath);
+	if (psStateObject)
 	{
-		m_pToolTip->DestroyInstance();
-		m_pToolTip = nullptr;
+		m_pmapStateObjects->Remove(sPath);
+		delete psStateObject;
 	}
 }
 
 
-void SRPWindow::SetToolTip(const String &sText)
+void SRPWindow::SyncState()
 {
-	//undone: [10-07-2012 Icefire] deprecate
-
-	if (m_pToolTip)
+	// compare the attributes of the bound objects with what the page has
+	Array<String> lstDestroyedObjects;
+	Iterator<String> cObjectIterator = m_pmapStateObjects->GetKeyIterator();
+	while (cObjectIterator.HasNext())
 	{
-		if (sText == "")
+		const String sPath = cObjectIterator.Next();
+		Object *pObject = m_pmapStateObjects->Get(sPath)->pObject;
+		if (!pObject)
 		{
-			m_pToolTip->GetBerkeliumWindow()->executeJavascript(Berkelium::WideString::point_to(String("fadeEffect(1, 0, 5);").GetUnicode()));
-			m_pToolTip->GetData()->bIsVisable = false;
+			// the object has been destroyed, its values remain like those of an object that is unbound
+			lstDestroyedObjects.Add(sPath);
+			continue;
 		}
-		else
+		Iterator<DynVar*> cAttributeIterator = pObject->GetAttributes().GetIterator();
+		while (cAttributeIterator.HasNext())
 		{
-			Frontend &cFrontend = static_cast<FrontendApplication*>(CoreApplication::GetApplication())->GetFrontend();
-			m_pToolTip->MoveWindow(cFrontend.GetMousePositionX() + 10, cFrontend.GetMousePositionY() + 6);
-			m_pToolTip->GetBerkeliumWindow()->executeJavascript(Berkelium::WideString::point_to(String("SetToolTip('" + sText + "')").GetUnicode()));
-			m_pToolTip->MoveToFront();
-			m_pToolTip->GetData()->bIsVisable = true;
-			m_pToolTip->GetBerkeliumWindow()->executeJavascript(Berkelium::WideString::point_to(String("fadeEffect(0, 1, 15);").GetUnicode()));
+			const DynVar *pDynVar = cAttributeIterator.Next();
+			SetStateLiteral(sPath + "." + pDynVar->GetDesc()->GetName(), ToJavascriptLiteral(*pDynVar));
 		}
 	}
-}
-
-
-void SRPWindow::SetToolTipEnabled(const bool &bEnabled)
-{
-	//undone: [10-07-2012 Icefire] deprecate
+	for (uint32 i = 0; i < lstDestroyedObjects.GetNumOfElements(); i++)
+	{
+		UnbindStateObject(lstDestroyedObjects[i]);
+	}
 
-	m_bToolTipEnabled = bEnabled;
+	if (m_lstDirtyState.IsEmpty() || !m_bBerkeliumWindowCreated)
+	{
+		// nothing changed or nothing to send it to
+		return;
+	}
 
-	if (!bEnabled)
+	// one patch with all changed values
+	String sPatch = "native._patch({";
+	for (uint32 i = 0; i < m_lstDirtyState.GetNumOfElements(); i++)
 	{
-		// clear tool tip because we disabled it
-		SetToolTip("");
+		const String &sPath = m_lstDirtyState[i];
+		sStateValue *psStateValue = m_pmapState->Get(sPath);
+		sPatch = sPatch + (i ? "," : "") + ToJavascriptString(sPath) + ":" + psStateValue->sLiteral;
+		psStateValue->bDirty = false;
+		if (psStateValue->sLiteral == "null")
+		{
+			// the page has removed the value, so do we
+			m_pmapState->Remove(sPath);
+			delete psStateValue;
+		}
 	}
+	sPatch = sPatch + "});";
+	m_nStateValueCount += m_lstDirtyState.GetNumOfElements();
+	m_lstDirtyState.Clear();
+
+	EnqueueJavascript(sPatch);
 }
 
 
-void SRPWindow::RemoveCallBacks() const
+uint32 SRPWindow::GetStateValueCount() const
 {
-	// get the iterator for all the callbacks created
-	Iterator<sCallBack*> cIterator = m_pmapDefaultCallBacks->GetIterator();
-	// loop trough the callbacks
-	while (cIterator.HasNext())
-	{
-		sCallBack *psCallBack = cIterator.Next();
-		// cleanup
-		// i am not sure if you need to cleanup the children of a struct and the struct itself when you remove the struct from a hashmap
-		// delete psCallBack->pParameters; // [12-07-2012 Icefire] this generated an error!
-		delete psCallBack->pReplyMsg;
-		delete psCallBack;
-	}
-	m_pmapDefaultCallBacks->Clear();
+	return m_nStateValueCount;
 }
 
 
-uint32 SRPWindow::GetNumberOfCallBacks() const
+void SRPWindow::SendBinary(const String &sName, const uint8 *pData, const uint32 &nSize)
 {
-	return m_pmapDefaultCallBacks->GetNumOfElements();
+	const uint64 nStartTime = System::GetInstance()->GetMicroseconds();
+	const String sJavascript = GetBinaryJavascript(sName, pData, nSize);
+	m_nBinaryEncodeTime += System::GetInstance()->GetMicroseconds() - nStartTime;
+	m_nBinaryByteCount += nSize;
+
+	// only the newest blob of a name is of interest
+	EnqueueJavascript(sJavascript, "native._binary:" + sName);
 }
 
 
-sCallBack *SRPWindow::GetCallBack(const String &sKey) const
+uint64 SRPWindow::GetBinaryByteCount() const
 {
-	return m_pmapDefaultCallBacks->Get(sKey);
+	return m_nBinaryByteCount;
 }
 
 
-void SRPWindow::ResizeWindow(const int &nWidth, const int &nHeight)
+uint64 SRPWindow::GetBinaryEncodeTime() const
 {
-	//fix: [10-07-2012 Icefire] let (re)sizing be handled by the program uniform, see http://dev.pixellight.org/forum/viewtopic.php?f=6&t=503
-	// buffer overflows on resize happen to often to accept the current method as is
+	return m_nBinaryEncodeTime;
+}
 
-	m_bIgnoreBufferUpdate = true;
 
-	m_psWindowsData->bNeedsFullUpdate = true;
+String SRPWindow::GetBinaryJavascript(const String &sName, const uint8 *pData, const uint32 &nSize)
+{
+	return "native._binary(" + ToJavascriptString(sName) + ",\"" + ToBase64(pData, nSize) + "\");";
+}
 
-	m_bReadyToDraw = false;
 
-	m_psWindowsData->nFrameWidth = nWidth;
-	m_psWindowsData->nFrameHeight = nHeight;
+String SRPWindow::ToBase64(const uint8 *pData, const uint32 &nSize)
+{
+	static const char szAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-	m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight, 1));
-	if (nullptr != m_pTextureBufferNew)
+	// every three bytes become four characters, the last group is padded
+	const uint32 nLength = ((nSize + 2) / 3) * 4;
+	char *pszBase64 = new char[nLength + 1];
+	char *pszOut = pszBase64;
+	uint32 i = 0;
+	for (; i + 2 < nSize; i += 3)
 	{
-		delete m_pTextureBufferNew;
+		const uint32 nGroup = (uint32(pData[i]) << 16) | (uint32(pData[i + 1]) << 8) | pData[i + 2];
+		*pszOut++ = szAlphabet[(nGroup >> 18) & 0x3F];
+		*pszOut++ = szAlphabet[(nGroup >> 12) & 0x3F];
+		*pszOut++ = szAlphabet[(nGroup >> 6) & 0x3F];
+		*pszOut++ = szAlphabet[nGroup & 0x3F];
 	}
-	m_pTextureBufferNew = reinterpret_cast<TextureBuffer*>(m_pCurrentRenderer->CreateTextureBuffer2D(m_cImage, TextureBuffer::Unknown, 0));
+	if (i < nSize)
+	{
+		const uint32 nGroup = (uint32(pData[i]) << 16) | ((i + 1 < nSize) ? (uint32(pData[i + 1]) << 8) : 0);
+		*pszOut++ = szAlphabet[(nGroup >> 18) & 0x3F];
+		*pszOut++ = szAlphabet[(nGroup >> 12) & 0x3F];
+		*pszOut++ = (i + 1 < nSize) ? szAlphabet[(nGroup >> 6) & 0x3F] : '=';
+		*pszOut++ = '=';
+	}
+	*pszOut = '\0';
 
-	UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(m_psWindowsData->nFrameWidth), float(m_psWindowsData->nFrameHeight)));
+	const String sBase64(pszBase64, true, int(nLength));
+	delete [] pszBase64;
+	return sBase64;
+}
 
-	GetBerkeliumWindow()->resize(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
 
-	m_bReadyToDraw = true;
+void SRPWindow::SetStateLiteral(const String &sPath, const String &sLiteral)
+{
+	sStateValue *psStateValue = m_pmapState->Get(sPath);
+	if (!psStateValue)
+	{
+		psStateValue = new sStateValue;
+		psStateValue->bDirty = false;
+		m_pmapState->Add(sPath, psStateValue);
+	}
+	else if (psStateValue->sLiteral == sLiteral)
+	{
+		// the page already has this value
+		return;
+	}
 
-	m_bIgnoreBufferUpdate = false;
+	psStateValue->sLiteral = sLiteral;
+	if (!psStateValue->bDirty)
+	{
+		psStateValue->bDirty = true;
+		m_lstDirtyState.Add(sPath);
+	}
 }
 
 
-bool SRPWindow::AddCallBackFunction(const DynFuncPtr pDynFunc, String sJSFunctionName, bool bHasReturn)
+void SRPWindow::MarkStateDirty()
 {
-	if (pDynFunc)
+	Iterator<String> cIterator = m_pmapState->GetKeyIterator();
+	while (cIterator.HasNext())
 	{
-		// create function descriptor
-		const FuncDesc *pFuncDesc = pDynFunc->GetDesc();
-		if (pFuncDesc)
+		const String sPath = cIterator.Next();
+		sStateValue *psStateValue = m_pmapState->Get(sPath);
+		if (!psStateValue->bDirty)
 		{
-			if (m_pmapCallBackFunctions->Get(pFuncDesc->GetName()) == NULL)
-			{
-				if (sJSFunctionName == "")
-				{
-					// the function name is not defined so we use the method name
-					sJSFunctionName = pFuncDesc->GetName();
-				}
-				// we bind the javascript function
-				GetBerkeliumWindow()->addBindOnStartLoading(Berkelium::WideString::point_to(sJSFunctionName.GetUnicode()), Berkelium::Script::Variant::bindFunction(Berkelium::WideString::point_to(pFuncDesc->GetName().GetUnicode()), bHasReturn));
-
-				// we add the function pointer to the hashmap
-				m_pmapCallBackFunctions->Add(pFuncDesc->GetName(), pDynFunc);
-				return true;
-			}
+			psStateValue->bDirty = true;
+			m_lstDirtyState.Add(sPath);
 		}
 	}
-	return false;
 }
 
 
-void SRPWindow::onRunFileChooser(Berkelium::Window *win, int mode, Berkelium::WideString title, Berkelium::FileString defaultFile)
+String SRPWindow::ToJavascriptString(const String &sString)
 {
-	//undone: [10-07-2012 Icefire] not used or implemented
-
-	DebugToConsole("onRunFileChooser()\n");
-	
-	//undone: [10-07-2012 Icefire] is this implemented at all? https://groups.google.com/d/topic/berkelium/vKGuEpt9CbI/discussion
-	// awaiting new build for berkelium
+	String sLiteral = sString;
+	sLiteral.Replace("\\", "\\\\");
+	sLiteral.Replace("\"", "\\\"");
+	sLiteral.Replace("\n", "\\n");
+	sLiteral.Replace("\r", "\\r");
+	return "\"" + sLiteral + "\"";
 }
 
 
-bool SRPWindow::RemoveCallBack(const String &sKey) const
+String SRPWindow::ToJavascriptNumber(const double &dValue) const
 {
-	if (m_pmapDefaultCallBacks->Get(sKey) == NULL)
-	{
-		return false;
-	}
-	else
-	{
-		// i am not sure if you need to cleanup the children of a struct and the struct itself when you remove the struct from a hashmap
-		delete m_pmapDefaultCallBacks->Get(sKey)->pParameters;
-		delete m_pmapDefaultCallBacks->Get(sKey)->pReplyMsg;
-		delete m_pmapDefaultCallBacks->Get(sKey);
-		// we remove the callback
-		return m_pmapDefaultCallBacks->Remove(sKey);
-	}
+	// String() would give something javascript can not parse, null would remove the value
+	if (Math::IsNotANumber(dValue))
+		return "NaN";
+	else if (!Math::IsFinite(dValue))
+		return (dValue > 0.0) ? "Infinity" : "-Infinity";
+	return String(dValue);
 }
 
 
-void SRPWindow::SetDefaultCallBackFunctions()
+String SRPWindow::ToJavascriptLiteral(const DynVar &cDynVar) const
 {
-	// bind the default javascript functions for use
-	// this allows for users to set default javascript functions within their web page to be able to drag, hide, close and resize a window
-
-	GetBerkeliumWindow()->addBindOnStartLoading(Berkelium::WideString::point_to(String(DRAGWINDOW).GetUnicode()), Berkelium::Script::Variant::bindFunction(Berkelium::WideString::point_to(String(DRAGWINDOW).GetUnicode()), false));
-	GetBerkeliumWindow()->addBindOnStartLoading(Berkelium::WideString::point_to(String(HIDEWINDOW).GetUnicode()), Berkelium::Script::Variant::bindFunction(Berkelium::WideString::point_to(String(HIDEWINDOW).GetUnicode()), false));
-	GetBerkeliumWindow()->addBindOnStartLoading(Berkelium::WideString::point_to(String(CLOSEWINDOW).GetUnicode()), Berkelium::Script::Variant::bindFunction(Berkelium::WideString::point_to(String(CLOSEWINDOW).GetUnicode()), false));
-	GetBerkeliumWindow()->addBindOnStartLoading(Berkelium::WideString::point_to(String(RESIZEWINDOW).GetUnicode()), Berkelium::Script::Variant::bindFunction(Berkelium::WideString::point_to(String(RESIZEWINDOW).GetUnicode()), false));
+	switch (cDynVar.GetTypeID())
+	{
+		case Type<bool>::TypeID:
+			return cDynVar.GetBool() ? "true" : "false";
+
+		case Type<int8>::TypeID:
+		case Type<int16>::TypeID:
+		case Type<int32>::TypeID:
+		case Type<int64>::TypeID:
+		case Type<uint8>::TypeID:
+		case Type<uint16>::TypeID:
+		case Type<uint32>::TypeID:
+		case Type<uint64>::TypeID:
+		case Type<float>::TypeID:
+		case Type<double>::TypeID:
+			return ToJavascriptNumber(cDynVar.GetDouble());
+
+		default:
+			return ToJavascriptString(cDynVar.GetString());
+	}
 }
 
 
-void SRPWindow::onWidgetCreated(Berkelium::Window *win, Berkelium::Widget *newWidget, int zIndex)
+void SRPWindow::PostCallBackFunction(sCallBackFunction *psCallBackFunction, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, void *pReplyMsg)
 {
-	// we create the widget
-	sWidget *psWidget = new sWidget;
+	if (pReplyMsg || psCallBackFunction->nCoalescePolicy == CoalesceNone)
+	{
+		// calls that go out right away must not overtake calls that javascript made before them
+		DispatchCoalescedCallBacks();
+	}
 
-	// we set the data
-	psWidget->bNeedsFullUpdate = true;
-	psWidget->nXPos = m_psWindowsData->nXPos;
-	psWidget->nYPos = m_psWindowsData->nYPos;
-	psWidget->pProgramWrapper = CreateProgramWrapper();
-	psWidget->pVertexBuffer = CreateVertexBuffer(Vector2::Zero, Vector2::Zero);
+	if (pReplyMsg)
+	{
+		// javascript is waiting, send the result back
+		String sResult = "";
+		CallCallBackFunction(psCallBackFunction, pArgs, nNumArgs, &sResult);
+		SendScriptReturn(pReplyMsg, sResult);
+		return;
+	}
+	if (psCallBackFunction->nCoalescePolicy == CoalesceNone)
+	{
+		// every call matters
+		CallCallBackFunction(psCallBackFunction, pArgs, nNumArgs, nullptr);
+		return;
+	}
+
+	// the last value of a function has a slot of its own, only a key that includes the first argument needs to be looked up
+	String sKey = "";
+	sCoalescedCallBack *psCoalescedCallBack = psCallBackFunction->psCoalescedCallBack;
+	if (psCallBackFunction->nCoalescePolicy == CoalesceFirstArgument)
+	{
+		sKey = String(psCallBackFunction->nId) + "\n" + (nNumArgs > 0 ? ScriptParams::ToString(pArgs[0]) : "");
+		psCoalescedCallBack = m_pmapCoalescedCallBacks->Get(sKey);
+	}
+
+	if (psCoalescedCallBack)
+	{
+		// the earlier call is dropped, the call keeps its place in the order
+		delete [] psCoalescedCallBack->pArgs;
+		psCoalescedCallBack->pArgs = nullptr;
+		m_nCoalescedDroppedCount++;
+	}
+	else
+	{
+		psCoalescedCallBack = new sCoalescedCallBack;
+		psCoalescedCallBack->psCallBackFunction = psCallBackFunction;
+		psCoalescedCallBack->sKey = sKey;
+		psCoalescedCallBack->pArgs = nullptr;
+		m_plstCoalescedCallBacks->Add(psCoalescedCallBack);
+		if (psCallBackFunction->nCoalescePolicy == CoalesceFirstArgument)
+			m_pmapCoalescedCallBacks->Add(sKey, psCoalescedCallBack);
+		else
+			psCallBackFunction->psCoalescedCallBack = psCoalescedCallBack;
+	}
+
+	// the arguments are only valid during this call, so we copy them
+	psCoalescedCallBack->nNumArgs = nNumArgs;
+	if (nNumArgs > 0)
+	{
+		psCoalescedCallBack->pArgs = new Berkelium::Script::Variant[nNumArgs];
+		for (size_t i = 0; i < nNumArgs; i++)
+		{
+			psCoalescedCallBack->pArgs[i] = pArgs[i];
+		}
+	}
+}
+
+
+void SRPWindow::DispatchCoalescedCallBacks()
+{
+	if (m_plstCoalescedCallBacks->IsEmpty())
+	{
+		// nothing to dispatch
+		return;
+	}
+
+	// the callback functions may cause new calls, those are dispatched on the next update
+	List<sCoalescedCallBack*> lstCoalescedCallBacks = *m_plstCoalescedCallBacks;
+	m_plstCoalescedCallBacks->Clear();
+	m_pmapCoalescedCallBacks->Clear();
+	Iterator<sCoalescedCallBack*> cIterator = lstCoalescedCallBacks.GetIterator();
+	while (cIterator.HasNext())
+	{
+		cIterator.Next()->psCallBackFunction->psCoalescedCallBack = nullptr;
+	}
+
+	cIterator = lstCoalescedCallBacks.GetIterator();
+	while (cIterator.HasNext())
+	{
+		sCoalescedCallBack *psCoalescedCallBack = cIterator.Next();
+		CallCallBackFunction(psCoalescedCallBack->psCallBackFunction, psCoalescedCallBack->pArgs, psCoalescedCallBack->nNumArgs, nullptr);
+		m_nCoalescedDispatchedCount++;
+		delete [] psCoalescedCallBack->pArgs;
+		delete psCoalescedCallBack;
+	}
+}
+
+
+uint32 SRPWindow::GetCoalescedDroppedCount() const
+{
+	return m_nCoalescedDroppedCount;
+}
+
+
+uint32 SRPWindow::GetCoalescedDispatchedCount() const
+{
+	return m_nCoalescedDispatchedCount;
+}
+
+
+void SRPWindow::ClearCoalescedCallBacks()
+{
+	Iterator<sCoalescedCallBack*> cIterator = m_plstCoalescedCallBacks->GetIterator();
+	while (cIterator.HasNext())
+	{
+		sCoalescedCallBack *psCoalescedCallBack = cIterator.Next();
+		psCoalescedCallBack->psCallBackFunction->psCoalescedCallBack = nullptr;
+		delete [] psCoalescedCallBack->pArgs;
+		delete psCoalescedCallBack;
+	}
+	m_plstCoalescedCallBacks->Clear();
+	m_pmapCoalescedCallBacks->Clear();
+}
+
+
+sCallBackFunction *SRPWindow::GetCallBackFunction(const Berkelium::Script::Variant &cFunction) const
+{
+	if (cFunction.type() == Berkelium::Script::Variant::JSDOUBLE)
+	{
+		// interned id, straight into the dispatch table
+		const uint32 nIndex = uint32(cFunction.toInteger() - CallBackFunctions);
+		return (nIndex < m_lstCallBackFunctionTable.GetNumOfElements()) ? m_lstCallBackFunctionTable[nIndex] : nullptr;
+	}
+
+	// name of a function the page did not know the id of
+	return m_pmapCallBackFunctions->Get(ScriptParams::ToString(cFunction));
+}
+
+
+uint32 SRPWindow::GetCallBackId(const Berkelium::WideString &sFunctionName) const
+{
+	if (!sFunctionName.length())
+	{
+		return 0xFFFFFFFF;
+	}
+
+	// the functions are bound by their id, so this is a short decimal number
+	uint32 nId = 0;
+	for (size_t i = 0; i < sFunctionName.length(); i++)
+	{
+		const wchar_t nCharacter = sFunctionName.data()[i];
+		if (nCharacter < L'0' || nCharacter > L'9')
+		{
+			return 0xFFFFFFFF;
+		}
+		nId = nId * 10 + uint32(nCharacter - L'0');
+	}
+	return nId;
+}
+
+
+uint32 SRPWindow::GetDefaultCallBackId(const String &sKey) const
+{
+	if (sKey == DRAGWINDOW)
+		return CallBackDragWindow;
+	else if (sKey == HIDEWINDOW)
+		return CallBackHideWindow;
+	else if (sKey == CLOSEWINDOW)
+		return CallBackCloseWindow;
+	else if (sKey == RESIZEWINDOW)
+		return CallBackResizeWindow;
+	return NUMOFDEFAULTCALLBACKS;
+}
+
+
+void SRPWindow::UpdateWatchdog()
+{
+	if (!m_bUnresponsive || !(m_nUnresponsivePolicy & (UnresponsiveReload | UnresponsiveRecreate)))
+	{
+		// nothing to remedy
+		return;
+	}
+
+	const uint64 nUnresponsiveTime = GetUnresponsiveTime();
+	if ((m_nUnresponsivePolicy & UnresponsiveReload) && !m_bUnresponsiveReloaded)
+	{
+		if (nUnresponsiveTime > m_nUnresponsiveTimeout)
+		{
+			// reload once, the page might just have ended up in an endless loop
+			m_bUnresponsiveReloaded = true;
+			SendReload();
+		}
+	}
+	else if (m_nUnresponsivePolicy & UnresponsiveRecreate)
+	{
+		if (nUnresponsiveTime > (m_bUnresponsiveReloaded ? m_nUnresponsiveTimeout * 2 : m_nUnresponsiveTimeout))
+		{
+			// the old renderer process is not going to tell us it is responsive again
+			EndUnresponsive();
+			// the last frame is drawn until the recreated window has painted in full
+			m_psWindowsData->bNeedsFullUpdate = true;
+			RecreateWindow();
+		}
+	}
+}
+
+
+void SRPWindow::EndUnresponsive()
+{
+	if (m_bUnresponsive)
+	{
+		const uint64 nUnresponsiveTime = GetUnresponsiveTime();
+		m_bUnresponsive = false;
+
+		// add the period to the histogram
+		uint32 nBucket = 0;
+		if (nUnresponsiveTime >= 10000)
+			nBucket = 5;
+		else if (nUnresponsiveTime >= 5000)
+			nBucket = 4;
+		else if (nUnresponsiveTime >= 2000)
+			nBucket = 3;
+		else if (nUnresponsiveTime >= 1000)
+			nBucket = 2;
+		else if (nUnresponsiveTime >= 500)
+			nBucket = 1;
+		m_nUnresponsiveHistogram[nBucket]++;
+
+		if (nUnresponsiveTime > m_nMaxUnresponsiveTime)
+		{
+			m_nMaxUnresponsiveTime = nUnresponsiveTime;
+		}
+	}
+}
+
+
+void SRPWindow::AddInputLatency(const uint32 &nLatency, const uint64 &nTime)
+{
+	sLatencyHistogram &sHistogram = m_sInputLatency[nLatency];
+	const uint64 nBucket = nTime / 1000;
+	sHistogram.nBuckets[(nBucket < LATENCYHISTOGRAMSIZE) ? nBucket : (LATENCYHISTOGRAMSIZE - 1)]++;
+	sHistogram.nCount++;
+	if (nTime > sHistogram.nMaxTime)
+	{
+		sHistogram.nMaxTime = nTime;
+	}
+}
+
+
+void SRPWindow::MarkPaint(const uint64 &nPaintTime, const uint32 &nExecutedCommands)
+{
+	// paints that berkelium has fired before the input or before the berkelium thread has executed it can not show it
+	if (m_nPendingInputTime && nPaintTime >= m_nPendingInputTime && int(nExecutedCommands - m_nPendingInputCommand) >= 0)
+	{
+		AddInputLatency(LatencyPaint, nPaintTime - m_nPendingInputTime);
+		// the next draw shows the painted input
+		m_nPaintedInputTime = m_nPendingInputTime;
+		m_nPendingInputTime = 0;
+	}
+}
+
+
+void SRPWindow::onAddressBarChanged(Berkelium::Window *win, Berkelium::URLString newURL)
+{
+	if (IsOnBerkeliumThread())
+	{
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventAddressBarChanged, win);
+		psEvent->sUrl = String(newURL.data(), true, int(newURL.length()));
+		m_pEventQueue->Push(psEvent);
+		return;
+	}
+
+	m_sLastKnownUrl = newURL.data();
+}
+
+
+void SRPWindow::RecreateWindow()
+{
+	// a crashed or recreated renderer is not unresponsive anymore
+	EndUnresponsive();
+
+	// destroy the berkelium window
+	DestroyBerkeliumWindow();
+	// destroy the context
+	DestroyContext();
+	// create a new context and berkelium window, this also sets the window settings and callbacks
+	CreateBerkeliumWindow();
+}
+
+
+void SRPWindow::CreateBerkeliumContext()
+{
+	//todo: [10-07-2012 Icefire] should move back to gui
+	m_pBerkeliumContext = Berkelium::Context::create();
+}
+
+
+void SRPWindow::DestroyContext()
+{
+	//todo: [10-07-2012 Icefire] should move back to gui
+	if (QueueCommand(sBrowserCommand::CommandDestroyContext))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumContext)
+	{
+		m_pBerkeliumContext->destroy();
+		m_pBerkeliumContext = nullptr;
+	}
+}
+
+
+Berkelium::Window *SRPWindow::GetBerkeliumWindow()
+{
+	if (!m_bBerkeliumWindowCreated)
+	{
+		// the caller needs the berkelium window now, not when the window is shown
+		CreateBerkeliumWindow();
+	}
+	// the berkelium thread writes its pointer whenever it likes, we only read what it has published
+	return m_pBerkeliumThread ? m_pPublishedBerkeliumWindow : m_pBerkeliumWindow;
+}
+
+
+bool SRPWindow::IsBerkeliumWindowCreated() const
+{
+	return m_bBerkeliumWindowCreated;
+}
+
+
+void SRPWindow::SetBerkeliumThread(BerkeliumThread *pBerkeliumThread)
+{
+	m_pBerkeliumThread = pBerkeliumThread;
+}
+
+
+void SRPWindow::SetTexturePool(TexturePool *pTexturePool)
+{
+	m_pTexturePool = pTexturePool;
+}
+
+
+void SRPWindow::SetTextureAtlas(TextureAtlas *pTextureAtlas)
+{
+	m_pTextureAtlas = pTextureAtlas;
+}
+
+
+bool SRPWindow::IsInTextureAtlas() const
+{
+	return m_psAtlasRect != nullptr;
+}
+
+
+void SRPWindow::UpdateAtlasQuad()
+{
+	if (m_psAtlasRect)
+	{
+		// a window that still draws its own texture or is grayed out by the unresponsive overlay is drawn on its own
+		const bool bBatched = m_bInitialized && m_bReadyToDraw && m_psWindowsData->bIsVisable && !m_pTextureBuffer &&
+							  !(m_bUnresponsive && (m_nUnresponsivePolicy & UnresponsiveOverlay));
+		m_pTextureAtlas->SetQuad(*m_psAtlasRect, Vector2i(m_psWindowsData->nXPos, m_psWindowsData->nYPos), GetPreviewSize(),
+								 Vector2i(m_nTexturePaintedWidth, m_nTexturePaintedHeight), bBatched);
+	}
+}
+
+
+void SRPWindow::SetDefaultCallBackQueue(List<sDefaultCallBackEvent*> *plstDefaultCallBackEvents)
+{
+	m_plstDefaultCallBackEvents = plstDefaultCallBackEvents;
+}
+
+
+void SRPWindow::SetResizePreviewQueue(List<SRPWindow*> *plstResizePreviewWindows)
+{
+	m_plstResizePreviewWindows = plstResizePreviewWindows;
+}
+
+
+void SRPWindow::SetBootstrapScript(const sBootstrapScript *psBootstrapScript)
+{
+	m_psBootstrapScript = psBootstrapScript;
+}
+
+
+uint32 SRPWindow::GetNumOfStartLoadingScripts() const
+{
+	return m_nNumOfStartLoadingScripts;
+}
+
+
+void SRPWindow::ApplyBootstrapLibrary(const String &sJavascript)
+{
+	if (!m_bBerkeliumWindowCreated)
+	{
+		// the library comes with the bootstrap script
+		return;
+	}
+
+	// later pages get it when they start loading, the open page right away
+	AddStartLoadingScript(sJavascript);
+	ExecuteJavascript(sJavascript);
+}
+
+
+uint64 SRPWindow::GetCreateTime() const
+{
+	return m_nCreateTime;
+}
+
+
+uint64 SRPWindow::GetFirstPaintLatency() const
+{
+	return m_nFirstPaintLatency;
+}
+
+
+uint64 SRPWindow::GetFirstCallBackLatency() const
+{
+	return m_nFirstCallBackLatency;
+}
+
+
+sWindowsData *SRPWindow::GetData() const
+{
+	return m_psWindowsData;
+}
+
+
+String SRPWindow::GetName() const
+{
+	return m_sWindowName;
+}
+
+
+void SRPWindow::DestroyBerkeliumWindow()
+{
+	if (!IsOnBerkeliumThread())
+	{
+		m_bBerkeliumWindowCreated = false;
+		if (m_pBerkeliumThread)
+		{
+			// a window the berkelium thread publishes from now on is already destroyed
+			m_pPublishedBerkeliumWindow = nullptr;
+			m_nCreateCommandMark = m_pBerkeliumThread->GetNumOfPushedCommands() + 1;
+		}
+	}
+	if (QueueCommand(sBrowserCommand::CommandDestroy))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		// stop window navigation
+		m_pBerkeliumWindow->stop();
+		// unfocus window
+		m_pBerkeliumWindow->unfocus();
+		// destroy window
+		m_pBerkeliumWindow->destroy();
+		// set nullptr
+		m_pBerkeliumWindow = nullptr;
+	}
+}
+
+
+void SRPWindow::SetWindowSettings(const int &nWidth, const int &nHeight, const bool &bTransparent, const String &sUrl)
+{
+	// the settings are passed along because the berkelium thread should not read the window data
+	if (QueueCommand(sBrowserCommand::CommandSettings, nWidth, nHeight, bTransparent, 0, sUrl))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->resize(nWidth, nHeight);
+		m_pBerkeliumWindow->setTransparent(bTransparent);
+		m_pBerkeliumWindow->setDelegate(this);
+		m_pBerkeliumWindow->navigateTo(sUrl.GetASCII(), sUrl.GetLength());
+	}
+}
+
+
+Vector2i SRPWindow::GetPosition() const
+{
+	if (m_psWindowsData->nXPos && m_psWindowsData->nYPos)
+	{
+		// return the position of the window
+		return Vector2i(m_psWindowsData->nXPos, m_psWindowsData->nYPos);
+	}
+	else
+	{
+		return Vector2i::NegativeOne;
+	}
+}
+
+
+Vector2i SRPWindow::GetSize() const
+{
+	if (m_psWindowsData->nFrameWidth && m_psWindowsData->nFrameHeight)
+	{
+		// return the size of the window
+		return Vector2i(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
+	}
+	else
+	{
+		return Vector2i::NegativeOne;
+	}
+}
+
+
+Vector2i SRPWindow::GetRelativeMousePosition(const Vector2i &vMousePos) const
+{
+	return Vector2i(vMousePos.x - m_psWindowsData->nXPos, vMousePos.y - m_psWindowsData->nYPos);
+}
+
+
+void SRPWindow::SetAlphaHitTest(const bool &bEnabled, const uint8 &nThreshold)
+{
+	m_bAlphaHitTest = bEnabled;
+	m_nAlphaHitTestThreshold = nThreshold;
+
+	if (bEnabled)
+	{
+		// build the mask from what has been painted so far
+		UpdateCoverageMask(0, 0, m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
+	}
+	else
+	{
+		// we do not need the mask any more
+		delete [] m_pCoverageMask;
+		m_pCoverageMask = nullptr;
+		m_nCoverageMaskWidth = 0;
+		m_nCoverageMaskHeight = 0;
+	}
+}
+
+
+bool SRPWindow::IsAlphaHitTestEnabled() const
+{
+	return m_bAlphaHitTest;
+}
+
+
+bool SRPWindow::IsHitAt(const Vector2i &vRelativePos) const
+{
+	if (!m_bAlphaHitTest || !m_psWindowsData->bTransparent || !m_pCoverageMask)
+	{
+		// the whole rectangle takes clicks
+		return true;
+	}
+
+	const int nCellX = vRelativePos.x / COVERAGECELLSIZE;
+	const int nCellY = vRelativePos.y / COVERAGECELLSIZE;
+	if (nCellX < 0 || nCellY < 0 || nCellX >= m_nCoverageMaskWidth || nCellY >= m_nCoverageMaskHeight)
+	{
+		// not within the mask
+		return true;
+	}
+	return (m_pCoverageMask[nCellY * ((m_nCoverageMaskWidth + 7) / 8) + nCellX / 8] & (1 << (nCellX % 8))) != 0;
+}
+
+
+void SRPWindow::UpdateCoverageMask(int nLeft, int nTop, int nWidth, int nHeight)
+{
+	if (!m_bAlphaHitTest)
+	{
+		// nothing to keep up to date
+		return;
+	}
+
+	const int nFrameWidth = m_psWindowsData->nFrameWidth;
+	const int nFrameHeight = m_psWindowsData->nFrameHeight;
+	const int nMaskWidth = (nFrameWidth + COVERAGECELLSIZE - 1) / COVERAGECELLSIZE;
+	const int nMaskHeight = (nFrameHeight + COVERAGECELLSIZE - 1) / COVERAGECELLSIZE;
+	const int nMaskRowSize = (nMaskWidth + 7) / 8;
+	if (!m_pCoverageMask || nMaskWidth != m_nCoverageMaskWidth || nMaskHeight != m_nCoverageMaskHeight)
+	{
+		// the frame size has changed, the window takes clicks everywhere until it has been painted
+		delete [] m_pCoverageMask;
+		m_pCoverageMask = nullptr;
+		m_nCoverageMaskWidth = nMaskWidth;
+		m_nCoverageMaskHeight = nMaskHeight;
+		if (nMaskWidth > 0 && nMaskHeight > 0)
+		{
+			m_pCoverageMask = new uint8[nMaskRowSize * nMaskHeight];
+			MemoryManager::Set(m_pCoverageMask, 0xFF, nMaskRowSize * nMaskHeight);
+		}
+		nLeft = 0;
+		nTop = 0;
+		nWidth = nFrameWidth;
+		nHeight = nFrameHeight;
+	}
+
+	if (!m_pCoverageMask || !m_cImage.GetBuffer() || !m_cImage.GetBuffer()->GetData() ||
+		m_cImage.GetBuffer()->GetSize().x != m_nImageWidth || m_cImage.GetBuffer()->GetSize().y != m_nImageHeight)
+	{
+		// there is nothing painted to build the mask from (frozen or not yet created)
+		return;
+	}
+
+	// clip the rectangle to the frame
+	const int nRight = (nLeft + nWidth < nFrameWidth) ? nLeft + nWidth : nFrameWidth;
+	const int nBottom = (nTop + nHeight < nFrameHeight) ? nTop + nHeight : nFrameHeight;
+	if (nLeft < 0)
+		nLeft = 0;
+	if (nTop < 0)
+		nTop = 0;
+	if (nLeft >= nRight || nTop >= nBottom)
+	{
+		// empty rectangle
+		return;
+	}
+
+	// every cell the rectangle touches is sampled again, the image holds the whole current frame in its upper left part
+	const uint8 *pImageData = m_cImage.GetBuffer()->GetData();
+	for (int nCellY = nTop / COVERAGECELLSIZE; nCellY <= (nBottom - 1) / COVERAGECELLSIZE; nCellY++)
+	{
+		for (int nCellX = nLeft / COVERAGECELLSIZE; nCellX <= (nRight - 1) / COVERAGECELLSIZE; nCellX++)
+		{
+			const int nEndY = ((nCellY + 1) * COVERAGECELLSIZE < nFrameHeight) ? (nCellY + 1) * COVERAGECELLSIZE : nFrameHeight;
+			const int nEndX = ((nCellX + 1) * COVERAGECELLSIZE < nFrameWidth) ? (nCellX + 1) * COVERAGECELLSIZE : nFrameWidth;
+			bool bCovered = false;
+			for (int nY = nCellY * COVERAGECELLSIZE; nY < nEndY && !bCovered; nY++)
+			{
+				// the alpha is the fourth byte of every pixel
+				const uint8 *pPixel = pImageData + (nY * m_nImageWidth + nCellX * COVERAGECELLSIZE) * 4 + 3;
+				for (int nX = nCellX * COVERAGECELLSIZE; nX < nEndX; nX++, pPixel += 4)
+				{
+					if (*pPixel >= m_nAlphaHitTestThreshold)
+					{
+						bCovered = true;
+						break;
+					}
+				}
+			}
+
+			uint8 &nMaskByte = m_pCoverageMask[nCellY * nMaskRowSize + nCellX / 8];
+			if (bCovered)
+				nMaskByte |= uint8(1 << (nCellX % 8));
+			else
+				nMaskByte &= uint8(~(1 << (nCellX % 8)));
+		}
+	}
+}
+
+
+uint32 SRPWindow::GetZOrderRevision()
+{
+	return g_nZOrderRevision;
+}
+
+
+int SRPWindow::GetSceneRenderPassIndex()
+{
+	if (m_pCurrentSceneRenderer)
+	{
+		// return scene render pass index
+		return m_pCurrentSceneRenderer->GetIndex(*reinterpret_cast<SceneRendererPass*>(this));
+	}
+	else
+	{
+		return -1;
+	}
+}
+
+
+void SRPWindow::onJavascriptCallback(Berkelium::Window *win, void *replyMsg, Berkelium::URLString origin, Berkelium::WideString funcName, Berkelium::Script::Variant *args, size_t numArgs)
+{
+	//	Javascript has called a bound function on this Window.
+	//	Parameters:
+	//		win			Window instance that fired this event.
+	// 		pReplyMsg	If non-NULL, opaque reply identifier to be passed to synchronousScriptReturn.
+	// 		url			Origin of the sending script.
+	// 		funcName	name of function to call.
+	// 		args		list of variants passed into function.
+	// 		numArgs		number of arguments.
+
+	if (IsOnBerkeliumThread())
+	{
+		// the arguments are only valid during this call, copy them and let Gui dispatch the callback on update,
+		// the reply identifier stays valid until it is answered, the return goes back with a command
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventJavascriptCallback, win);
+		psEvent->pReplyMsg = replyMsg;
+		psEvent->sUrl = String(origin.data(), true, int(origin.length()));
+		psEvent->sText = String(funcName.data(), true, int(funcName.length()));
+		psEvent->nNumArgs = numArgs;
+		if (numArgs > 0)
+		{
+			psEvent->pArgs = new Berkelium::Script::Variant[numArgs];
+			for (size_t i = 0; i < numArgs; i++)
+			{
+				psEvent->pArgs[i] = args[i];
+			}
+		}
+		m_pEventQueue->Push(psEvent);
+		return;
+	}
+
+	if (!m_nFirstCallBackLatency && m_nCreateRequestTime)
+	{
+		// the first interaction of the page
+		m_nFirstCallBackLatency = System::GetInstance()->GetMicroseconds() - m_nCreateRequestTime;
+	}
+
+	// the functions are bound by their interned id, so there are no names to compare
+	const uint32 nId = GetCallBackId(funcName);
+	if (nId >= CallBackFunctions && (nId - CallBackFunctions) < m_lstCallBackFunctionTable.GetNumOfElements())
+	{
+		// call the callback function, it answers javascript when javascript waits for the return
+		PostCallBackFunction(m_lstCallBackFunctionTable[nId - CallBackFunctions], args, numArgs, replyMsg);
+		return;
+	}
+
+	if (replyMsg)
+	{
+		// nothing else has a return, but javascript must not wait forever
+		SendScriptReturn(replyMsg, "");
+	}
+
+	if (nId == CallBackNativePost)
+	{
+		// a batch of messages the page has posted within one animation frame
+		DispatchNativePost(args, numArgs);
+	}
+	else if (nId == CallBackNativeCall)
+	{
+		// the page waits for a promise, not for us
+		DispatchNativeCall(args, numArgs);
+	}
+	else if (nId < NUMOFDEFAULTCALLBACKS && !m_ppDefaultCallBacks[nId])
+	{
+		// create new callback
+		sCallBack *pCallBack = new sCallBack;
+
+		// set the callback attributes
+		static const char *pszDefaultCallBackNames[NUMOFDEFAULTCALLBACKS] = { DRAGWINDOW, HIDEWINDOW, CLOSEWINDOW, RESIZEWINDOW };
+		pCallBack->pWindow = win;
+		pCallBack->sFunctionName = pszDefaultCallBackNames[nId];
+		pCallBack->nId = nId;
+		pCallBack->nNumberOfParameters = numArgs;
+		pCallBack->OriginUrl = origin;
+		pCallBack->pReplyMsg = nullptr;
+		pCallBack->pParameters = args;
+
+		// add the callback to the table so that the Gui class can process it
+		m_ppDefaultCallBacks[nId] = pCallBack;
+
+		// let Gui know this window has a default callback to process
+		if (m_plstDefaultCallBackEvents)
+		{
+			sDefaultCallBackEvent *psEvent = new sDefaultCallBackEvent;
+			psEvent->pSRPWindow = this;
+			psEvent->nId = nId;
+			m_plstDefaultCallBackEvents->Add(psEvent);
+		}
+	}
+}
+
+
+void SRPWindow::MoveWindow(const int &nX, const int &nY)
+{
+	//question: [10-07-2012 Icefire] i am not sure yet if this method is right for this use case
+
+	m_psWindowsData->nXPos = nX;
+	m_psWindowsData->nYPos = nY;
+	const Vector2i vSize = GetPreviewSize();
+	UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(nX), float(nY)), Vector2(float(vSize.x), float(vSize.y)));
+}
+
+
+void SRPWindow::onTooltipChanged(Berkelium::Window *win, Berkelium::WideString text)
+{
+	//undone: [10-07-2012 Icefire] deprecate
+
+	if (IsOnBerkeliumThread())
+	{
+		// the tool tip window is created and drawn by the render thread
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventTooltipChanged, win);
+		psEvent->sText = String(text.data(), true, int(text.length()));
+		m_pEventQueue->Push(psEvent);
+		return;
+	}
+
+	if (m_bToolTipEnabled)
+	{
+		if (!m_pToolTip)
+		{
+			// tool tip needs to be created
+			SetupToolTipWindow();
+		}
+		// set the tooltip
+		SetToolTip(String(text.data()));
+	}
+}
+
+
+void SRPWindow::SetupToolTipWindow()
+{
+	//undone: [10-07-2012 Icefire] deprecate
+
+	// create tool tip window and set data
+	m_pToolTip = new SRPWindow("ToolTip");
+	m_pToolTip->GetData()->bIsVisable = false;
+	m_pToolTip->GetData()->sUrl = "file:///D:/plice/PLMain/Code/GameClient/bin/tooltip.html";
+	m_pToolTip->GetData()->nFrameWidth = 512;
+	m_pToolTip->GetData()->nFrameHeight = 64;
+	m_pToolTip->GetData()->nXPos = 0;
+	m_pToolTip->GetData()->nYPos = 0;
+	m_pToolTip->GetData()->bTransparent = true;
+	m_pToolTip->GetData()->bKeyboardEnabled = false;
+	m_pToolTip->GetData()->bMouseEnabled = false;
+	m_pToolTip->GetData()->bNeedsFullUpdate = true;
+	m_pToolTip->GetData()->bLoaded = false;
+	m_pToolTip->SetBerkeliumThread(m_pBerkeliumThread);
+	m_pToolTip->SetTexturePool(m_pTexturePool);
+	m_pToolTip->SetTextureAtlas(m_pTextureAtlas);
+
+	// initialize the tool tip
+	if (m_pToolTip->Initialize(m_pCurrentRenderer, Vector2::Zero, Vector2(float(512), float(64))))
+	{
+		// the tool tip is about to be shown, so we create its berkelium window right away
+		m_pToolTip->CreateBerkeliumWindow();
+		// add the scene render pass for the tool tip
+		m_pToolTip->AddSceneRenderPass(m_pCurrentSceneRenderer);
+	}
+	else
+	{
+		// destroy the left overs because the tooltip could not be initialized
+		DestroyToolTipWindow();
+	}
+}
+
+
+void SRPWindow::DestroyToolTipWindow()
+{
+	//undone: [10-07-2012 Icefire] deprecate
+
+	if (m_pToolTip)
+	{
+		m_pToolTip->DestroyInstance();
+		m_pToolTip = nullptr;
+	}
+}
+
+
+void SRPWindow::SetToolTip(const String &sText)
+{
+	//undone: [10-07-2012 Icefire] deprecate
+
+	if (m_pToolTip)
+	{
+		if (sText == "")
+		{
+			m_pToolTip->ExecuteJavascript("fadeEffect(1, 0, 5);");
+			m_pToolTip->GetData()->bIsVisable = false;
+		}
+		else
+		{
+			Frontend &cFrontend = static_cast<FrontendApplication*>(CoreApplication::GetApplication())->GetFrontend();
+			m_pToolTip->MoveWindow(cFrontend.GetMousePositionX() + 10, cFrontend.GetMousePositionY() + 6);
+			m_pToolTip->ExecuteJavascript("SetToolTip('" + sText + "')");
+			m_pToolTip->MoveToFront();
+			m_pToolTip->GetData()->bIsVisable = true;
+			m_pToolTip->ExecuteJavascript("fadeEffect(0, 1, 15);");
+		}
+	}
+}
+
+
+void SRPWindow::SetToolTipEnabled(const bool &bEnabled)
+{
+	//undone: [10-07-2012 Icefire] deprecate
+
+	m_bToolTipEnabled = bEnabled;
+
+	if (!bEnabled)
+	{
+		// clear tool tip because we disabled it
+		SetToolTip("");
+	}
+}
+
+
+void SRPWindow::RemoveCallBacks() const
+{
+	// loop trough the callbacks
+	for (uint32 i = 0; i < NUMOFDEFAULTCALLBACKS; i++)
+	{
+		// cleanup, the parameters and reply message are owned by berkelium
+		delete m_ppDefaultCallBacks[i];
+		m_ppDefaultCallBacks[i] = nullptr;
+	}
+}
+
+
+uint32 SRPWindow::GetNumberOfCallBacks() const
+{
+	uint32 nNumOfCallBacks = 0;
+	for (uint32 i = 0; i < NUMOFDEFAULTCALLBACKS; i++)
+	{
+		if (m_ppDefaultCallBacks[i])
+			nNumOfCallBacks++;
+	}
+	return nNumOfCallBacks;
+}
+
+
+sCallBack *SRPWindow::GetCallBack(const String &sKey) const
+{
+	return GetDefaultCallBack(GetDefaultCallBackId(sKey));
+}
+
+
+sCallBack *SRPWindow::GetDefaultCallBack(const uint32 &nId) const
+{
+	return (nId < NUMOFDEFAULTCALLBACKS) ? m_ppDefaultCallBacks[nId] : nullptr;
+}
+
+
+void SRPWindow::ResizeWindow(const int &nWidth, const int &nHeight)
+{
+	//fix: [10-07-2012 Icefire] let (re)sizing be handled by the program uniform, see http://dev.pixellight.org/forum/viewtopic.php?f=6&t=503
+	// buffer overflows on resize happen to often to accept the current method as is
+
+	// the resize replaces any preview
+	m_bResizePreview = false;
+	m_nResizeCount++;
+
+	m_bIgnoreBufferUpdate = true;
+
+	m_psWindowsData->bNeedsFullUpdate = true;
+
+	m_bReadyToDraw = false;
+
+	m_psWindowsData->nFrameWidth = nWidth;
+	m_psWindowsData->nFrameHeight = nHeight;
+
+	// a window that gets small moves into the atlas, a window that gets too big moves out of it
+	if (m_pTextureAtlas)
+	{
+		if (TextureAtlas::Fits(nWidth, nHeight))
+		{
+			// a window that has just moved out and comes back takes its old rect along
+			sAtlasRect *psAtlasRect = m_psAtlasRect ? m_psAtlasRect : m_psAtlasRectOld;
+			m_psAtlasRectOld = nullptr;
+			m_psAtlasRect = m_pTextureAtlas->Reallocate(psAtlasRect, nWidth, nHeight);
+		}
+		else if (m_psAtlasRect)
+		{
+			// the old rect is drawn on its own until the texture of the window has been painted, see BufferUploadToGPU()
+			m_psAtlasRectOld = m_psAtlasRect;
+			m_psAtlasRect = nullptr;
+			m_pTextureAtlas->SetQuad(*m_psAtlasRectOld, m_psAtlasRectOld->vQuadPosition, m_psAtlasRectOld->vQuadSize, m_psAtlasRectOld->vUsedSize, false);
+		}
+	}
+
+	const int nImageWidth = GetTextureCapacity(nWidth, m_nImageWidth);
+	const int nImageHeight = GetTextureCapacity(nHeight, m_nImageHeight);
+	if (nImageWidth != m_nImageWidth || nImageHeight != m_nImageHeight)
+	{
+		// the size does not fit the capacity, within it only the drawn part of the texture changes, see DrawWindow()
+		DestroyTextureBuffer(m_pTextureBufferNew, m_nImageWidth, m_nImageHeight);
+		m_nImageWidth = nImageWidth;
+		m_nImageHeight = nImageHeight;
+		m_cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(m_nImageWidth, m_nImageHeight, 1));
+		m_pTextureBufferNew = m_psAtlasRect ? nullptr : CreateTextureBuffer(m_cImage);
+
+		if (m_bFrozen)
+		{
+			// a frozen window keeps drawing its snapshot and recreates the image when thawed
+			m_cImage = Image();
+		}
+	}
+
+	UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(m_psWindowsData->nFrameWidth), float(m_psWindowsData->nFrameHeight)));
+
+	if (m_bBerkeliumWindowCreated)
+	{
+		// a berkelium window that is not created yet will get the new size on creation
+		SendResize(m_psWindowsData->nFrameWidth, m_psWindowsData->nFrameHeight);
+	}
+
+	m_bReadyToDraw = true;
+
+	m_bIgnoreBufferUpdate = false;
+}
+
+
+void SRPWindow::PreviewResize(const int &nWidth, const int &nHeight)
+{
+	if (!m_nResizeStableTime || (!m_pTextureBuffer && !m_psAtlasRect && !m_psAtlasRectOld))
+	{
+		// no debouncing or nothing to stretch yet
+		ResizeWindow(nWidth, nHeight);
+		return;
+	}
+
+	const uint64 nTime = Timing::GetInstance()->GetPastTime();
+	if (!m_bResizePreview)
+	{
+		m_bResizePreview = true;
+		m_nPreviewStartTime = nTime;
+		if (m_plstResizePreviewWindows && !m_plstResizePreviewWindows->IsElement(this))
+		{
+			// let Gui know this window has a preview to apply, it leaves the list once the preview is gone
+			m_plstResizePreviewWindows->Add(this);
+		}
+	}
+	m_nPreviewWidth = nWidth;
+	m_nPreviewHeight = nHeight;
+	m_nPreviewChangeTime = nTime;
+	m_nPreviewResizeCount++;
+
+	// only the quad changes, the texture is stretched over it
+	UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(nWidth), float(nHeight)));
+}
+
+
+Vector2i SRPWindow::GetPreviewSize() const
+{
+	return m_bResizePreview ? Vector2i(m_nPreviewWidth, m_nPreviewHeight) : GetSize();
+}
+
+
+bool SRPWindow::IsResizePreviewed() const
+{
+	return m_bResizePreview;
+}
+
+
+void SRPWindow::SetResizeDebounce(const uint64 &nStableTime, const uint64 &nMaxPreviewTime)
+{
+	m_nResizeStableTime = nStableTime;
+	m_nMaxPreviewTime = nMaxPreviewTime;
+}
+
+
+void SRPWindow::ApplyResizePreview()
+{
+	if (m_bResizePreview)
+	{
+		if (m_nPreviewWidth == m_psWindowsData->nFrameWidth && m_nPreviewHeight == m_psWindowsData->nFrameHeight)
+		{
+			// the size ended up where it started, only the quad has to be restored
+			m_bResizePreview = false;
+			UpdateVertexBuffer(m_pVertexBuffer, Vector2(float(m_psWindowsData->nXPos), float(m_psWindowsData->nYPos)), Vector2(float(m_nPreviewWidth), float(m_nPreviewHeight)));
+		}
+		else
+		{
+			ResizeWindow(m_nPreviewWidth, m_nPreviewHeight);
+		}
+	}
+}
+
+
+void SRPWindow::UpdateResizePreview()
+{
+	if (m_bResizePreview)
+	{
+		const uint64 nTime = Timing::GetInstance()->GetPastTime();
+		if ((nTime - m_nPreviewChangeTime) >= m_nResizeStableTime || (m_nMaxPreviewTime && (nTime - m_nPreviewStartTime) >= m_nMaxPreviewTime))
+		{
+			// the size has settled or the preview has been stretched for long enough
+			ApplyResizePreview();
+		}
+	}
+}
+
+
+uint32 SRPWindow::GetResizeCount() const
+{
+	return m_nResizeCount;
+}
+
+
+uint32 SRPWindow::GetPreviewResizeCount() const
+{
+	return m_nPreviewResizeCount;
+}
+
+
+uint32 SRPWindow::GetTextureAllocationCount() const
+{
+	return m_nTextureAllocationCount;
+}
+
+
+bool SRPWindow::AddCallBackFunction(const DynFuncPtr pDynFunc, String sJSFunctionName, bool bHasReturn, uint32 nCoalescePolicy)
+{
+	if (pDynFunc)
+	{
+		// create function descriptor
+		const FuncDesc *pFuncDesc = pDynFunc->GetDesc();
+		if (pFuncDesc)
+		{
+			if (m_pmapCallBackFunctions->Get(pFuncDesc->GetName()) == NULL)
+			{
+				if (sJSFunctionName == "")
+				{
+					// the function name is not defined so we use the method name
+					sJSFunctionName = pFuncDesc->GetName();
+				}
+
+				// create the callback function
+				sCallBackFunction *psCallBackFunction = new sCallBackFunction;
+				psCallBackFunction->pDynFunc = pDynFunc;
+				psCallBackFunction->sJSFunctionName = sJSFunctionName;
+				psCallBackFunction->bHasReturn = bHasReturn;
+				psCallBackFunction->bTyped = ScriptParams::IsSupported(*pDynFunc);
+				psCallBackFunction->nCoalescePolicy = nCoalescePolicy;
+				psCallBackFunction->psCoalescedCallBack = nullptr;
+				// the function gets the next free slot of the dispatch table
+				psCallBackFunction->nId = CallBackFunctions + m_lstCallBackFunctionTable.GetNumOfElements();
+
+				if (m_bBerkeliumWindowCreated)
+				{
+					// we bind the javascript function, otherwise it gets bound when the berkelium window is created
+					BindCallBackFunction(psCallBackFunction->nId, pFuncDesc->GetName(), sJSFunctionName, bHasReturn);
+					AddStartLoadingScript("if (window.native) window.native._ids[" + ToJavascriptString(pFuncDesc->GetName()) + "] = " + String(psCallBackFunction->nId) + ";");
+				}
+
+				// we add the callback function to the hashmap and the dispatch table
+				m_pmapCallBackFunctions->Add(pFuncDesc->GetName(), psCallBackFunction);
+				m_lstCallBackFunctionTable.Add(psCallBackFunction);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+void SRPWindow::onRunFileChooser(Berkelium::Window *win, int mode, Berkelium::WideString title, Berkelium::FileString defaultFile)
+{
+	//undone: [10-07-2012 Icefire] not used or implemented
+
+	DebugToConsole("onRunFileChooser()\n");
+	
+	//undone: [10-07-2012 Icefire] is this implemented at all? https://groups.google.com/d/topic/berkelium/vKGuEpt9CbI/discussion
+	// awaiting new build for berkelium
+}
+
+
+bool SRPWindow::RemoveCallBack(const String &sKey) const
+{
+	return RemoveDefaultCallBack(GetDefaultCallBackId(sKey));
+}
+
+
+bool SRPWindow::RemoveDefaultCallBack(const uint32 &nId) const
+{
+	if (nId >= NUMOFDEFAULTCALLBACKS || m_ppDefaultCallBacks[nId] == NULL)
+	{
+		return false;
+	}
+	else
+	{
+		// cleanup, the parameters and reply message are owned by berkelium
+		delete m_ppDefaultCallBacks[nId];
+		// we remove the callback
+		m_ppDefaultCallBacks[nId] = nullptr;
+		return true;
+	}
+}
+
+
+void SRPWindow::SetDefaultCallBackFunctions(const sBootstrapScript *psBootstrapScript)
+{
+	// bind the default javascript functions for use
+	// this allows for users to set default javascript functions within their web page to be able to drag, hide, close and resize a window
+
+	// native.post() batches calls to the callback functions into one NativePost call per animation frame, native.call() returns a promise
+	static const struct
+	{
+		const char *pszJSFunctionName;
+		uint32 nId;
+	} sDefaultBindings[] = {
+		{ DRAGWINDOW,	CallBackDragWindow   },
+		{ HIDEWINDOW,	CallBackHideWindow   },
+		{ CLOSEWINDOW,	CallBackCloseWindow  },
+		{ RESIZEWINDOW,	CallBackResizeWindow },
+		{ NATIVEPOST,	CallBackNativePost   },
+		{ NATIVECALL,	CallBackNativeCall   }
+	};
+	for (uint32 i = 0; i < sizeof(sDefaultBindings)/sizeof(sDefaultBindings[0]); i++)
+	{
+		BindFunctionId(sDefaultBindings[i].pszJSFunctionName, sDefaultBindings[i].nId, false);
+	}
+
+	// the bootstrap script of Gui already contains the built-in script and the helper libraries, so it is applied in one step
+	if (psBootstrapScript)
+	{
+		// berkelium can be called directly here, the unicode copy is used as it is
+		m_pBerkeliumWindow->addEvalOnStartLoading(Berkelium::WideString::point_to(psBootstrapScript->pszScript, psBootstrapScript->nLength));
+		if (!m_pBerkeliumThread)
+			m_nNumOfStartLoadingScripts++;
+	}
+	else
+	{
+		#include "NativePost_JS.h"
+		AddStartLoadingScript(sNativePostSourceCodeJS);
+	}
+}
+
+
+void SRPWindow::BindFunctionId(const String &sJSFunctionName, const uint32 &nId, const bool &bHasReturn)
+{
+	// berkelium reports calls by the name the function is bound with, which is its id
+	const String sId = nId;
+	m_pBerkeliumWindow->addBindOnStartLoading(Berkelium::WideString::point_to(sJSFunctionName.GetUnicode()), Berkelium::Script::Variant::bindFunction(Berkelium::WideString::point_to(sId.GetUnicode()), bHasReturn));
+}
+
+
+void SRPWindow::BindCallBackFunction(const uint32 &nId, const String &sFunctionName, const String &sJSFunctionName, const bool &bHasReturn)
+{
+	if (QueueCommand(sBrowserCommand::CommandBind, bHasReturn, nId, 0, 0, sFunctionName, sJSFunctionName))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		// we bind the javascript function
+		BindFunctionId(sJSFunctionName, nId, bHasReturn);
+	}
+}
+
+
+void SRPWindow::BindCallBackFunctions()
+{
+	// native.post() and native.call() send the id instead of the name, the ids of all functions go into one manifest script
+	String sManifest = "";
+
+	// get the iterator for the callback function names
+	Iterator<String> cIterator = m_pmapCallBackFunctions->GetKeyIterator();
+	// loop trough the callback functions
+	while (cIterator.HasNext())
+	{
+		const String sFunctionName = cIterator.Next();
+		const sCallBackFunction *psCallBackFunction = m_pmapCallBackFunctions->Get(sFunctionName);
+		BindCallBackFunction(psCallBackFunction->nId, sFunctionName, psCallBackFunction->sJSFunctionName, psCallBackFunction->bHasReturn);
+		sManifest += "window.native._ids[" + ToJavascriptString(sFunctionName) + "] = " + String(psCallBackFunction->nId) + ";";
+	}
+
+	if (sManifest.GetLength())
+	{
+		AddStartLoadingScript("if (window.native) {" + sManifest + "}");
+	}
+}
+
+
+void SRPWindow::AddStartLoadingScript(const String &sJavascript)
+{
+	if (QueueCommand(sBrowserCommand::CommandEvalOnStartLoading, 0, 0, 0, 0, sJavascript))
+	{
+		// the scripts are counted by us, not by the berkelium thread
+		m_nNumOfStartLoadingScripts++;
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->addEvalOnStartLoading(Berkelium::WideString::point_to(sJavascript.GetUnicode()));
+		if (!m_pBerkeliumThread)
+			m_nNumOfStartLoadingScripts++;
+	}
+}
+
+
+void SRPWindow::onWidgetCreated(Berkelium::Window *win, Berkelium::Widget *newWidget, int zIndex)
+{
+	if (IsOnBerkeliumThread())
+	{
+		// widgets need renderer resources, let Draw() create them
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventWidgetCreated, win, newWidget);
+		psEvent->nParam[0] = zIndex;
+		m_pPaintQueue->Push(psEvent);
+		return;
+	}
+
+	// we create the widget
+	sWidget *psWidget = new sWidget;
+
+	// we set the data
+	psWidget->bNeedsFullUpdate = true;
+	psWidget->nXPos = m_psWindowsData->nXPos;
+	psWidget->nYPos = m_psWindowsData->nYPos;
+	psWidget->pProgramWrapper = CreateProgramWrapper();
+	psWidget->pVertexBuffer = CreateVertexBuffer(Vector2::Zero, Vector2::Zero);
+	// the image and texture buffer are created on the first resize
+	psWidget->pTextureBuffer = nullptr;
+	psWidget->nTextureWidth = 0;
+	psWidget->nTextureHeight = 0;
+	psWidget->psAtlasRect = nullptr;
 
 	// we add the widget to the hashmap
 	m_pmapWidgets->Add(newWidget, psWidget);
@@ -1138,30 +3100,34 @@ void SRPWindow::onWidgetCreated(Berkelium::Window *win, Berkelium::Widget *newWi
 
 void SRPWindow::onWidgetDestroyed(Berkelium::Window *win, Berkelium::Widget *wid)
 {
+	if (IsOnBerkeliumThread())
+	{
+		m_pPaintQueue->Push(CreateBrowserEvent(sBrowserEvent::EventWidgetDestroyed, win, wid));
+		return;
+	}
+
 	// get the widget that got the destroy callback
 	sWidget *psWidget = m_pmapWidgets->Get(wid);
 	if (psWidget)
 	{
-		// delete the resources used by this widget
-		if (nullptr != psWidget->pVertexBuffer)
-		{
-			delete psWidget->pVertexBuffer;
-			psWidget->pVertexBuffer = nullptr;
-		}
-		if (nullptr != psWidget->pTextureBuffer)
-		{
-			delete psWidget->pTextureBuffer;
-			psWidget->pTextureBuffer = nullptr;
-		}
-
 		// remove it
 		m_pmapWidgets->Remove(wid);
+		DestroyWidget(psWidget);
 	}
 }
 
 
 void SRPWindow::onWidgetMove(Berkelium::Window *win, Berkelium::Widget *wid, int newX, int newY)
 {
+	if (IsOnBerkeliumThread())
+	{
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventWidgetMove, win, wid);
+		psEvent->nParam[0] = newX;
+		psEvent->nParam[1] = newY;
+		m_pPaintQueue->Push(psEvent);
+		return;
+	}
+
 	// get the widget that got the move callback
 	sWidget *psWidget = m_pmapWidgets->Get(wid);
 	if (psWidget)
@@ -1180,6 +3146,15 @@ void SRPWindow::onWidgetMove(Berkelium::Window *win, Berkelium::Widget *wid, int
 
 void SRPWindow::onWidgetPaint(Berkelium::Window *win, Berkelium::Widget *wid, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect)
 {
+	if (IsOnBerkeliumThread())
+	{
+		// the buffer is only valid during this call, copy it and let Draw() apply it
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventWidgetPaint, win, wid);
+		CopyPaint(psEvent, sourceBuffer, sourceBufferRect, numCopyRects, copyRects, dx, dy, scrollRect);
+		m_pPaintQueue->Push(psEvent);
+		return;
+	}
+
 	// get the widget that got the paint callback
 	sWidget *psWidget = m_pmapWidgets->Get(wid);
 	if (psWidget)
@@ -1188,8 +3163,8 @@ void SRPWindow::onWidgetPaint(Berkelium::Window *win, Berkelium::Widget *wid, co
 		{
 			// awaiting a full update disregard all partials ones until the full comes in
 			uint8 *pImageBuffer = psWidget->cImage.GetBuffer()->GetData();
-			BufferCopyFull(pImageBuffer, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect);
-			psWidget->pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, pImageBuffer);
+			BufferCopyFull(pImageBuffer, psWidget->nTextureWidth, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect);
+			UploadWidget(psWidget);
 			psWidget->bNeedsFullUpdate = false;
 		}
 		else
@@ -1198,8 +3173,8 @@ void SRPWindow::onWidgetPaint(Berkelium::Window *win, Berkelium::Widget *wid, co
 			{
 				// did not suspect a full update but got it anyway, it might happen and is ok
 				uint8 *pImageBuffer = psWidget->cImage.GetBuffer()->GetData();
-				BufferCopyFull(pImageBuffer, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect);
-				psWidget->pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, pImageBuffer);
+				BufferCopyFull(pImageBuffer, psWidget->nTextureWidth, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect);
+				UploadWidget(psWidget);
 			}
 			else
 			{
@@ -1207,15 +3182,15 @@ void SRPWindow::onWidgetPaint(Berkelium::Window *win, Berkelium::Widget *wid, co
 				{
 					// a scroll has taken place
 					uint8 *pImageBuffer = psWidget->cImage.GetBuffer()->GetData();
-					BufferCopyScroll(pImageBuffer, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects, dx, dy, scrollRect);
-					psWidget->pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, pImageBuffer);
+					BufferCopyScroll(pImageBuffer, psWidget->nTextureWidth, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects, dx, dy, scrollRect);
+					UploadWidget(psWidget);
 				}
 				else
 				{
 					// normal partial updates
 					uint8 *pImageBuffer = psWidget->cImage.GetBuffer()->GetData();
-					BufferCopyRects(pImageBuffer, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects);
-					psWidget->pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, pImageBuffer);
+					BufferCopyRects(pImageBuffer, psWidget->nTextureWidth, psWidget->nWidth, psWidget->nHeight, sourceBuffer, sourceBufferRect, numCopyRects, copyRects);
+					UploadWidget(psWidget);
 				}
 			}
 		}
@@ -1225,6 +3200,15 @@ void SRPWindow::onWidgetPaint(Berkelium::Window *win, Berkelium::Widget *wid, co
 
 void SRPWindow::onWidgetResize(Berkelium::Window *win, Berkelium::Widget *wid, int newWidth, int newHeight)
 {
+	if (IsOnBerkeliumThread())
+	{
+		sBrowserEvent *psEvent = CreateBrowserEvent(sBrowserEvent::EventWidgetResize, win, wid);
+		psEvent->nParam[0] = newWidth;
+		psEvent->nParam[1] = newHeight;
+		m_pPaintQueue->Push(psEvent);
+		return;
+	}
+
 	// get the widget that got the resize callback
 	sWidget *psWidget = m_pmapWidgets->Get(wid);
 	if (psWidget)
@@ -1238,21 +3222,47 @@ void SRPWindow::onWidgetResize(Berkelium::Window *win, Berkelium::Widget *wid, i
 		// update the buffer
 		UpdateVertexBuffer(psWidget->pVertexBuffer, Vector2(float(psWidget->nXPos), float(psWidget->nYPos)), Vector2(float(psWidget->nWidth), float(psWidget->nHeight)));
 
-		// recreate the image
-		psWidget->cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(psWidget->nWidth, psWidget->nHeight, 1));
+		// small widgets are drawn from the atlas
+		if (m_pTextureAtlas)
+		{
+			psWidget->psAtlasRect = m_pTextureAtlas->Reallocate(psWidget->psAtlasRect, newWidth, newHeight);
+		}
+
+		const int nTextureWidth = GetTextureCapacity(newWidth, psWidget->nTextureWidth);
+		const int nTextureHeight = GetTextureCapacity(newHeight, psWidget->nTextureHeight);
+		const bool bCapacityChanged = (nTextureWidth != psWidget->nTextureWidth || nTextureHeight != psWidget->nTextureHeight);
+		if (psWidget->pTextureBuffer && (bCapacityChanged || psWidget->psAtlasRect))
+		{
+			// the texture buffer does not fit anymore or the widget has moved into the atlas
+			DestroyTextureBuffer(psWidget->pTextureBuffer, psWidget->nTextureWidth, psWidget->nTextureHeight);
+			psWidget->pTextureBuffer = nullptr;
+		}
+		if (bCapacityChanged)
+		{
+			// the size does not fit the capacity (popup menus keep changing their size)
+			psWidget->nTextureWidth = nTextureWidth;
+			psWidget->nTextureHeight = nTextureHeight;
 
-		// recreate the texture buffer
-		if (nullptr != psWidget->pTextureBuffer)
+			// recreate the image
+			psWidget->cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(psWidget->nTextureWidth, psWidget->nTextureHeight, 1));
+		}
+		if (!psWidget->pTextureBuffer && !psWidget->psAtlasRect)
 		{
-			delete psWidget->pTextureBuffer;
+			// recreate the texture buffer
+			psWidget->pTextureBuffer = CreateTextureBuffer(psWidget->cImage);
 		}
-		psWidget->pTextureBuffer = reinterpret_cast<TextureBuffer*>(m_pCurrentRenderer->CreateTextureBuffer2D(psWidget->cImage, TextureBuffer::Unknown, 0));
 	}
 }
 
 
 void SRPWindow::DrawWidget(sWidget *psWidget)
 {
+	if (!psWidget->pTextureBuffer && !psWidget->psAtlasRect)
+	{
+		// the widget has not been sized yet
+		return;
+	}
+
 	// set program
 	m_pCurrentRenderer->SetProgram(psWidget->pProgramWrapper);
 	// set render state to allow for transparency
@@ -1275,7 +3285,30 @@ void SRPWindow::DrawWidget(sWidget *psWidget)
 		if (pProgramUniform)
 			pProgramUniform->Set(m_mObjectSpaceToClipSpace);
 
-		const int nTextureUnit = psWidget->pProgramWrapper->Set("TextureMap", psWidget->pTextureBuffer);
+		// the program is shared with the window, so reset the color factor
+		pProgramUniform = psWidget->pProgramWrapper->GetUniform("ColorFactor");
+		if (pProgramUniform)
+			pProgramUniform->Set(1.0f, 1.0f, 1.0f, 1.0f);
+
+		// only the part of the texture the widget uses is drawn, in the atlas it starts at the rect of the widget
+		pProgramUniform = psWidget->pProgramWrapper->GetUniform("TextureCoordinateScale");
+		if (pProgramUniform)
+		{
+			if (psWidget->psAtlasRect)
+				pProgramUniform->Set(float(psWidget->nWidth) / float(TEXTUREATLASPAGESIZE), float(psWidget->nHeight) / float(TEXTUREATLASPAGESIZE));
+			else if (psWidget->nTextureWidth > 0 && psWidget->nTextureHeight > 0)
+				pProgramUniform->Set(float(psWidget->nWidth) / float(psWidget->nTextureWidth), float(psWidget->nHeight) / float(psWidget->nTextureHeight));
+		}
+		pProgramUniform = psWidget->pProgramWrapper->GetUniform("TextureCoordinateOffset");
+		if (pProgramUniform)
+		{
+			if (psWidget->psAtlasRect)
+				pProgramUniform->Set(float(psWidget->psAtlasRect->nX) / float(TEXTUREATLASPAGESIZE), float(psWidget->psAtlasRect->nY) / float(TEXTUREATLASPAGESIZE));
+			else
+				pProgramUniform->Set(0.0f, 0.0f);
+		}
+
+		const int nTextureUnit = psWidget->pProgramWrapper->Set("TextureMap", psWidget->psAtlasRect ? m_pTextureAtlas->GetTextureBuffer(*psWidget->psAtlasRect) : psWidget->pTextureBuffer);
 		if (nTextureUnit >= 0)
 		{
 			m_pCurrentRenderer->SetSamplerState(nTextureUnit, Sampler::AddressU, TextureAddressing::Clamp);
@@ -1312,6 +3345,33 @@ void SRPWindow::DrawWidgets()
 }
 
 
+void SRPWindow::UploadWidget(sWidget *psWidget)
+{
+	if (psWidget->psAtlasRect)
+	{
+		// the atlas page is uploaded when it is drawn
+		m_pTextureAtlas->CopyToRect(*psWidget->psAtlasRect, psWidget->cImage.GetBuffer()->GetData(), psWidget->nTextureWidth, psWidget->nWidth, psWidget->nHeight);
+	}
+	else if (psWidget->pTextureBuffer)
+	{
+		psWidget->pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, psWidget->cImage.GetBuffer()->GetData());
+	}
+}
+
+
+void SRPWindow::DestroyWidget(sWidget *psWidget)
+{
+	// give the resources used by the widget back, the next popup will use them
+	DestroyVertexBuffer(psWidget->pVertexBuffer);
+	DestroyTextureBuffer(psWidget->pTextureBuffer, psWidget->nTextureWidth, psWidget->nTextureHeight);
+	if (m_pTextureAtlas)
+	{
+		m_pTextureAtlas->Free(psWidget->psAtlasRect);
+	}
+	delete psWidget;
+}
+
+
 HashMap<Berkelium::Widget*, sWidget*> *SRPWindow::GetWidgets() const
 {
 	return m_pmapWidgets;
@@ -1324,10 +3384,99 @@ Vector2i SRPWindow::GetRelativeMousePositionWidget(const sWidget *psWidget, cons
 }
 
 
-void SRPWindow::ExecuteJavascript(const String &sJavascript) const
+void SRPWindow::ExecuteJavascript(const String &sJavascript)
+{
+	if (!IsOnBerkeliumThread() && !m_bBerkeliumWindowCreated)
+	{
+		// there is no page yet, the javascript is executed once there is one
+		m_lstPendingJavascript.Add(sJavascript);
+		return;
+	}
+
+	if (QueueCommand(sBrowserCommand::CommandJavascript, 0, 0, 0, 0, sJavascript))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		// execute the javascript function
+		m_pBerkeliumWindow->executeJavascript(Berkelium::WideString::point_to(sJavascript.GetUnicode()));
+	}
+}
+
+
+void SRPWindow::EnqueueJavascript(const String &sJavascript, const String &sKey)
+{
+	if (sKey.GetLength())
+	{
+		// javascript with the same key is replaced but keeps its place
+		uint32 nIndex = m_pmapQueuedJavascriptKeys->Get(sKey);
+		if (nIndex)
+		{
+			m_lstQueuedJavascript[nIndex - 1] = sJavascript;
+			m_nReplacedJavascriptCount++;
+			return;
+		}
+		// the index is stored one based, the hashmap returns 0 for unknown keys
+		m_pmapQueuedJavascriptKeys->Add(sKey, m_lstQueuedJavascript.GetNumOfElements() + 1);
+	}
+	m_lstQueuedJavascript.Add(sJavascript);
+}
+
+
+void SRPWindow::FlushJavascript()
+{
+	ProcessSettledCallBacks();
+	SyncState();
+
+	if (m_lstQueuedJavascript.IsEmpty() || !m_bBerkeliumWindowCreated)
+	{
+		// nothing to execute or nothing to execute it on
+		return;
+	}
+
+	// one piece that throws should not stop the others, the error still goes to the console (see onConsoleMessage())
+	static const String sTry = "try{";
+	static const String sCatch = "\n}catch(e){console.error(String(e));}\n";
+
+	// the pieces are written into one buffer, appending them to a string would copy everything written so far each time
+	uint32 nLength = 0;
+	for (uint32 i = 0; i < m_lstQueuedJavascript.GetNumOfElements(); i++)
+	{
+		nLength += sTry.GetLength() + m_lstQueuedJavascript[i].GetLength() + sCatch.GetLength();
+	}
+	wchar_t *pszJavascript = new wchar_t[nLength + 1];
+	wchar_t *pszPosition = pszJavascript;
+	for (uint32 i = 0; i < m_lstQueuedJavascript.GetNumOfElements(); i++)
+	{
+		MemoryManager::Copy(pszPosition, sTry.GetUnicode(), sTry.GetLength() * sizeof(wchar_t));
+		pszPosition += sTry.GetLength();
+		MemoryManager::Copy(pszPosition, m_lstQueuedJavascript[i].GetUnicode(), m_lstQueuedJavascript[i].GetLength() * sizeof(wchar_t));
+		pszPosition += m_lstQueuedJavascript[i].GetLength();
+		MemoryManager::Copy(pszPosition, sCatch.GetUnicode(), sCatch.GetLength() * sizeof(wchar_t));
+		pszPosition += sCatch.GetLength();
+	}
+	*pszPosition = L'\0';
+	const String sJavascript(pszJavascript, true, int(nLength));
+	delete [] pszJavascript;
+	m_lstQueuedJavascript.Clear();
+	m_pmapQueuedJavascriptKeys->Clear();
+
+	ExecuteJavascript(sJavascript);
+	m_nFlushedJavascriptCount++;
+}
+
+
+uint32 SRPWindow::GetReplacedJavascriptCount() const
+{
+	return m_nReplacedJavascriptCount;
+}
+
+
+uint32 SRPWindow::GetFlushedJavascriptCount() const
 {
-	// execute the javascript function
-	GetBerkeliumWindow()->executeJavascript(Berkelium::WideString::point_to(sJavascript.GetUnicode()));
+	return m_nFlushedJavascriptCount;
 }
 
 
@@ -1348,6 +3497,376 @@ Image SRPWindow::GetImage() const
 }
 
 
+void SRPWindow::SendMouseMove(const int &nX, const int &nY) const
+{
+	if (QueueCommand(sBrowserCommand::CommandMouseMove, nX, nY))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->mouseMoved(nX, nY);
+	}
+}
+
+
+void SRPWindow::SendMouseButton(const uint32 &nButton, const bool &bDown, const int &nClickCount) const
+{
+	if (QueueCommand(sBrowserCommand::CommandMouseButton, nButton, bDown, nClickCount))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->mouseButton(nButton, bDown, nClickCount);
+	}
+}
+
+
+void SRPWindow::SendMouseWheel(const int &nX, const int &nY) const
+{
+	if (QueueCommand(sBrowserCommand::CommandMouseWheel, nX, nY))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->mouseWheel(nX, nY);
+	}
+}
+
+
+void SRPWindow::SendText(const String &sText) const
+{
+	if (QueueCommand(sBrowserCommand::CommandText, 0, 0, 0, 0, sText))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->textEvent(sText.GetUnicode(), sText.GetLength());
+	}
+}
+
+
+void SRPWindow::SendKey(const bool &bPressed, const int &nModifiers, const int &nVirtualKey, const int &nScanCode) const
+{
+	if (QueueCommand(sBrowserCommand::CommandKey, bPressed, nModifiers, nVirtualKey, nScanCode))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->keyEvent(bPressed, nModifiers, nVirtualKey, nScanCode);
+	}
+}
+
+
+void SRPWindow::SendFocus() const
+{
+	if (QueueCommand(sBrowserCommand::CommandFocus))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->focus();
+	}
+}
+
+
+void SRPWindow::SendUnfocus() const
+{
+	if (QueueCommand(sBrowserCommand::CommandUnfocus))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->unfocus();
+	}
+}
+
+
+void SRPWindow::SendNavigateTo(const String &sUrl) const
+{
+	if (QueueCommand(sBrowserCommand::CommandNavigate, 0, 0, 0, 0, sUrl))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->navigateTo(sUrl.GetASCII(), sUrl.GetLength());
+	}
+}
+
+
+void SRPWindow::SendResize(const int &nWidth, const int &nHeight) const
+{
+	if (QueueCommand(sBrowserCommand::CommandResize, nWidth, nHeight))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->resize(nWidth, nHeight);
+	}
+}
+
+
+void SRPWindow::SendReload() const
+{
+	if (QueueCommand(sBrowserCommand::CommandReload))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->refresh();
+	}
+}
+
+
+void SRPWindow::SendScriptReturn(void *pReplyMsg, const String &sResult) const
+{
+	if (QueueCommand(sBrowserCommand::CommandScriptReturn, 0, 0, 0, 0, sResult, "", pReplyMsg))
+	{
+		return;
+	}
+
+	if (m_pBerkeliumWindow)
+	{
+		m_pBerkeliumWindow->synchronousScriptReturn(pReplyMsg, Berkelium::Script::Variant(sResult.GetUnicode()));
+	}
+}
+
+
+bool SRPWindow::IsOnBerkeliumThread() const
+{
+	return (m_pBerkeliumThread && m_pBerkeliumThread->IsCurrentThread());
+}
+
+
+bool SRPWindow::QueueCommand(const uint32 &nType, const int &nParam0, const int &nParam1, const int &nParam2, const int &nParam3, const String &sParam0, const String &sParam1, void *pParam) const
+{
+	if (!m_pBerkeliumThread || m_pBerkeliumThread->IsCurrentThread())
+	{
+		// berkelium can be called directly
+		return false;
+	}
+
+	// create the command, the berkelium thread destroys it when executed
+	sBrowserCommand *psCommand = new sBrowserCommand;
+	psCommand->nType = nType;
+	psCommand->pSRPWindow = const_cast<SRPWindow*>(this);
+	psCommand->nParam[0] = nParam0;
+	psCommand->nParam[1] = nParam1;
+	psCommand->nParam[2] = nParam2;
+	psCommand->nParam[3] = nParam3;
+	psCommand->sParam[0] = sParam0;
+	psCommand->sParam[1] = sParam1;
+	psCommand->pParam = pParam;
+	m_pBerkeliumThread->PushCommand(psCommand);
+	return true;
+}
+
+
+sBrowserEvent *SRPWindow::CreateBrowserEvent(const uint32 &nType, Berkelium::Window *pWindow, Berkelium::Widget *pWidget) const
+{
+	sBrowserEvent *psEvent = new sBrowserEvent;
+	psEvent->nType = nType;
+	psEvent->nTime = System::GetInstance()->GetMicroseconds();
+	psEvent->nExecutedCommands = m_pBerkeliumThread ? m_pBerkeliumThread->GetNumOfExecutedCommands() : 0;
+	psEvent->pWindow = pWindow;
+	psEvent->pWidget = pWidget;
+	psEvent->nParam[0] = 0;
+	psEvent->nParam[1] = 0;
+	psEvent->pBuffer = nullptr;
+	psEvent->nNumCopyRects = 0;
+	psEvent->pCopyRects = nullptr;
+	psEvent->nNumArgs = 0;
+	psEvent->pArgs = nullptr;
+	psEvent->pReplyMsg = nullptr;
+	return psEvent;
+}
+
+
+void SRPWindow::CopyPaint(sBrowserEvent *psEvent, const unsigned char *sourceBuffer, const Berkelium::Rect &sourceBufferRect, size_t numCopyRects, const Berkelium::Rect *copyRects, int dx, int dy, const Berkelium::Rect &scrollRect) const
+{
+	// the source buffer only holds the area of the source buffer rect
+	const uint32 nBufferSize = sourceBufferRect.width() * sourceBufferRect.height() * 4;
+	psEvent->pBuffer = new uint8[nBufferSize];
+	MemoryManager::Copy(psEvent->pBuffer, sourceBuffer, nBufferSize);
+	psEvent->sourceBufferRect = sourceBufferRect;
+	psEvent->scrollRect = scrollRect;
+	psEvent->nParam[0] = dx;
+	psEvent->nParam[1] = dy;
+	psEvent->nNumCopyRects = numCopyRects;
+	if (numCopyRects > 0)
+	{
+		psEvent->pCopyRects = new Berkelium::Rect[numCopyRects];
+		for (size_t i = 0; i < numCopyRects; i++)
+		{
+			psEvent->pCopyRects[i] = copyRects[i];
+		}
+	}
+}
+
+
+void SRPWindow::DestroyBrowserEvent(sBrowserEvent *psEvent) const
+{
+	if (nullptr != psEvent->pBuffer)
+	{
+		delete [] psEvent->pBuffer;
+	}
+	if (nullptr != psEvent->pCopyRects)
+	{
+		delete [] psEvent->pCopyRects;
+	}
+	if (nullptr != psEvent->pArgs)
+	{
+		delete [] psEvent->pArgs;
+	}
+	delete psEvent;
+}
+
+
+void SRPWindow::ProcessPaintEvents()
+{
+	// the event methods are called again, this time from our thread, so they do the actual work
+	sBrowserEvent *psEvent = nullptr;
+	while (m_pPaintQueue->Pop(psEvent))
+	{
+		switch (psEvent->nType)
+		{
+			case sBrowserEvent::EventPaint:
+				if (!m_bFrozen)
+				{
+					// a frozen window has released its image, the paint is from before freezing
+					MarkPaint(psEvent->nTime, psEvent->nExecutedCommands);
+					onPaint(psEvent->pWindow, psEvent->pBuffer, psEvent->sourceBufferRect, psEvent->nNumCopyRects, psEvent->pCopyRects, psEvent->nParam[0], psEvent->nParam[1], psEvent->scrollRect);
+				}
+				break;
+
+			case sBrowserEvent::EventWidgetCreated:
+				onWidgetCreated(psEvent->pWindow, psEvent->pWidget, psEvent->nParam[0]);
+				break;
+
+			case sBrowserEvent::EventWidgetDestroyed:
+				onWidgetDestroyed(psEvent->pWindow, psEvent->pWidget);
+				break;
+
+			case sBrowserEvent::EventWidgetMove:
+				onWidgetMove(psEvent->pWindow, psEvent->pWidget, psEvent->nParam[0], psEvent->nParam[1]);
+				break;
+
+			case sBrowserEvent::EventWidgetResize:
+				onWidgetResize(psEvent->pWindow, psEvent->pWidget, psEvent->nParam[0], psEvent->nParam[1]);
+				break;
+
+			case sBrowserEvent::EventWidgetPaint:
+				onWidgetPaint(psEvent->pWindow, psEvent->pWidget, psEvent->pBuffer, psEvent->sourceBufferRect, psEvent->nNumCopyRects, psEvent->pCopyRects, psEvent->nParam[0], psEvent->nParam[1], psEvent->scrollRect);
+				break;
+		}
+		DestroyBrowserEvent(psEvent);
+	}
+}
+
+
+void SRPWindow::ProcessBrowserEvents()
+{
+	if (!m_pBerkeliumThread)
+	{
+		// berkelium calls us directly
+		return;
+	}
+
+	// the event methods are called again, this time from our thread, so they do the actual work
+	sBrowserEvent *psEvent = nullptr;
+	while (m_pEventQueue->Pop(psEvent))
+	{
+		switch (psEvent->nType)
+		{
+			case sBrowserEvent::EventJavascriptCallback:
+				onJavascriptCallback(psEvent->pWindow, psEvent->pReplyMsg, Berkelium::URLString::point_to(psEvent->sUrl.GetASCII(), psEvent->sUrl.GetLength()), Berkelium::WideString::point_to(psEvent->sText.GetUnicode(), psEvent->sText.GetLength()), psEvent->pArgs, psEvent->nNumArgs);
+				break;
+
+			case sBrowserEvent::EventLoad:
+				onLoad(psEvent->pWindow);
+				break;
+
+			case sBrowserEvent::EventLoadingStateChanged:
+				onLoadingStateChanged(psEvent->pWindow, psEvent->nParam[0] != 0);
+				break;
+
+			case sBrowserEvent::EventAddressBarChanged:
+				onAddressBarChanged(psEvent->pWindow, Berkelium::URLString::point_to(psEvent->sUrl.GetASCII(), psEvent->sUrl.GetLength()));
+				break;
+
+			case sBrowserEvent::EventCrashed:
+				onCrashed(psEvent->pWindow);
+				break;
+
+			case sBrowserEvent::EventUnresponsive:
+				onUnresponsive(psEvent->pWindow);
+				break;
+
+			case sBrowserEvent::EventResponsive:
+				onResponsive(psEvent->pWindow);
+				break;
+
+			case sBrowserEvent::EventTooltipChanged:
+				onTooltipChanged(psEvent->pWindow, Berkelium::WideString::point_to(psEvent->sText.GetUnicode(), psEvent->sText.GetLength()));
+				break;
+
+			case sBrowserEvent::EventCreated:
+				if (int(psEvent->nExecutedCommands - m_nCreateCommandMark) >= 0)
+				{
+					// the window of the last create command, a window created before the last destroy is gone already
+					m_pPublishedBerkeliumWindow = psEvent->pWindow;
+					m_nCreateTime = uint64(psEvent->nParam[0]);
+				}
+				break;
+
+			case sBrowserEvent::EventConsole:
+				DebugToConsole(psEvent->sText);
+				break;
+		}
+		DestroyBrowserEvent(psEvent);
+	}
+
+	if (m_pToolTip)
+	{
+		// the tool tip window is not known by Gui
+		m_pToolTip->ProcessBrowserEvents();
+	}
+}
+
+
+void SRPWindow::ClearBrowserEvents()
+{
+	sBrowserEvent *psEvent = nullptr;
+	while (m_pPaintQueue->Pop(psEvent))
+	{
+		DestroyBrowserEvent(psEvent);
+	}
+	while (m_pEventQueue->Pop(psEvent))
+	{
+		DestroyBrowserEvent(psEvent);
+	}
+}
+
+
 //[-------------------------------------------------------]
 //[ Namespace                                             ]
 //[-------------------------------------------------------]
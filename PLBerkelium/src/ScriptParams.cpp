@@ -0,0 +1,284 @@
+//[-------------------------------------------------------]
+//[ Header                                                ]
+//[-------------------------------------------------------]
+#include "PLBerkelium/ScriptParams.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Internal helpers                                      ]
+//[-------------------------------------------------------]
+namespace {
+
+	/**
+	*  @brief
+	*    Converts a javascript argument into the storage type of a parameter
+	*/
+	template <typename T>
+	struct VariantTo
+	{
+	};
+
+	template <>
+	struct VariantTo<bool>
+	{
+		static bool Get(const Berkelium::Script::Variant &cVariant) { return cVariant.toBoolean(); }
+	};
+
+	template <>
+	struct VariantTo<int>
+	{
+		static int Get(const Berkelium::Script::Variant &cVariant) { return cVariant.toInteger(); }
+	};
+
+	template <>
+	struct VariantTo<float>
+	{
+		static float Get(const Berkelium::Script::Variant &cVariant) { return float(cVariant.toDouble()); }
+	};
+
+	template <>
+	struct VariantTo<double>
+	{
+		static double Get(const Berkelium::Script::Variant &cVariant) { return cVariant.toDouble(); }
+	};
+
+	template <>
+	struct VariantTo<String>
+	{
+		static String Get(const Berkelium::Script::Variant &cVariant) { return ScriptParams::ToString(cVariant); }
+	};
+
+	/**
+	*  @brief
+	*    Returns an argument, null when javascript passed less arguments than the function has
+	*/
+	const Berkelium::Script::Variant &GetArgument(const Berkelium::Script::Variant *pArgs, size_t nNumArgs, uint32 nIndex)
+	{
+		static const Berkelium::Script::Variant cNull;
+		return (nIndex < nNumArgs) ? pArgs[nIndex] : cNull;
+	}
+
+	/**
+	*  @brief
+	*    Calls a function with typed parameters and converts the return
+	*/
+	template <typename R>
+	struct Invoke
+	{
+		template <typename P>
+		static void Call(DynFunc &cDynFunc, P &cParams, String *psResult)
+		{
+			cDynFunc.Call(cParams);
+			if (psResult)
+				*psResult = Type<R>::ConvertToString(cParams.Return);
+		}
+	};
+
+	template <>
+	struct Invoke<void>
+	{
+		template <typename P>
+		static void Call(DynFunc &cDynFunc, P &cParams, String *psResult)
+		{
+			cDynFunc.Call(cParams);
+		}
+	};
+
+	// the function is called with the parameter types resolved so far, each step resolves one more
+	template <typename R, typename T0, typename T1>
+	bool Call2(DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, String *psResult)
+	{
+		Params<R, T0, T1> cParams(VariantTo<T0>::Get(GetArgument(pArgs, nNumArgs, 0)), VariantTo<T1>::Get(GetArgument(pArgs, nNumArgs, 1)));
+		Invoke<R>::Call(cDynFunc, cParams, psResult);
+		return true;
+	}
+
+	template <typename R, typename T0>
+	bool Call1(DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, String *psResult)
+	{
+		if (cDynFunc.GetNumOfParameters() == 1)
+		{
+			Params<R, T0> cParams(VariantTo<T0>::Get(GetArgument(pArgs, nNumArgs, 0)));
+			Invoke<R>::Call(cDynFunc, cParams, psResult);
+			return true;
+		}
+
+		switch (cDynFunc.GetParameterTypeID(1))
+		{
+			case Type<bool>::TypeID:	return Call2<R, T0, bool>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<int>::TypeID:		return Call2<R, T0, int>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<float>::TypeID:	return Call2<R, T0, float>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<double>::TypeID:	return Call2<R, T0, double>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<String>::TypeID:	return Call2<R, T0, String>(cDynFunc, pArgs, nNumArgs, psResult);
+		}
+		return false;
+	}
+
+	template <typename R>
+	bool Call0(DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, String *psResult)
+	{
+		if (cDynFunc.GetNumOfParameters() == 0)
+		{
+			Params<R> cParams;
+			Invoke<R>::Call(cDynFunc, cParams, psResult);
+			return true;
+		}
+
+		switch (cDynFunc.GetParameterTypeID(0))
+		{
+			case Type<bool>::TypeID:	return Call1<R, bool>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<int>::TypeID:		return Call1<R, int>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<float>::TypeID:	return Call1<R, float>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<double>::TypeID:	return Call1<R, double>(cDynFunc, pArgs, nNumArgs, psResult);
+			case Type<String>::TypeID:	return Call1<R, String>(cDynFunc, pArgs, nNumArgs, psResult);
+		}
+		return false;
+	}
+
+	/**
+	*  @brief
+	*    Returns whether or not a type id is one of the supported parameter types
+	*/
+	bool IsSupportedType(int nTypeID)
+	{
+		return (nTypeID == Type<bool>::TypeID || nTypeID == Type<int>::TypeID || nTypeID == Type<float>::TypeID ||
+				nTypeID == Type<double>::TypeID || nTypeID == Type<String>::TypeID);
+	}
+
+	/**
+	*  @brief
+	*    Returns whether or not a return type id means there is no return
+	*/
+	bool IsVoidType(int nTypeID)
+	{
+		return (nTypeID == Type<void>::TypeID || nTypeID == TypeNull || nTypeID == TypeInvalid);
+	}
+
+}
+
+
+//[-------------------------------------------------------]
+//[ Functions		                                      ]
+//[-------------------------------------------------------]
+bool ScriptParams::IsSupported(DynFunc &cDynFunc)
+{
+	const uint32 nNumOfParameters = cDynFunc.GetNumOfParameters();
+	if (nNumOfParameters > 2)
+	{
+		return false;
+	}
+	for (uint32 i = 0; i < nNumOfParameters; i++)
+	{
+		if (!IsSupportedType(cDynFunc.GetParameterTypeID(i)))
+		{
+			return false;
+		}
+	}
+	return (IsVoidType(cDynFunc.GetReturnTypeID()) || IsSupportedType(cDynFunc.GetReturnTypeID()));
+}
+
+
+String ScriptParams::ToString(const Berkelium::Script::Variant &cVariant)
+{
+	switch (cVariant.type())
+	{
+		case Berkelium::Script::Variant::JSSTRING:
+			return String(cVariant.toString().data(), true, int(cVariant.toString().length()));
+
+		case Berkelium::Script::Variant::JSBOOLEAN:
+			return cVariant.toBoolean() ? "true" : "false";
+
+		case Berkelium::Script::Variant::JSDOUBLE:
+			return String(cVariant.toDouble());
+
+		default:
+			// null, functions and the like have no sensible string
+			return "";
+	}
+}
+
+
+bool ScriptParams::Call(DynFunc &cDynFunc, const Berkelium::Script::Variant *pArgs, size_t nNumArgs, String *psResult)
+{
+	if (cDynFunc.GetNumOfParameters() > 2)
+	{
+		// not supported
+		return false;
+	}
+
+	// resolve the return type, the parameters are resolved from there on
+	const int nReturnTypeID = cDynFunc.GetReturnTypeID();
+	if (nReturnTypeID == Type<bool>::TypeID)
+		return Call0<bool>(cDynFunc, pArgs, nNumArgs, psResult);
+	else if (nReturnTypeID == Type<int>::TypeID)
+		return Call0<int>(cDynFunc, pArgs, nNumArgs, psResult);
+	else if (nReturnTypeID == Type<float>::TypeID)
+		return Call0<float>(cDynFunc, pArgs, nNumArgs, psResult);
+	else if (nReturnTypeID == Type<double>::TypeID)
+		return Call0<double>(cDynFunc, pArgs, nNumArgs, psResult);
+	else if (nReturnTypeID == Type<String>::TypeID)
+		return Call0<String>(cDynFunc, pArgs, nNumArgs, psResult);
+	else if (IsVoidType(nReturnTypeID))
+		return Call0<void>(cDynFunc, pArgs, nNumArgs, psResult);
+	return false;
+}
+
+
+String ScriptParams::ToParameterString(const Berkelium::Script::Variant *pArgs, size_t nNumArgs)
+{
+	String sParams = "";
+
+	// loop trough the arguments
+	for (size_t i = 0; i < nNumArgs; i++)
+	{
+		if (pArgs[i].type() == Berkelium::Script::Variant::JSSTRING)
+		{
+			// string, quoted so that whitespaces survive and escaped so that quotes do not end it
+			String sString = String(pArgs[i].toString().data(), true, int(pArgs[i].toString().length()));
+			sString.Replace("\\", "\\\\");
+			sString.Replace("\"", "\\\"");
+			sParams = sParams + "Param" + String(i) + "=\"" + sString + "\" ";
+		}
+		else
+		{
+			// boolean, double, else or undefined
+			Berkelium::WideString jsonStr = Berkelium::Script::toJSON(pArgs[i]);
+			sParams = sParams + "Param" + String(i) + "=" + String(jsonStr.data(), true, int(jsonStr.length())) + " ";
+			Berkelium::Script::toJSON_free(jsonStr);
+		}
+	}
+
+	return sParams;
+}
+
+
+void ScriptParams::CallWithParameterString(DynFunc &cDynFunc, const String &sParams, String *psResult)
+{
+	// check if there is a return type
+	if (IsVoidType(cDynFunc.GetReturnTypeID()))
+	{
+		// call the function without a return
+		cDynFunc.Call(sParams);
+	}
+	else
+	{
+		// call the function with a return
+		const String sResult = cDynFunc.CallWithReturn(sParams);
+		if (psResult)
+			*psResult = sResult;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // PLBerkelium
@@ -0,0 +1,701 @@
+//[-------------------------------------------------------]
+//[ Header                                                ]
+//[-------------------------------------------------------]
+#include "PLBerkelium/TextureAtlas.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLGraphics;
+using namespace PLMath;
+using namespace PLRenderer;
+
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Functions		                                      ]
+//[-------------------------------------------------------]
+TextureAtlas::TextureAtlas(Renderer &cRenderer) :
+	m_pRenderer(&cRenderer),
+	m_lstPages(),
+	m_bBatching(false),
+	m_nFrame(1),
+	m_nUploadCount(0),
+	m_nBatchCount(0),
+	m_nMoveCount(0)
+{
+}
+
+
+TextureAtlas::~TextureAtlas()
+{
+	// cleanup, the rects that have not been given back go with their pages
+	for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+	{
+		DestroyPage(m_lstPages[i]);
+	}
+}
+
+
+bool TextureAtlas::Fits(const int &nWidth, const int &nHeight)
+{
+	return nWidth > 0 && nHeight > 0 && nWidth <= TEXTUREATLASMAXSIZE && nHeight <= TEXTUREATLASMAXSIZE;
+}
+
+
+sAtlasRect *TextureAtlas::Allocate(const int &nWidth, const int &nHeight)
+{
+	// a new rect has not been painted yet, it starts on a static page
+	return AllocateRect(nWidth, nHeight, false);
+}
+
+
+sAtlasRect *TextureAtlas::Reallocate(sAtlasRect *psRect, const int &nWidth, const int &nHeight)
+{
+	if (psRect && nWidth <= psRect->nWidth && nHeight <= psRect->nHeight && nWidth * nHeight * 2 >= psRect->nWidth * psRect->nHeight)
+	{
+		// the size fits and does not waste too much
+		return psRect;
+	}
+
+	// allocate before freeing, so that what has been painted can be kept until the next paint comes in
+	sAtlasRect *psNewRect = AllocateRect(nWidth, nHeight, psRect && psRect->bHot);
+	if (psRect && psNewRect)
+	{
+		const uint8 *pPageBuffer = psRect->psPage->cImage.GetBuffer()->GetData();
+		CopyPixels(*psNewRect, &pPageBuffer[(psRect->nY * TEXTUREATLASPAGESIZE + psRect->nX) * 4], TEXTUREATLASPAGESIZE, 0, 0, psRect->nWidth, psRect->nHeight);
+		psNewRect->nPaintedFrame = psRect->nPaintedFrame;
+		psNewRect->nPaintScore = psRect->nPaintScore;
+	}
+	Free(psRect);
+	return psNewRect;
+}
+
+
+void TextureAtlas::Free(sAtlasRect *psRect)
+{
+	if (!psRect)
+	{
+		return;
+	}
+
+	sAtlasPage *psPage = psRect->psPage;
+	Release(*psRect);
+	psPage->lstRects.Remove(psRect);
+	delete psRect;
+	DestroyEmptyPage(psPage);
+}
+
+
+void TextureAtlas::CopyToRect(sAtlasRect &sRect, const uint8 *pImageBuffer, const int &nPitch, const int &nWidth, const int &nHeight)
+{
+	CopyRegionToRect(sRect, pImageBuffer, nPitch, 0, 0, nWidth, nHeight);
+}
+
+
+void TextureAtlas::CopyRegionToRect(sAtlasRect &sRect, const uint8 *pImageBuffer, const int &nPitch, const int &nX, const int &nY, const int &nWidth, const int &nHeight)
+{
+	CopyPixels(sRect, pImageBuffer, nPitch, nX, nY, nWidth, nHeight);
+	sRect.nPaintedFrame = m_nFrame;
+}
+
+
+TextureBuffer *TextureAtlas::GetTextureBuffer(const sAtlasRect &sRect)
+{
+	sAtlasPage *psPage = sRect.psPage;
+	if (psPage->bDirty && psPage->pTextureBuffer)
+	{
+		// one upload for all the paints of the page since it has been drawn last
+		psPage->pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, psPage->cImage.GetBuffer()->GetData());
+		psPage->bDirty = false;
+		m_nUploadCount++;
+	}
+	return psPage->pTextureBuffer;
+}
+
+
+void TextureAtlas::SetQuad(sAtlasRect &sRect, const Vector2i &vPosition, const Vector2i &vSize, const Vector2i &vUsedSize, const bool &bBatched)
+{
+	const bool bIsBatched = bBatched && m_bBatching;
+	if (sRect.bBatched != bIsBatched || (bIsBatched && (sRect.vQuadPosition != vPosition || sRect.vQuadSize != vSize || sRect.vUsedSize != vUsedSize)))
+	{
+		// the batch has to be filled again
+		sRect.psPage->bBatchDirty = true;
+	}
+	sRect.vQuadPosition = vPosition;
+	sRect.vQuadSize = vSize;
+	sRect.vUsedSize = vUsedSize;
+	sRect.bBatched = bIsBatched;
+}
+
+
+VertexBuffer *TextureAtlas::GetBatch(const sAtlasRect &sRect, uint32 &nVertices)
+{
+	sAtlasPage *psPage = sRect.psPage;
+	nVertices = 0;
+	if (psPage->nDrawnFrame == m_nFrame)
+	{
+		// another window of the page has drawn the batch already
+		return nullptr;
+	}
+	psPage->nDrawnFrame = m_nFrame;
+
+	if (psPage->bBatchDirty)
+	{
+		UpdateBatch(*psPage);
+	}
+	if (!psPage->pVertexBuffer || !psPage->nBatchCount)
+	{
+		return nullptr;
+	}
+
+	m_nBatchCount++;
+	nVertices = psPage->nBatchCount * 6;
+	return psPage->pVertexBuffer;
+}
+
+
+void TextureAtlas::NextFrame()
+{
+	// a rect painted in every other frame still rises, one painted now and then falls back
+	Array<sAtlasRect*> lstMovingRects;
+	for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+	{
+		sAtlasPage *psPage = m_lstPages[i];
+		for (uint32 j = 0; j < psPage->lstRects.GetNumOfElements(); j++)
+		{
+			sAtlasRect *psRect = psPage->lstRects[j];
+			if (psRect->nPaintedFrame == m_nFrame)
+			{
+				psRect->nPaintScore = (psRect->nPaintScore + 2 < TEXTUREATLASHOTSCORE * 2) ? psRect->nPaintScore + 2 : TEXTUREATLASHOTSCORE * 2;
+			}
+			else if (psRect->nPaintScore > 0)
+			{
+				psRect->nPaintScore--;
+			}
+			if ((!psRect->bHot && psRect->nPaintScore >= TEXTUREATLASHOTSCORE) || (psRect->bHot && !psRect->nPaintScore))
+			{
+				lstMovingRects.Add(psRect);
+			}
+		}
+	}
+	for (uint32 i = 0; i < lstMovingRects.GetNumOfElements(); i++)
+	{
+		Move(*lstMovingRects[i], !lstMovingRects[i]->bHot);
+	}
+
+	m_nFrame++;
+}
+
+
+void TextureAtlas::SetBatching(const bool &bBatching)
+{
+	if (m_bBatching != bBatching)
+	{
+		m_bBatching = bBatching;
+		for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+		{
+			// the quads are set again on the next update
+			sAtlasPage *psPage = m_lstPages[i];
+			for (uint32 j = 0; j < psPage->lstRects.GetNumOfElements(); j++)
+			{
+				psPage->lstRects[j]->bBatched = false;
+			}
+			psPage->bBatchDirty = true;
+		}
+	}
+}
+
+
+bool TextureAtlas::IsBatching() const
+{
+	return m_bBatching;
+}
+
+
+uint32 TextureAtlas::GetNumOfPages() const
+{
+	return m_lstPages.GetNumOfElements();
+}
+
+
+float TextureAtlas::GetUtilisation() const
+{
+	if (!m_lstPages.GetNumOfElements())
+	{
+		return 0.0f;
+	}
+
+	uint64 nUsedArea = 0;
+	for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+	{
+		nUsedArea += m_lstPages[i]->nUsedArea;
+	}
+	return float(double(nUsedArea) / (double(m_lstPages.GetNumOfElements()) * TEXTUREATLASPAGESIZE * TEXTUREATLASPAGESIZE));
+}
+
+
+float TextureAtlas::GetFragmentation() const
+{
+	uint64 nUsedArea = 0;
+	uint64 nTakenArea = 0;
+	for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+	{
+		const sAtlasPage *psPage = m_lstPages[i];
+		nUsedArea += psPage->nUsedArea;
+		for (uint32 j = 0; j < psPage->lstShelves.GetNumOfElements(); j++)
+		{
+			nTakenArea += uint64(psPage->lstShelves[j]->nX) * uint64(psPage->lstShelves[j]->nHeight);
+		}
+	}
+	if (!nTakenArea)
+	{
+		return 0.0f;
+	}
+	return 1.0f - float(double(nUsedArea) / double(nTakenArea));
+}
+
+
+uint32 TextureAtlas::GetUploadCount() const
+{
+	return m_nUploadCount;
+}
+
+
+uint32 TextureAtlas::GetBatchCount() const
+{
+	return m_nBatchCount;
+}
+
+
+uint32 TextureAtlas::GetMoveCount() const
+{
+	return m_nMoveCount;
+}
+
+
+sAtlasRect *TextureAtlas::AllocateRect(const int &nWidth, const int &nHeight, const bool &bHot)
+{
+	if (!Fits(nWidth, nHeight))
+	{
+		// the surface is too big for the atlas
+		return nullptr;
+	}
+
+	// round the size up, so that a surface that grows a little keeps its rect
+	const int nRectWidth = (nWidth + TEXTUREATLASGRANULARITY - 1) / TEXTUREATLASGRANULARITY * TEXTUREATLASGRANULARITY;
+	const int nRectHeight = (nHeight + TEXTUREATLASGRANULARITY - 1) / TEXTUREATLASGRANULARITY * TEXTUREATLASGRANULARITY;
+
+	sAtlasRect *psRect = new sAtlasRect;
+	psRect->vQuadPosition = Vector2i::Zero;
+	psRect->vQuadSize = Vector2i::Zero;
+	psRect->vUsedSize = Vector2i::Zero;
+	psRect->bBatched = false;
+	psRect->nPaintedFrame = 0;
+	psRect->nPaintScore = 0;
+	if (!Place(*psRect, nRectWidth, nRectHeight, bHot))
+	{
+		delete psRect;
+		return nullptr;
+	}
+	psRect->psPage->lstRects.Add(psRect);
+	return psRect;
+}
+
+
+bool TextureAtlas::Place(sAtlasRect &sRect, const int &nRectWidth, const int &nRectHeight, const bool &bHot)
+{
+	// find the lowest shelf the rect fits in, in a hole or at the end
+	sAtlasPage *psPage = nullptr;
+	uint32 nShelf = 0;
+	int nHole = -1;
+	for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+	{
+		sAtlasPage *psCurrentPage = m_lstPages[i];
+		if (psCurrentPage->bHot != bHot)
+		{
+			continue;
+		}
+		for (uint32 j = 0; j < psCurrentPage->lstShelves.GetNumOfElements(); j++)
+		{
+			const sAtlasShelf *psShelf = psCurrentPage->lstShelves[j];
+			if (psShelf->nHeight >= nRectHeight && (!psPage || psShelf->nHeight < psPage->lstShelves[nShelf]->nHeight))
+			{
+				const int nShelfHole = FindHole(*psShelf, nRectWidth);
+				if (nShelfHole >= 0 || TEXTUREATLASPAGESIZE - psShelf->nX >= nRectWidth)
+				{
+					psPage = psCurrentPage;
+					nShelf = j;
+					nHole = nShelfHole;
+				}
+			}
+		}
+	}
+
+	if (!psPage || psPage->lstShelves[nShelf]->nHeight - nRectHeight > nRectHeight / 2)
+	{
+		// the shelf would waste too much, open a new one on the first page that has room for it
+		psPage = nullptr;
+		nHole = -1;
+		for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+		{
+			if (m_lstPages[i]->bHot == bHot && TEXTUREATLASPAGESIZE - m_lstPages[i]->nShelvesHeight >= nRectHeight)
+			{
+				psPage = m_lstPages[i];
+				nShelf = psPage->lstShelves.GetNumOfElements();
+				break;
+			}
+		}
+		if (!psPage)
+		{
+			// all pages are full
+			psPage = CreatePage(bHot);
+			if (!psPage)
+			{
+				return false;
+			}
+			nShelf = 0;
+		}
+		if (nShelf == psPage->lstShelves.GetNumOfElements())
+		{
+			sAtlasShelf *psShelf = new sAtlasShelf;
+			psShelf->nY = psPage->nShelvesHeight;
+			psShelf->nHeight = nRectHeight;
+			psShelf->nX = 0;
+			psShelf->nRectCount = 0;
+			psPage->lstShelves.Add(psShelf);
+			psPage->nShelvesHeight += nRectHeight;
+		}
+	}
+
+	sAtlasShelf *psShelf = psPage->lstShelves[nShelf];
+	if (nHole >= 0)
+	{
+		// take the front of the hole, the rest stays a hole
+		sAtlasHole &sHole = psShelf->lstHoles[nHole];
+		sRect.nX = sHole.nX;
+		sHole.nX += nRectWidth;
+		sHole.nWidth -= nRectWidth;
+		if (!sHole.nWidth)
+		{
+			psShelf->lstHoles.RemoveAtIndex(nHole);
+		}
+	}
+	else
+	{
+		// place the rect at the end of the shelf
+		sRect.nX = psShelf->nX;
+		psShelf->nX += nRectWidth;
+	}
+	sRect.psPage = psPage;
+	sRect.nShelf = nShelf;
+	sRect.nY = psShelf->nY;
+	sRect.nWidth = nRectWidth;
+	sRect.nHeight = nRectHeight;
+	sRect.bHot = bHot;
+	psShelf->nRectCount++;
+	psPage->nUsedArea += nRectWidth * nRectHeight;
+	psPage->bBatchDirty = true;
+	return true;
+}
+
+
+void TextureAtlas::Release(const sAtlasRect &sRect)
+{
+	sAtlasPage *psPage = sRect.psPage;
+	sAtlasShelf *psShelf = psPage->lstShelves[sRect.nShelf];
+	psShelf->nRectCount--;
+	if (!psShelf->nRectCount)
+	{
+		// the whole shelf is free again
+		psShelf->nX = 0;
+		psShelf->lstHoles.Clear();
+	}
+	else if (sRect.nX + sRect.nWidth == psShelf->nX)
+	{
+		// the last rect of a shelf gives its room back, together with a hole right before it
+		psShelf->nX = sRect.nX;
+		const uint32 nNumOfHoles = psShelf->lstHoles.GetNumOfElements();
+		if (nNumOfHoles > 0 && psShelf->lstHoles[nNumOfHoles - 1].nX + psShelf->lstHoles[nNumOfHoles - 1].nWidth == psShelf->nX)
+		{
+			psShelf->nX = psShelf->lstHoles[nNumOfHoles - 1].nX;
+			psShelf->lstHoles.RemoveAtIndex(nNumOfHoles - 1);
+		}
+	}
+	else
+	{
+		// keep the room for the next rect that fits in
+		AddHole(*psShelf, sRect.nX, sRect.nWidth);
+	}
+	while (psPage->lstShelves.GetNumOfElements() > 0 && !psPage->lstShelves[psPage->lstShelves.GetNumOfElements() - 1]->nRectCount)
+	{
+		// empty shelves at the bottom of the page give their height back
+		sAtlasShelf *psLastShelf = psPage->lstShelves[psPage->lstShelves.GetNumOfElements() - 1];
+		psPage->nShelvesHeight -= psLastShelf->nHeight;
+		psPage->lstShelves.RemoveAtIndex(psPage->lstShelves.GetNumOfElements() - 1);
+		delete psLastShelf;
+	}
+
+	psPage->nUsedArea -= sRect.nWidth * sRect.nHeight;
+	psPage->bBatchDirty = true;
+}
+
+
+void TextureAtlas::Move(sAtlasRect &sRect, const bool &bHot)
+{
+	const sAtlasRect sOldRect = sRect;
+	if (!Place(sRect, sRect.nWidth, sRect.nHeight, bHot))
+	{
+		// the rect stays where it is
+		return;
+	}
+
+	// the content goes along, the quad of the window takes the new position on its next draw
+	const uint8 *pPageBuffer = sOldRect.psPage->cImage.GetBuffer()->GetData();
+	CopyPixels(sRect, &pPageBuffer[(sOldRect.nY * TEXTUREATLASPAGESIZE + sOldRect.nX) * 4], TEXTUREATLASPAGESIZE, 0, 0, sOldRect.nWidth, sOldRect.nHeight);
+	Release(sOldRect);
+	sOldRect.psPage->lstRects.Remove(&sRect);
+	sRect.psPage->lstRects.Add(&sRect);
+	m_nMoveCount++;
+	DestroyEmptyPage(sOldRect.psPage);
+}
+
+
+int TextureAtlas::FindHole(const sAtlasShelf &sShelf, const int &nWidth) const
+{
+	int nHole = -1;
+	for (uint32 i = 0; i < sShelf.lstHoles.GetNumOfElements(); i++)
+	{
+		const int nHoleWidth = sShelf.lstHoles[i].nWidth;
+		if (nHoleWidth >= nWidth && (nHole < 0 || nHoleWidth < sShelf.lstHoles[nHole].nWidth))
+		{
+			nHole = int(i);
+		}
+	}
+	return nHole;
+}
+
+
+void TextureAtlas::AddHole(sAtlasShelf &sShelf, const int &nX, const int &nWidth)
+{
+	uint32 nIndex = 0;
+	while (nIndex < sShelf.lstHoles.GetNumOfElements() && sShelf.lstHoles[nIndex].nX < nX)
+	{
+		nIndex++;
+	}
+
+	if (nIndex > 0 && sShelf.lstHoles[nIndex - 1].nX + sShelf.lstHoles[nIndex - 1].nWidth == nX)
+	{
+		// grow the hole before, and merge it with the hole after when they touch now
+		sAtlasHole &sHole = sShelf.lstHoles[nIndex - 1];
+		sHole.nWidth += nWidth;
+		if (nIndex < sShelf.lstHoles.GetNumOfElements() && sHole.nX + sHole.nWidth == sShelf.lstHoles[nIndex].nX)
+		{
+			sHole.nWidth += sShelf.lstHoles[nIndex].nWidth;
+			sShelf.lstHoles.RemoveAtIndex(nIndex);
+		}
+	}
+	else if (nIndex < sShelf.lstHoles.GetNumOfElements() && nX + nWidth == sShelf.lstHoles[nIndex].nX)
+	{
+		// grow the hole after to the front
+		sShelf.lstHoles[nIndex].nX = nX;
+		sShelf.lstHoles[nIndex].nWidth += nWidth;
+	}
+	else
+	{
+		sAtlasHole sHole;
+		sHole.nX = nX;
+		sHole.nWidth = nWidth;
+		sShelf.lstHoles.AddAtIndex(sHole, int(nIndex));
+	}
+}
+
+
+void TextureAtlas::CopyPixels(const sAtlasRect &sRect, const uint8 *pImageBuffer, const int &nPitch, const int &nX, const int &nY, const int &nWidth, const int &nHeight)
+{
+	sAtlasPage *psPage = sRect.psPage;
+	if (!pImageBuffer || !psPage->cImage.GetBuffer() || nX < 0 || nY < 0)
+	{
+		return;
+	}
+
+	const int nCopyWidth = (nX + nWidth < sRect.nWidth) ? nWidth : sRect.nWidth - nX;
+	const int nCopyHeight = (nY + nHeight < sRect.nHeight) ? nHeight : sRect.nHeight - nY;
+	if (nCopyWidth <= 0 || nCopyHeight <= 0)
+	{
+		// nothing of the part is inside the rect
+		return;
+	}
+
+	uint8 *pPageBuffer = psPage->cImage.GetBuffer()->GetData();
+	for (int nRow = 0; nRow < nCopyHeight; nRow++)
+	{
+		MemoryManager::Copy(&pPageBuffer[((sRect.nY + nY + nRow) * TEXTUREATLASPAGESIZE + sRect.nX + nX) * 4], &pImageBuffer[((nY + nRow) * nPitch + nX) * 4], nCopyWidth * 4);
+	}
+	psPage->bDirty = true;
+}
+
+
+sAtlasPage *TextureAtlas::CreatePage(const bool &bHot)
+{
+	sAtlasPage *psPage = new sAtlasPage;
+	psPage->cImage = Image::CreateImage(DataByte, ColorRGBA, Vector3i(TEXTUREATLASPAGESIZE, TEXTUREATLASPAGESIZE, 1));
+	if (!psPage->cImage.GetBuffer() || !psPage->cImage.GetBuffer()->GetData())
+	{
+		// image buffer could not be created
+		delete psPage;
+		return nullptr;
+	}
+	// the room between the rects stays transparent
+	MemoryManager::Set(psPage->cImage.GetBuffer()->GetData(), 0, TEXTUREATLASPAGESIZE * TEXTUREATLASPAGESIZE * 4);
+	psPage->pTextureBuffer = reinterpret_cast<TextureBuffer*>(m_pRenderer->CreateTextureBuffer2D(psPage->cImage, TextureBuffer::Unknown, 0));
+	if (!psPage->pTextureBuffer)
+	{
+		// texture buffer could not be created
+		delete psPage;
+		return nullptr;
+	}
+	psPage->nShelvesHeight = 0;
+	psPage->nUsedArea = 0;
+	psPage->bDirty = false;
+	psPage->bHot = bHot;
+	psPage->pVertexBuffer = nullptr;
+	psPage->nBatchSize = 0;
+	psPage->nBatchCount = 0;
+	psPage->bBatchDirty = true;
+	psPage->nDrawnFrame = 0;
+	m_lstPages.Add(psPage);
+	return psPage;
+}
+
+
+void TextureAtlas::DestroyEmptyPage(sAtlasPage *psPage)
+{
+	if (psPage->lstRects.GetNumOfElements())
+	{
+		return;
+	}
+
+	// one empty page of each kind is kept, a surface that comes and goes would else create and upload a page every time
+	for (uint32 i = 0; i < m_lstPages.GetNumOfElements(); i++)
+	{
+		if (m_lstPages[i] != psPage && m_lstPages[i]->bHot == psPage->bHot && !m_lstPages[i]->lstRects.GetNumOfElements())
+		{
+			// there is an empty page already, nobody uses this one anymore
+			m_lstPages.Remove(psPage);
+			DestroyPage(psPage);
+			break;
+		}
+	}
+}
+
+
+void TextureAtlas::DestroyPage(sAtlasPage *psPage)
+{
+	for (uint32 i = 0; i < psPage->lstShelves.GetNumOfElements(); i++)
+	{
+		delete psPage->lstShelves[i];
+	}
+	for (uint32 i = 0; i < psPage->lstRects.GetNumOfElements(); i++)
+	{
+		delete psPage->lstRects[i];
+	}
+	if (nullptr != psPage->pVertexBuffer)
+	{
+		delete psPage->pVertexBuffer;
+	}
+	if (nullptr != psPage->pTextureBuffer)
+	{
+		delete psPage->pTextureBuffer;
+	}
+	delete psPage;
+}
+
+
+void TextureAtlas::UpdateBatch(sAtlasPage &sPage)
+{
+	sPage.bBatchDirty = false;
+	sPage.nBatchCount = 0;
+	for (uint32 i = 0; i < sPage.lstRects.GetNumOfElements(); i++)
+	{
+		if (sPage.lstRects[i]->bBatched)
+		{
+			sPage.nBatchCount++;
+		}
+	}
+	if (!sPage.nBatchCount)
+	{
+		// nothing to draw
+		return;
+	}
+
+	if (!sPage.pVertexBuffer || sPage.nBatchSize < sPage.nBatchCount)
+	{
+		// make room for the quads, with some to spare for windows that are added later
+		if (nullptr != sPage.pVertexBuffer)
+		{
+			delete sPage.pVertexBuffer;
+		}
+		sPage.nBatchSize = sPage.nBatchCount * 2;
+		sPage.pVertexBuffer = m_pRenderer->CreateVertexBuffer();
+		if (!sPage.pVertexBuffer)
+		{
+			sPage.nBatchSize = 0;
+			sPage.nBatchCount = 0;
+			return;
+		}
+		sPage.pVertexBuffer->AddVertexAttribute(VertexBuffer::Position, 0, VertexBuffer::Float2);
+		sPage.pVertexBuffer->AddVertexAttribute(VertexBuffer::TexCoord, 0, VertexBuffer::Float2);
+		sPage.pVertexBuffer->Allocate(sPage.nBatchSize * 6, Usage::WriteOnly);
+	}
+
+	if (sPage.pVertexBuffer->Lock(Lock::WriteOnly))
+	{
+		uint32 nVertex = 0;
+		for (uint32 i = 0; i < sPage.lstRects.GetNumOfElements(); i++)
+		{
+			const sAtlasRect *psRect = sPage.lstRects[i];
+			if (psRect->bBatched)
+			{
+				const float fX1 = float(psRect->vQuadPosition.x);
+				const float fY1 = float(psRect->vQuadPosition.y);
+				const float fX2 = float(psRect->vQuadPosition.x + psRect->vQuadSize.x);
+				const float fY2 = float(psRect->vQuadPosition.y + psRect->vQuadSize.y);
+				const float fU1 = float(psRect->nX) / float(TEXTUREATLASPAGESIZE);
+				const float fV1 = float(psRect->nY) / float(TEXTUREATLASPAGESIZE);
+				const float fU2 = float(psRect->nX + psRect->vUsedSize.x) / float(TEXTUREATLASPAGESIZE);
+				const float fV2 = float(psRect->nY + psRect->vUsedSize.y) / float(TEXTUREATLASPAGESIZE);
+
+				// the two triangles of the triangle strip of SRPWindow::UpdateVertexBuffer(), with the same winding
+				const float fVertices[6][4] = {
+					{fX1, fY2, fU1, fV2}, {fX2, fY2, fU2, fV2}, {fX1, fY1, fU1, fV1},
+					{fX1, fY1, fU1, fV1}, {fX2, fY2, fU2, fV2}, {fX2, fY1, fU2, fV1}
+				};
+				for (uint32 j = 0; j < 6; j++, nVertex++)
+				{
+					float *pfVertex = static_cast<float*>(sPage.pVertexBuffer->GetData(nVertex, VertexBuffer::Position));
+					pfVertex[0] = fVertices[j][0];
+					pfVertex[1] = fVertices[j][1];
+					pfVertex	= static_cast<float*>(sPage.pVertexBuffer->GetData(nVertex, VertexBuffer::TexCoord));
+					pfVertex[0] = fVertices[j][2];
+					pfVertex[1] = fVertices[j][3];
+				}
+			}
+		}
+		sPage.pVertexBuffer->Unlock();
+	}
+	else
+	{
+		// the batch stays empty until the next change
+		sPage.nBatchCount = 0;
+	}
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // PLBerkelium
@@ -0,0 +1,265 @@
+//[-------------------------------------------------------]
+//[ Header                                                ]
+//[-------------------------------------------------------]
+#include "PLBerkelium/TexturePool.h"
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+using namespace PLCore;
+using namespace PLGraphics;
+using namespace PLRenderer;
+
+namespace PLBerkelium {
+
+
+//[-------------------------------------------------------]
+//[ Functions		                                      ]
+//[-------------------------------------------------------]
+TexturePool::TexturePool(Renderer &cRenderer) :
+	m_pRenderer(&cRenderer),
+	m_pmapTextures(new HashMap<uint32, Array<sPooledTexture*>*>),
+	m_lstVertexBuffers(),
+	m_nMemoryLimit(64 * 1024 * 1024),
+	m_nPooledMemory(0),
+	m_nTrimTime(10000),
+	m_nCreatedTextureCount(0),
+	m_nReusedTextureCount(0)
+{
+}
+
+
+TexturePool::~TexturePool()
+{
+	// cleanup
+	Clear();
+	Iterator<Array<sPooledTexture*>*> cIterator = m_pmapTextures->GetIterator();
+	while (cIterator.HasNext())
+	{
+		delete cIterator.Next();
+	}
+	delete m_pmapTextures;
+}
+
+
+int TexturePool::GetSizeClass(const int &nSize)
+{
+	if (nSize <= 0)
+	{
+		return TEXTUREPOOLGRANULARITY;
+	}
+	return (nSize + TEXTUREPOOLGRANULARITY - 1) / TEXTUREPOOLGRANULARITY * TEXTUREPOOLGRANULARITY;
+}
+
+
+TextureBuffer *TexturePool::GetTextureBuffer(const Image &cImage)
+{
+	if (!cImage.GetBuffer() || !cImage.GetBuffer()->GetData())
+	{
+		// there is nothing to create a texture from
+		return nullptr;
+	}
+
+	const int nWidth = cImage.GetBuffer()->GetSize().x;
+	const int nHeight = cImage.GetBuffer()->GetSize().y;
+	Array<sPooledTexture*> *plstBucket = m_pmapTextures->Get(GetKey(nWidth, nHeight));
+	if (plstBucket && plstBucket->GetNumOfElements() > 0)
+	{
+		// take the texture that has been given back last, it is the most likely to still be resident
+		sPooledTexture *psPooledTexture = (*plstBucket)[plstBucket->GetNumOfElements() - 1];
+		plstBucket->RemoveAtIndex(plstBucket->GetNumOfElements() - 1);
+		TextureBuffer *pTextureBuffer = psPooledTexture->pTextureBuffer;
+		m_nPooledMemory -= psPooledTexture->nSize;
+		delete psPooledTexture;
+
+		// the texture still shows its previous user, it has to look like it was just created from the image
+		pTextureBuffer->CopyDataFrom(0, TextureBuffer::R8G8B8A8, cImage.GetBuffer()->GetData());
+		m_nReusedTextureCount++;
+		return pTextureBuffer;
+	}
+
+	m_nCreatedTextureCount++;
+	return reinterpret_cast<TextureBuffer*>(m_pRenderer->CreateTextureBuffer2D(cImage, TextureBuffer::Unknown, 0));
+}
+
+
+void TexturePool::ReleaseTextureBuffer(TextureBuffer *pTextureBuffer, const int &nWidth, const int &nHeight)
+{
+	if (!pTextureBuffer)
+	{
+		return;
+	}
+
+	const uint32 nSize = uint32(nWidth) * uint32(nHeight) * 4;
+	if (nSize > m_nMemoryLimit || nWidth % TEXTUREPOOLGRANULARITY || nHeight % TEXTUREPOOLGRANULARITY)
+	{
+		// the texture would never fit or is of no size class, nobody would ask for it
+		delete pTextureBuffer;
+		return;
+	}
+
+	while (m_nPooledMemory + nSize > m_nMemoryLimit && DestroyOldestTexture())
+	{
+		// make room for the texture
+	}
+
+	const uint32 nKey = GetKey(nWidth, nHeight);
+	Array<sPooledTexture*> *plstBucket = m_pmapTextures->Get(nKey);
+	if (!plstBucket)
+	{
+		// the buckets are kept, there are only a few size classes in use
+		plstBucket = new Array<sPooledTexture*>;
+		m_pmapTextures->Add(nKey, plstBucket);
+	}
+
+	sPooledTexture *psPooledTexture = new sPooledTexture;
+	psPooledTexture->pTextureBuffer = pTextureBuffer;
+	psPooledTexture->nSize = nSize;
+	psPooledTexture->nReleaseTime = Timing::GetInstance()->GetPastTime();
+	plstBucket->Add(psPooledTexture);
+	m_nPooledMemory += nSize;
+}
+
+
+VertexBuffer *TexturePool::GetVertexBuffer()
+{
+	if (m_lstVertexBuffers.GetNumOfElements() > 0)
+	{
+		VertexBuffer *pVertexBuffer = m_lstVertexBuffers[m_lstVertexBuffers.GetNumOfElements() - 1];
+		m_lstVertexBuffers.RemoveAtIndex(m_lstVertexBuffers.GetNumOfElements() - 1);
+		return pVertexBuffer;
+	}
+	return nullptr;
+}
+
+
+void TexturePool::ReleaseVertexBuffer(VertexBuffer *pVertexBuffer)
+{
+	if (pVertexBuffer)
+	{
+		if (m_lstVertexBuffers.GetNumOfElements() < TEXTUREPOOLMAXVERTEXBUFFERS)
+		{
+			// the quads are tiny, only their amount is limited
+			m_lstVertexBuffers.Add(pVertexBuffer);
+		}
+		else
+		{
+			delete pVertexBuffer;
+		}
+	}
+}
+
+
+void TexturePool::SetMemoryLimit(const uint64 &nBytes)
+{
+	m_nMemoryLimit = nBytes;
+	while (m_nPooledMemory > m_nMemoryLimit && DestroyOldestTexture())
+	{
+		// destroy until the pool fits the new limit
+	}
+}
+
+
+uint64 TexturePool::GetPooledMemory() const
+{
+	return m_nPooledMemory;
+}
+
+
+void TexturePool::SetTrimTime(const uint64 &nTime)
+{
+	m_nTrimTime = nTime;
+}
+
+
+void TexturePool::Trim()
+{
+	if (!m_nTrimTime || !m_nPooledMemory)
+	{
+		// nothing to trim
+		return;
+	}
+
+	const uint64 nTime = Timing::GetInstance()->GetPastTime();
+	Iterator<Array<sPooledTexture*>*> cIterator = m_pmapTextures->GetIterator();
+	while (cIterator.HasNext())
+	{
+		Array<sPooledTexture*> &lstBucket = *cIterator.Next();
+		// the textures of a bucket are ordered by the time they have been given back
+		while (lstBucket.GetNumOfElements() > 0 && (nTime - lstBucket[0]->nReleaseTime) > m_nTrimTime)
+		{
+			sPooledTexture *psPooledTexture = lstBucket[0];
+			lstBucket.RemoveAtIndex(0);
+			m_nPooledMemory -= psPooledTexture->nSize;
+			delete psPooledTexture->pTextureBuffer;
+			delete psPooledTexture;
+		}
+	}
+}
+
+
+void TexturePool::Clear()
+{
+	while (DestroyOldestTexture())
+	{
+		// destroy all pooled textures
+	}
+	for (uint32 i = 0; i < m_lstVertexBuffers.GetNumOfElements(); i++)
+	{
+		delete m_lstVertexBuffers[i];
+	}
+	m_lstVertexBuffers.Reset();
+}
+
+
+uint32 TexturePool::GetCreatedTextureCount() const
+{
+	return m_nCreatedTextureCount;
+}
+
+
+uint32 TexturePool::GetReusedTextureCount() const
+{
+	return m_nReusedTextureCount;
+}
+
+
+uint32 TexturePool::GetKey(const int &nWidth, const int &nHeight)
+{
+	// the size classes are multiples of TEXTUREPOOLGRANULARITY, so the key stays unique for sizes up to 65535
+	return (uint32(nWidth / TEXTUREPOOLGRANULARITY) << 16) | uint32(nHeight / TEXTUREPOOLGRANULARITY);
+}
+
+
+bool TexturePool::DestroyOldestTexture()
+{
+	// the oldest texture of a bucket is its first one
+	Array<sPooledTexture*> *plstOldestBucket = nullptr;
+	Iterator<Array<sPooledTexture*>*> cIterator = m_pmapTextures->GetIterator();
+	while (cIterator.HasNext())
+	{
+		Array<sPooledTexture*> *plstBucket = cIterator.Next();
+		if (plstBucket->GetNumOfElements() > 0 && (!plstOldestBucket || (*plstBucket)[0]->nReleaseTime < (*plstOldestBucket)[0]->nReleaseTime))
+		{
+			plstOldestBucket = plstBucket;
+		}
+	}
+	if (!plstOldestBucket)
+	{
+		return false;
+	}
+
+	sPooledTexture *psPooledTexture = (*plstOldestBucket)[0];
+	plstOldestBucket->RemoveAtIndex(0);
+	m_nPooledMemory -= psPooledTexture->nSize;
+	delete psPooledTexture->pTextureBuffer;
+	delete psPooledTexture;
+	return true;
+}
+
+
+//[-------------------------------------------------------]
+//[ Namespace                                             ]
+//[-------------------------------------------------------]
+} // PLBerkelium